@@ -0,0 +1,34 @@
+/*
+ * Host replacement for the Altera Avalon performance counter driver. Section
+ * times are taken from OSHostTimeNs(), i.e. CLOCK_MONOTONIC_RAW nanoseconds,
+ * which matches the 1 GHz ALT_CPU_FREQ declared in the host system.h.
+ */
+#ifndef ALTERA_AVALON_PERFORMANCE_COUNTER_H
+#define ALTERA_AVALON_PERFORMANCE_COUNTER_H
+
+#include "alt_types.h"
+#include "system.h"
+
+#define PERF_MAX_SECTIONS  8
+
+void    perf_host_reset(void* hw_base_address);
+void    perf_host_start_measuring(void* hw_base_address);
+void    perf_host_stop_measuring(void* hw_base_address);
+void    perf_host_begin(void* hw_base_address, int which_section);
+void    perf_host_end(void* hw_base_address, int which_section);
+
+#define PERF_RESET(p)              perf_host_reset((void*)(p))
+#define PERF_START_MEASURING(p)    perf_host_start_measuring((void*)(p))
+#define PERF_STOP_MEASURING(p)     perf_host_stop_measuring((void*)(p))
+#define PERF_BEGIN(p, n)           perf_host_begin((void*)(p), (n))
+#define PERF_END(p, n)             perf_host_end((void*)(p), (n))
+
+alt_u64 perf_get_total_time(void* hw_base_address);
+alt_u64 perf_get_section_time(void* hw_base_address, int which_section);
+alt_u64 perf_get_num_starts(void* hw_base_address, int which_section);
+int     perf_print_formatted_report(void* perf_base, alt_u32 clock_freq_hertz,
+                                    int num_sections, ...);
+
+#define alt_get_cpu_freq()         ((alt_u32)ALT_CPU_FREQ)
+
+#endif /* ALTERA_AVALON_PERFORMANCE_COUNTER_H */
@@ -0,0 +1,15 @@
+/*
+ * Host replacement for the includes.h generated into the uC/OS-II BSP.
+ */
+#ifndef INCLUDES_H
+#define INCLUDES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "ucos_ii.h"
+
+#endif /* INCLUDES_H */
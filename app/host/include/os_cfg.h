@@ -0,0 +1,20 @@
+/*
+ * uC/OS-II configuration for the host build. Mirrors the options the lab BSP
+ * enables through nios2-bsp in app/ProjectMakefile.
+ */
+#ifndef OS_CFG_H
+#define OS_CFG_H
+
+#define OS_LOWEST_PRIO           63    /* Idle task runs at this priority      */
+#define OS_MAX_TASKS             63    /* Application tasks                    */
+#define OS_MAX_EVENTS           128
+#define OS_MAX_MEM_PART          60
+#define OS_MAX_QS                64
+#define OS_MAX_FLAGS             32
+
+#define OS_TICKS_PER_SEC       1000    /* hal.sys_clk_timer: 1 ms tick         */
+#define OS_TASK_IDLE_STK_SIZE  4096
+
+#define OS_APP_HOOKS_EN           1    /* Forward port hooks to App_*Hook()    */
+
+#endif /* OS_CFG_H */
@@ -0,0 +1,84 @@
+/*
+ * Host (Linux/gcc) CPU port for the uC/OS-II API.
+ *
+ * Tasks run on their own OS_STK arrays through ucontext, all inside one
+ * process thread, so there is exactly one task executing at any time and the
+ * scheduler is single-core like the Nios II target. "Interrupts" are emulated:
+ * the tick ISR is delivered from the idle task (virtual or real time) or at
+ * the end of a critical section once a real tick period has elapsed, and so
+ * is the external interrupt once raised.
+ */
+#ifndef OS_CPU_H
+#define OS_CPU_H
+
+#include <ucontext.h>
+
+/* Data types (same widths as the Nios II port) */
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;
+typedef signed   char  INT8S;
+typedef unsigned short INT16U;
+typedef signed   short INT16S;
+typedef unsigned int   INT32U;
+typedef signed   int   INT32S;
+typedef float          FP32;
+typedef double         FP64;
+
+typedef unsigned int   OS_STK;           /* Each stack entry is 32-bit wide   */
+typedef unsigned int   OS_CPU_SR;        /* Saved "interrupt enable" state    */
+
+/* Critical sections (method 3: state saved in a local cpu_sr) */
+#define  OS_CRITICAL_METHOD    3
+
+#define  OS_ENTER_CRITICAL()   (cpu_sr = OSHostIntDisable())
+#define  OS_EXIT_CRITICAL()    (OSHostIntRestore(cpu_sr))
+
+#define  OS_STK_GROWTH         1         /* Stack grows from HIGH to LOW      */
+
+#define  OS_TASK_SW()          OSCtxSw()
+
+/* Host execution context kept in every OS_TCB */
+typedef struct os_host_ctx {
+    ucontext_t  Ctx;
+    void      (*Task)(void *p_arg);
+    void       *Arg;
+} OS_HOST_CTX;
+
+OS_CPU_SR  OSHostIntDisable(void);
+void       OSHostIntRestore(OS_CPU_SR cpu_sr);
+
+/* Nanoseconds from CLOCK_MONOTONIC_RAW, the host stand-in for a cycle counter */
+unsigned long long OSHostTimeNs(void);
+
+/* Ends the run: OSStart() returns to main() on the host */
+void       OSHostStop(void);
+
+/* Idle in real time instead of virtual time (UCOS_HOST_REALTIME) */
+void       OSHostRealtimeSet(BOOLEAN realtime);
+
+/* Skip the timer interrupts of idle ticks (UCOS_HOST_TICKLESS) */
+void       OSHostTicklessSet(BOOLEAN tickless);
+
+/* Takes the idle task's next timer interrupt */
+void       OSHostIdleTick(void);
+
+/*
+ * Emulated external interrupt line. OSHostIrqRaise() is async-signal-safe:
+ * a signal handler raises the line and the ISR connected to it runs, between
+ * OSIntEnter() and OSIntExit(), as soon as interrupts are enabled: at the end
+ * of the running task's critical section (its next kernel call) or at once
+ * from the idle task, which waits for it in real time while one is connected.
+ */
+void       OSHostIrqConnect(void (*isr)(void *p_arg), void *p_arg);
+void       OSHostIrqRaise(void);
+BOOLEAN    OSHostIrqConnected(void);
+
+extern INT32U OSHostTimerIrqCtr;           /* Timer interrupts taken            */
+extern INT32U OSHostIdleTimerIrqCtr;       /* ... of which while idle           */
+extern INT32U OSHostExtIrqCtr;             /* External interrupts taken         */
+
+void       OSStartHighRdy(void);
+void       OSCtxSw(void);
+void       OSIntCtxSw(void);
+
+#endif /* OS_CPU_H */
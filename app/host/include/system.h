@@ -0,0 +1,12 @@
+/*
+ * Host replacement for the system.h generated from the .sopcinfo. Only the
+ * symbols used by the lab programs are defined. The "CPU clock" is the
+ * nanosecond host clock, so cycle counts read as nanoseconds.
+ */
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#define ALT_CPU_FREQ                  1000000000
+#define PERFORMANCE_COUNTER_0_BASE    0
+
+#endif /* SYSTEM_H */
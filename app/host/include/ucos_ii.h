@@ -0,0 +1,399 @@
+/*
+ * Host implementation of the uC/OS-II (v2.86) kernel API used by the lab
+ * programs in app/src. Names, error codes and semantics follow the Micrium
+ * kernel so the sources build unmodified against either this or the Nios II
+ * BSP.
+ */
+#ifndef OS_uCOS_II_H
+#define OS_uCOS_II_H
+
+#include <stddef.h>
+
+#include "os_cfg.h"
+#include "os_cpu.h"
+
+#define OS_VERSION              286u
+
+#ifndef OS_FALSE
+#define OS_FALSE                0u
+#endif
+#ifndef OS_TRUE
+#define OS_TRUE                 1u
+#endif
+
+#define OS_PRIO_SELF          0xFFu
+#define OS_N_SYS_TASKS            1u
+#define OS_TASK_IDLE_PRIO     (OS_LOWEST_PRIO)
+#define OS_TASK_IDLE_ID       65535u
+#define OS_TCB_RESERVED       ((OS_TCB *)1)      /* Priority taken, e.g. by a mutex PIP */
+
+#define OS_EVENT_TBL_SIZE     ((OS_LOWEST_PRIO) / 8u + 1u)
+#define OS_RDY_TBL_SIZE       ((OS_LOWEST_PRIO) / 8u + 1u)
+
+/* Task states (OSTCBStat) */
+#define OS_STAT_RDY            0x00u
+#define OS_STAT_SEM            0x01u
+#define OS_STAT_MBOX           0x02u
+#define OS_STAT_Q              0x04u
+#define OS_STAT_SUSPEND        0x08u
+#define OS_STAT_MUTEX          0x10u
+#define OS_STAT_FLAG           0x20u
+#define OS_STAT_MULTI          0x80u
+#define OS_STAT_PEND_ANY      (OS_STAT_SEM | OS_STAT_MBOX | OS_STAT_Q | OS_STAT_MUTEX | OS_STAT_FLAG)
+
+/* Pend status (OSTCBStatPend) */
+#define OS_STAT_PEND_OK           0u
+#define OS_STAT_PEND_TO           1u
+#define OS_STAT_PEND_ABORT        2u
+
+/* Event types */
+#define OS_EVENT_TYPE_UNUSED      0u
+#define OS_EVENT_TYPE_MBOX        1u
+#define OS_EVENT_TYPE_Q           2u
+#define OS_EVENT_TYPE_SEM         3u
+#define OS_EVENT_TYPE_MUTEX       4u
+#define OS_EVENT_TYPE_FLAG        5u
+
+/* OSTaskCreateExt() options */
+#define OS_TASK_OPT_NONE     0x0000u
+#define OS_TASK_OPT_STK_CHK  0x0001u
+#define OS_TASK_OPT_STK_CLR  0x0002u
+#define OS_TASK_OPT_SAVE_FP  0x0004u
+
+#define OS_DEL_NO_PEND            0u
+#define OS_DEL_ALWAYS             1u
+
+/* Event flag wait types and options */
+#define OS_FLAG_WAIT_CLR_ALL      0u
+#define OS_FLAG_WAIT_CLR_ANY      1u
+#define OS_FLAG_WAIT_SET_ALL      2u
+#define OS_FLAG_WAIT_SET_ANY      3u
+#define OS_FLAG_CONSUME        0x80u
+#define OS_FLAG_CLR               0u
+#define OS_FLAG_SET               1u
+
+#define OS_MUTEX_KEEP_LOWER_8   0x00FFu
+#define OS_MUTEX_KEEP_UPPER_8   0xFF00u
+#define OS_MUTEX_AVAILABLE      0x00FFu
+
+/* Error codes */
+#define OS_ERR_NONE                   0u
+#define OS_ERR_EVENT_TYPE             1u
+#define OS_ERR_PEND_ISR               2u
+#define OS_ERR_POST_NULL_PTR          3u
+#define OS_ERR_PEVENT_NULL            4u
+#define OS_ERR_POST_ISR               5u
+#define OS_ERR_QUERY_ISR              6u
+#define OS_ERR_INVALID_OPT            7u
+#define OS_ERR_PDATA_NULL             9u
+#define OS_ERR_TIMEOUT               10u
+#define OS_ERR_PEND_LOCKED           13u
+#define OS_ERR_PEND_ABORT            14u
+#define OS_ERR_DEL_ISR               15u
+#define OS_ERR_CREATE_ISR            16u
+#define OS_ERR_MBOX_FULL             20u
+#define OS_ERR_Q_FULL                30u
+#define OS_ERR_Q_EMPTY               31u
+#define OS_ERR_TIME_NOT_DLY          80u
+#define OS_ERR_TIME_INVALID_MINUTES  81u
+#define OS_ERR_TIME_INVALID_SECONDS  82u
+#define OS_ERR_TIME_INVALID_MS       83u
+#define OS_ERR_TIME_ZERO_DLY         84u
+#define OS_ERR_TIME_DLY_ISR          85u
+#define OS_ERR_TASK_WAITING          73u
+#define OS_ERR_SEM_OVF               51u
+#define OS_ERR_PRIO_EXIST            40u
+#define OS_ERR_PRIO                  41u
+#define OS_ERR_PRIO_INVALID          42u
+#define OS_ERR_TASK_CREATE_ISR       60u
+#define OS_ERR_TASK_DEL              61u
+#define OS_ERR_TASK_DEL_IDLE         62u
+#define OS_ERR_TASK_DEL_ISR          64u
+#define OS_ERR_TASK_NO_MORE_TCB      66u
+#define OS_ERR_TASK_NOT_EXIST        67u
+#define OS_ERR_TASK_OPT              69u
+#define OS_ERR_NOT_MUTEX_OWNER      100u
+#define OS_ERR_MEM_INVALID_PART     110u
+#define OS_ERR_MEM_INVALID_BLKS     111u
+#define OS_ERR_MEM_INVALID_SIZE     112u
+#define OS_ERR_MEM_NO_FREE_BLKS     113u
+#define OS_ERR_MEM_FULL             114u
+#define OS_ERR_MEM_INVALID_PBLK     115u
+#define OS_ERR_MEM_INVALID_PMEM     116u
+#define OS_ERR_MEM_INVALID_PDATA    117u
+#define OS_ERR_MEM_INVALID_ADDR     118u
+#define OS_ERR_PIP_LOWER            120u
+#define OS_ERR_FLAG_INVALID_PGRP    150u
+#define OS_ERR_FLAG_WAIT_TYPE       151u
+#define OS_ERR_FLAG_NOT_RDY         152u
+#define OS_ERR_FLAG_INVALID_OPT     153u
+#define OS_ERR_FLAG_GRP_DEPLETED    154u
+#define OS_ERR_EVENT_PEND_ABORT     OS_ERR_PEND_ABORT
+
+/* Old (pre v2.84) names still used by the lab sources */
+#define OS_NO_ERR                   OS_ERR_NONE
+#define OS_TIMEOUT                  OS_ERR_TIMEOUT
+#define OS_PRIO_EXIST               OS_ERR_PRIO_EXIST
+#define OS_PRIO_INVALID             OS_ERR_PRIO_INVALID
+#define OS_SEM_OVF                  OS_ERR_SEM_OVF
+#define OS_TASK_NOT_EXIST           OS_ERR_TASK_NOT_EXIST
+#define OS_MEM_NO_FREE_BLKS         OS_ERR_MEM_NO_FREE_BLKS
+#define OS_MEM_FULL                 OS_ERR_MEM_FULL
+#define OS_MBOX_FULL                OS_ERR_MBOX_FULL
+#define OS_Q_FULL                   OS_ERR_Q_FULL
+
+/*
+*********************************************************************************************************
+*                                         KERNEL DATA STRUCTURES
+*********************************************************************************************************
+*/
+
+typedef struct os_event {
+    INT8U    OSEventType;                      /* OS_EVENT_TYPE_xxx                         */
+    void    *OSEventPtr;                       /* Free list link / message / mutex owner    */
+    INT16U   OSEventCnt;                       /* Semaphore count                           */
+    INT8U    OSEventGrp;                       /* Group of tasks waiting on the event       */
+    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];    /* Tasks waiting on the event                */
+} OS_EVENT;
+
+typedef INT32U OS_FLAGS;
+
+typedef struct os_flag_grp {
+    INT8U    OSFlagType;                       /* OS_EVENT_TYPE_FLAG                        */
+    void    *OSFlagWaitList;                   /* List of waiting OS_FLAG_NODEs             */
+    OS_FLAGS OSFlagFlags;
+} OS_FLAG_GRP;
+
+typedef struct os_flag_node {                  /* Lives on the waiting task's stack         */
+    void    *OSFlagNodeNext;
+    void    *OSFlagNodePrev;
+    void    *OSFlagNodeTCB;
+    void    *OSFlagNodeFlagGrp;
+    OS_FLAGS OSFlagNodeFlags;
+    INT8U    OSFlagNodeWaitType;
+} OS_FLAG_NODE;
+
+typedef struct os_q {
+    struct os_q *OSQPtr;                       /* Free list link                            */
+    void       **OSQStart;
+    void       **OSQEnd;
+    void       **OSQIn;
+    void       **OSQOut;
+    INT16U       OSQSize;
+    INT16U       OSQEntries;
+} OS_Q;
+
+typedef struct os_q_data {
+    void    *OSMsg;                            /* Next message, NULL if empty               */
+    INT16U   OSNMsgs;
+    INT16U   OSQSize;
+    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];
+    INT8U    OSEventGrp;
+} OS_Q_DATA;
+
+typedef struct os_mbox_data {
+    void    *OSMsg;
+    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];
+    INT8U    OSEventGrp;
+} OS_MBOX_DATA;
+
+typedef struct os_mutex_data {
+    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];
+    INT8U    OSEventGrp;
+    BOOLEAN  OSValue;                          /* OS_TRUE if the mutex is available         */
+    INT8U    OSOwnerPrio;
+    INT8U    OSMutexPIP;
+} OS_MUTEX_DATA;
+
+typedef struct os_sem_data {
+    INT16U   OSCnt;
+    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];
+    INT8U    OSEventGrp;
+} OS_SEM_DATA;
+
+typedef struct os_mem {
+    void    *OSMemAddr;                        /* Start of the partition                    */
+    void    *OSMemFreeList;                    /* First free block                          */
+    INT32U   OSMemBlkSize;
+    INT32U   OSMemNBlks;
+    INT32U   OSMemNFree;
+} OS_MEM;
+
+typedef struct os_mem_data {
+    void    *OSAddr;
+    void    *OSFreeList;
+    INT32U   OSBlkSize;
+    INT32U   OSNBlks;
+    INT32U   OSNFree;
+    INT32U   OSNUsed;
+} OS_MEM_DATA;
+
+typedef struct os_stk_data {
+    INT32U   OSFree;                           /* Free bytes on the stack                   */
+    INT32U   OSUsed;                           /* Used bytes on the stack                   */
+} OS_STK_DATA;
+
+typedef struct os_tcb {
+    OS_STK          *OSTCBStkPtr;              /* Unused on the host, kept for layout       */
+    void            *OSTCBExtPtr;
+    OS_STK          *OSTCBStkBottom;
+    INT32U           OSTCBStkSize;             /* In OS_STK entries                         */
+    INT16U           OSTCBOpt;
+    INT16U           OSTCBId;
+
+    struct os_tcb   *OSTCBNext;
+    struct os_tcb   *OSTCBPrev;
+
+    OS_EVENT        *OSTCBEventPtr;
+    void            *OSTCBMsg;
+
+    OS_FLAG_NODE    *OSTCBFlagNode;
+    OS_FLAGS         OSTCBFlagsRdy;
+
+    INT32U           OSTCBDly;                 /* Ticks to delay / pend timeout             */
+    INT8U            OSTCBStat;
+    INT8U            OSTCBStatPend;
+    INT8U            OSTCBPrio;
+
+    INT8U            OSTCBX;
+    INT8U            OSTCBY;
+    INT8U            OSTCBBitX;
+    INT8U            OSTCBBitY;
+
+    INT32U           OSTCBCtxSwCtr;
+
+    OS_HOST_CTX      OSTCBHost;                /* Host execution context                    */
+} OS_TCB;
+
+/*
+*********************************************************************************************************
+*                                           GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+extern INT32U           OSCtxSwCtr;
+extern INT32U           OSIdleCtr;
+extern INT8U            OSIntNesting;
+extern INT8U            OSLockNesting;
+extern INT8U            OSPrioCur;
+extern INT8U            OSPrioHighRdy;
+extern INT8U            OSRdyGrp;
+extern INT8U            OSRdyTbl[OS_RDY_TBL_SIZE];
+extern BOOLEAN          OSRunning;
+extern INT8U            OSTaskCtr;
+extern volatile INT32U  OSTime;
+
+extern OS_TCB          *OSTCBCur;
+extern OS_TCB          *OSTCBHighRdy;
+extern OS_TCB          *OSTCBList;
+extern OS_TCB          *OSTCBPrioTbl[OS_LOWEST_PRIO + 1];
+
+extern INT8U const      OSUnMapTbl[256];
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void          OSInit(void);
+void          OSStart(void);
+void          OSIntEnter(void);
+void          OSIntExit(void);
+void          OSSchedLock(void);
+void          OSSchedUnlock(void);
+INT16U        OSVersion(void);
+
+INT8U         OSTaskCreate(void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT8U prio);
+INT8U         OSTaskCreateExt(void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT8U prio,
+                              INT16U id, OS_STK *pbos, INT32U stk_size, void *pext, INT16U opt);
+INT8U         OSTaskDel(INT8U prio);
+INT8U         OSTaskStkChk(INT8U prio, OS_STK_DATA *p_stk_data);
+
+void          OSTimeDly(INT32U ticks);
+INT8U         OSTimeDlyHMSM(INT8U hours, INT8U minutes, INT8U seconds, INT16U ms);
+INT32U        OSTimeGet(void);
+void          OSTimeSet(INT32U ticks);
+void          OSTimeTick(void);
+
+INT16U        OSSemAccept(OS_EVENT *pevent);
+OS_EVENT     *OSSemCreate(INT16U cnt);
+OS_EVENT     *OSSemDel(OS_EVENT *pevent, INT8U opt, INT8U *perr);
+void          OSSemPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr);
+INT8U         OSSemPost(OS_EVENT *pevent);
+INT8U         OSSemQuery(OS_EVENT *pevent, OS_SEM_DATA *p_sem_data);
+
+void         *OSMboxAccept(OS_EVENT *pevent);
+OS_EVENT     *OSMboxCreate(void *pmsg);
+OS_EVENT     *OSMboxDel(OS_EVENT *pevent, INT8U opt, INT8U *perr);
+void         *OSMboxPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr);
+INT8U         OSMboxPost(OS_EVENT *pevent, void *pmsg);
+INT8U         OSMboxQuery(OS_EVENT *pevent, OS_MBOX_DATA *p_mbox_data);
+
+void         *OSQAccept(OS_EVENT *pevent, INT8U *perr);
+OS_EVENT     *OSQCreate(void **start, INT16U size);
+OS_EVENT     *OSQDel(OS_EVENT *pevent, INT8U opt, INT8U *perr);
+INT8U         OSQFlush(OS_EVENT *pevent);
+void         *OSQPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr);
+INT8U         OSQPost(OS_EVENT *pevent, void *pmsg);
+INT8U         OSQPostFront(OS_EVENT *pevent, void *pmsg);
+INT8U         OSQQuery(OS_EVENT *pevent, OS_Q_DATA *p_q_data);
+
+BOOLEAN       OSMutexAccept(OS_EVENT *pevent, INT8U *perr);
+OS_EVENT     *OSMutexCreate(INT8U prio, INT8U *perr);
+OS_EVENT     *OSMutexDel(OS_EVENT *pevent, INT8U opt, INT8U *perr);
+void          OSMutexPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr);
+INT8U         OSMutexPost(OS_EVENT *pevent);
+INT8U         OSMutexQuery(OS_EVENT *pevent, OS_MUTEX_DATA *p_mutex_data);
+
+OS_FLAGS      OSFlagAccept(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U wait_type, INT8U *perr);
+OS_FLAG_GRP  *OSFlagCreate(OS_FLAGS flags, INT8U *perr);
+OS_FLAG_GRP  *OSFlagDel(OS_FLAG_GRP *pgrp, INT8U opt, INT8U *perr);
+OS_FLAGS      OSFlagPend(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U wait_type, INT32U timeout, INT8U *perr);
+OS_FLAGS      OSFlagPendGetFlagsRdy(void);
+OS_FLAGS      OSFlagPost(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U opt, INT8U *perr);
+OS_FLAGS      OSFlagQuery(OS_FLAG_GRP *pgrp, INT8U *perr);
+
+OS_MEM       *OSMemCreate(void *addr, INT32U nblks, INT32U blksize, INT8U *perr);
+void         *OSMemGet(OS_MEM *pmem, INT8U *perr);
+INT8U         OSMemPut(OS_MEM *pmem, void *pblk);
+INT8U         OSMemQuery(OS_MEM *pmem, OS_MEM_DATA *p_mem_data);
+
+/* Port hooks (os_cpu_c.c) */
+void          OSInitHookBegin(void);
+void          OSInitHookEnd(void);
+void          OSTaskCreateHook(OS_TCB *ptcb);
+void          OSTaskDelHook(OS_TCB *ptcb);
+void          OSTaskIdleHook(void);
+void          OSTaskSwHook(void);
+void          OSTimeTickHook(void);
+
+/* Application hooks, weak no-ops on the host unless the program defines them */
+void          App_TaskCreateHook(OS_TCB *ptcb);
+void          App_TaskDelHook(OS_TCB *ptcb);
+void          App_TaskIdleHook(void);
+void          App_TaskSwHook(void);
+void          App_TimeTickHook(void);
+
+/* Kernel internals shared between the os_*.c files */
+void          OS_Sched(void);
+void          OS_TaskIdle(void *p_arg);
+void          OS_TimeTickN(INT32U ticks);
+INT32U        OS_TimeNextDly(void);
+INT8U         OS_TCBInit(void (*task)(void *p_arg), void *p_arg, INT8U prio, OS_STK *ptos,
+                         OS_STK *pbos, INT16U id, INT32U stk_size, void *pext, INT16U opt);
+void          OS_TCBFree(OS_TCB *ptcb);
+OS_EVENT     *OS_EventAlloc(void);
+void          OS_EventFree(OS_EVENT *pevent);
+INT8U         OS_EventTaskRdy(OS_EVENT *pevent, void *pmsg, INT8U msk, INT8U pend_stat);
+void          OS_EventTaskWait(OS_EVENT *pevent);
+void          OS_EventTaskRemove(OS_TCB *ptcb, OS_EVENT *pevent);
+void          OS_EventWaitListInit(OS_EVENT *pevent);
+void          OS_MemInit(void);
+void          OS_QInit(void);
+void          OS_FlagInit(void);
+void          OS_FlagUnlink(OS_FLAG_NODE *pnode);
+void          OS_TaskStkClr(OS_STK *pbos, INT32U size, INT16U opt);
+void          OSTaskStkInit(OS_TCB *ptcb, void (*task)(void *p_arg), void *p_arg);
+
+#endif /* OS_uCOS_II_H */
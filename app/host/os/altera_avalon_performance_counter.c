@@ -0,0 +1,122 @@
+/*
+ * Host replacement for the Altera Avalon performance counter driver.
+ *
+ * Keeps the same per-section accumulated time and start count as the
+ * hardware, in nanoseconds from OSHostTimeNs(). Section 0 is the global
+ * counter, as on the peripheral.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "altera_avalon_performance_counter.h"
+#include "ucos_ii.h"
+
+typedef struct {
+    alt_u64 begin;
+    alt_u64 time;
+    alt_u64 starts;
+} perf_host_section;
+
+static perf_host_section perf_sections[PERF_MAX_SECTIONS];
+static int               perf_measuring;
+
+void perf_host_reset(void* hw_base_address)
+{
+    int i;
+
+    (void)hw_base_address;
+    for (i = 0; i < PERF_MAX_SECTIONS; i++) {
+        perf_sections[i].begin  = 0;
+        perf_sections[i].time   = 0;
+        perf_sections[i].starts = 0;
+    }
+    perf_measuring = 0;
+}
+
+void perf_host_start_measuring(void* hw_base_address)
+{
+    perf_measuring = 1;
+    perf_host_begin(hw_base_address, 0);
+}
+
+void perf_host_stop_measuring(void* hw_base_address)
+{
+    perf_host_end(hw_base_address, 0);
+    perf_measuring = 0;
+}
+
+void perf_host_begin(void* hw_base_address, int which_section)
+{
+    (void)hw_base_address;
+    if (perf_measuring && which_section >= 0 && which_section < PERF_MAX_SECTIONS) {
+        perf_sections[which_section].begin = OSHostTimeNs();
+        perf_sections[which_section].starts++;
+    }
+}
+
+void perf_host_end(void* hw_base_address, int which_section)
+{
+    alt_u64 now = OSHostTimeNs();
+
+    (void)hw_base_address;
+    if (perf_measuring && which_section >= 0 && which_section < PERF_MAX_SECTIONS
+        && perf_sections[which_section].begin != 0) {
+        perf_sections[which_section].time  += now - perf_sections[which_section].begin;
+        perf_sections[which_section].begin  = 0;
+    }
+}
+
+alt_u64 perf_get_total_time(void* hw_base_address)
+{
+    return perf_get_section_time(hw_base_address, 0);
+}
+
+alt_u64 perf_get_section_time(void* hw_base_address, int which_section)
+{
+    (void)hw_base_address;
+    if (which_section < 0 || which_section >= PERF_MAX_SECTIONS) {
+        return 0;
+    }
+    return perf_sections[which_section].time;
+}
+
+alt_u64 perf_get_num_starts(void* hw_base_address, int which_section)
+{
+    (void)hw_base_address;
+    if (which_section < 0 || which_section >= PERF_MAX_SECTIONS) {
+        return 0;
+    }
+    return perf_sections[which_section].starts;
+}
+
+int perf_print_formatted_report(void* perf_base, alt_u32 clock_freq_hertz,
+                                int num_sections, ...)
+{
+    va_list  names;
+    alt_u64  total = perf_get_total_time(perf_base);
+    int      i;
+
+    printf("--Performance Counter Report--\n");
+    printf("Total Time: %.6f seconds  (%llu clock-cycles)\n",
+           (double)total / (double)clock_freq_hertz, total);
+    printf("+---------------+--------+-------------+---------------+------------+\n");
+    printf("| Section       |    %%   | Time (sec)  |  Time (clocks)|Occurrences |\n");
+    printf("+---------------+--------+-------------+---------------+------------+\n");
+
+    va_start(names, num_sections);
+    for (i = 1; i <= num_sections && i < PERF_MAX_SECTIONS; i++) {
+        const char *name   = va_arg(names, const char *);
+        alt_u64     time   = perf_get_section_time(perf_base, i);
+        alt_u64     starts = perf_get_num_starts(perf_base, i);
+
+        printf("|%-15.15s|%8.5f|%13.6f|%15llu|%12llu|\n",
+               name,
+               total ? (double)time * 100.0 / (double)total : 0.0,
+               (double)time / (double)clock_freq_hertz,
+               time, starts);
+    }
+    va_end(names);
+
+    printf("+---------------+--------+-------------+---------------+------------+\n");
+    return 0;
+}
@@ -0,0 +1,425 @@
+/*
+ * Kernel core of the host uC/OS-II: initialisation, ready list, scheduler,
+ * interrupt bookkeeping and the event wait lists shared by all IPC objects.
+ *
+ * The ready list is the classic OSRdyGrp/OSRdyTbl bitmap resolved through
+ * OSUnMapTbl, so scheduling decisions are the same as on the board.
+ */
+#include "ucos_ii.h"
+
+INT32U           OSCtxSwCtr;
+INT32U           OSIdleCtr;
+INT8U            OSIntNesting;
+INT8U            OSLockNesting;
+INT8U            OSPrioCur;
+INT8U            OSPrioHighRdy;
+INT8U            OSRdyGrp;
+INT8U            OSRdyTbl[OS_RDY_TBL_SIZE];
+BOOLEAN          OSRunning;
+INT8U            OSTaskCtr;
+volatile INT32U  OSTime;
+
+OS_TCB          *OSTCBCur;
+OS_TCB          *OSTCBHighRdy;
+OS_TCB          *OSTCBList;
+OS_TCB          *OSTCBPrioTbl[OS_LOWEST_PRIO + 1];
+
+static OS_TCB    OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS];
+static OS_TCB   *OSTCBFreeList;
+
+static OS_EVENT  OSEventTbl[OS_MAX_EVENTS];
+static OS_EVENT *OSEventFreeList;
+
+static OS_STK    OSTaskIdleStk[OS_TASK_IDLE_STK_SIZE];
+
+/* Priority resolution table: index of the lowest set bit of a byte */
+INT8U const OSUnMapTbl[256] = {
+    0u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x00 to 0x0F */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x10 to 0x1F */
+    5u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x20 to 0x2F */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x30 to 0x3F */
+    6u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x40 to 0x4F */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x50 to 0x5F */
+    5u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x60 to 0x6F */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x70 to 0x7F */
+    7u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x80 to 0x8F */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0x90 to 0x9F */
+    5u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xA0 to 0xAF */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xB0 to 0xBF */
+    6u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xC0 to 0xCF */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xD0 to 0xDF */
+    5u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xE0 to 0xEF */
+    4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u  /* 0xF0 to 0xFF */
+};
+
+static void OS_SchedNew(void)
+{
+    INT8U y;
+
+    y             = OSUnMapTbl[OSRdyGrp];
+    OSPrioHighRdy = (INT8U)((y << 3u) + OSUnMapTbl[OSRdyTbl[y]]);
+}
+
+void OSInit(void)
+{
+    INT16U i;
+
+    OSInitHookBegin();
+
+    OSTime        = 0u;
+    OSIntNesting  = 0u;
+    OSLockNesting = 0u;
+    OSTaskCtr     = 0u;
+    OSRunning     = OS_FALSE;
+    OSCtxSwCtr    = 0u;
+    OSIdleCtr     = 0u;
+
+    OSRdyGrp = 0u;
+    for (i = 0u; i < OS_RDY_TBL_SIZE; i++) {
+        OSRdyTbl[i] = 0u;
+    }
+    OSPrioCur     = 0u;
+    OSPrioHighRdy = 0u;
+    OSTCBHighRdy  = NULL;
+    OSTCBCur      = NULL;
+
+    /* Free TCBs */
+    OSTCBList = NULL;
+    for (i = 0u; i < OS_LOWEST_PRIO + 1u; i++) {
+        OSTCBPrioTbl[i] = NULL;
+    }
+    for (i = 0u; i < OS_MAX_TASKS + OS_N_SYS_TASKS - 1u; i++) {
+        OSTCBTbl[i].OSTCBNext = &OSTCBTbl[i + 1u];
+    }
+    OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS - 1u].OSTCBNext = NULL;
+    OSTCBFreeList = &OSTCBTbl[0];
+
+    /* Free event control blocks */
+    for (i = 0u; i < OS_MAX_EVENTS - 1u; i++) {
+        OSEventTbl[i].OSEventType = OS_EVENT_TYPE_UNUSED;
+        OSEventTbl[i].OSEventPtr  = &OSEventTbl[i + 1u];
+    }
+    OSEventTbl[OS_MAX_EVENTS - 1u].OSEventType = OS_EVENT_TYPE_UNUSED;
+    OSEventTbl[OS_MAX_EVENTS - 1u].OSEventPtr  = NULL;
+    OSEventFreeList = &OSEventTbl[0];
+
+    OS_MemInit();
+    OS_QInit();
+    OS_FlagInit();
+
+    OSTaskCreateExt(OS_TaskIdle,
+                    NULL,
+                    &OSTaskIdleStk[OS_TASK_IDLE_STK_SIZE - 1u],
+                    OS_TASK_IDLE_PRIO,
+                    OS_TASK_IDLE_ID,
+                    &OSTaskIdleStk[0],
+                    OS_TASK_IDLE_STK_SIZE,
+                    NULL,
+                    OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+
+    OSInitHookEnd();
+}
+
+void OSStart(void)
+{
+    if (OSRunning == OS_FALSE) {
+        OS_SchedNew();
+        OSPrioCur     = OSPrioHighRdy;
+        OSTCBHighRdy  = OSTCBPrioTbl[OSPrioHighRdy];
+        OSTCBCur      = OSTCBHighRdy;
+        OSStartHighRdy();                      /* Returns once OSHostStop() is called     */
+    }
+}
+
+void OSIntEnter(void)
+{
+    if (OSRunning == OS_TRUE) {
+        if (OSIntNesting < 255u) {
+            OSIntNesting++;
+        }
+    }
+}
+
+void OSIntExit(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (OSRunning == OS_TRUE) {
+        OS_ENTER_CRITICAL();
+        if (OSIntNesting > 0u) {
+            OSIntNesting--;
+        }
+        if (OSIntNesting == 0u && OSLockNesting == 0u) {
+            OS_SchedNew();
+            if (OSPrioHighRdy != OSPrioCur) {
+                OSTCBHighRdy = OSTCBPrioTbl[OSPrioHighRdy];
+                OSTCBHighRdy->OSTCBCtxSwCtr++;
+                OSCtxSwCtr++;
+                OSIntCtxSw();
+            }
+        }
+        OS_EXIT_CRITICAL();
+    }
+}
+
+void OSSchedLock(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (OSRunning == OS_TRUE) {
+        OS_ENTER_CRITICAL();
+        if (OSIntNesting == 0u && OSLockNesting < 255u) {
+            OSLockNesting++;
+        }
+        OS_EXIT_CRITICAL();
+    }
+}
+
+void OSSchedUnlock(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (OSRunning == OS_TRUE) {
+        OS_ENTER_CRITICAL();
+        if (OSLockNesting > 0u) {
+            OSLockNesting--;
+            if (OSLockNesting == 0u && OSIntNesting == 0u) {
+                OS_EXIT_CRITICAL();
+                OS_Sched();
+                return;
+            }
+        }
+        OS_EXIT_CRITICAL();
+    }
+}
+
+INT16U OSVersion(void)
+{
+    return OS_VERSION;
+}
+
+void OS_Sched(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    OS_ENTER_CRITICAL();
+    if (OSIntNesting == 0u && OSLockNesting == 0u) {
+        OS_SchedNew();
+        if (OSPrioHighRdy != OSPrioCur) {
+            OSTCBHighRdy = OSTCBPrioTbl[OSPrioHighRdy];
+            OSTCBHighRdy->OSTCBCtxSwCtr++;
+            OSCtxSwCtr++;
+            OS_TASK_SW();
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Idle task. On the host nothing but the timer and the emulated external
+ * interrupt can ready a task, so instead of spinning the idle task hands
+ * over to the port, which takes the next timer interrupt at once (virtual
+ * time) or once it is due (real time), or the external interrupt. Once no
+ * task is delayed and no external interrupt is connected either, nothing
+ * can ever become ready again and the run ends.
+ */
+void OS_TaskIdle(void *p_arg)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+    BOOLEAN    delayed;
+
+    (void)p_arg;
+    for (;;) {
+        OS_ENTER_CRITICAL();
+        OSIdleCtr++;
+        delayed = OS_FALSE;
+        for (ptcb = OSTCBList; ptcb != NULL; ptcb = ptcb->OSTCBNext) {
+            if (ptcb->OSTCBDly != 0u) {
+                delayed = OS_TRUE;
+                break;
+            }
+        }
+        OS_EXIT_CRITICAL();
+
+        OSTaskIdleHook();
+        if (delayed == OS_FALSE && OSHostIrqConnected() == OS_FALSE) {
+            OSHostStop();
+        }
+        OSHostIdleTick();
+    }
+}
+
+/*
+ * Takes a TCB from the free list, builds the task's context, links it in
+ * and makes the task ready. The context comes first: leaving the critical
+ * section that makes the task ready can take a due tick and switch to it.
+ */
+INT8U OS_TCBInit(void (*task)(void *p_arg), void *p_arg, INT8U prio, OS_STK *ptos, OS_STK *pbos,
+                 INT16U id, INT32U stk_size, void *pext, INT16U opt)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+
+    (void)ptos;
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBFreeList;
+    if (ptcb == NULL) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_NO_MORE_TCB;
+    }
+    OSTCBFreeList = ptcb->OSTCBNext;
+    OS_EXIT_CRITICAL();
+
+    ptcb->OSTCBStkPtr    = ptos;
+    ptcb->OSTCBExtPtr    = pext;
+    ptcb->OSTCBStkBottom = pbos;
+    ptcb->OSTCBStkSize   = stk_size;
+    ptcb->OSTCBOpt       = opt;
+    ptcb->OSTCBId        = id;
+    ptcb->OSTCBPrio      = prio;
+    ptcb->OSTCBStat      = OS_STAT_RDY;
+    ptcb->OSTCBStatPend  = OS_STAT_PEND_OK;
+    ptcb->OSTCBDly       = 0u;
+    ptcb->OSTCBEventPtr  = NULL;
+    ptcb->OSTCBMsg       = NULL;
+    ptcb->OSTCBFlagNode  = NULL;
+    ptcb->OSTCBFlagsRdy  = 0u;
+    ptcb->OSTCBCtxSwCtr  = 0u;
+
+    ptcb->OSTCBY    = (INT8U)(prio >> 3u);
+    ptcb->OSTCBX    = (INT8U)(prio & 0x07u);
+    ptcb->OSTCBBitY = (INT8U)(1u << ptcb->OSTCBY);
+    ptcb->OSTCBBitX = (INT8U)(1u << ptcb->OSTCBX);
+
+    OSTaskStkInit(ptcb, task, p_arg);
+    OSTaskCreateHook(ptcb);
+
+    OS_ENTER_CRITICAL();
+    OSTCBPrioTbl[prio] = ptcb;
+    ptcb->OSTCBNext    = OSTCBList;
+    ptcb->OSTCBPrev    = NULL;
+    if (OSTCBList != NULL) {
+        OSTCBList->OSTCBPrev = ptcb;
+    }
+    OSTCBList               = ptcb;
+    OSRdyGrp               |= ptcb->OSTCBBitY;
+    OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+    OSTaskCtr++;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+/*
+ * Unlinks a TCB from the task list and returns it to the free list. Called
+ * with interrupts disabled.
+ */
+void OS_TCBFree(OS_TCB *ptcb)
+{
+    if (ptcb->OSTCBPrev == NULL) {
+        OSTCBList = ptcb->OSTCBNext;
+    } else {
+        ptcb->OSTCBPrev->OSTCBNext = ptcb->OSTCBNext;
+    }
+    if (ptcb->OSTCBNext != NULL) {
+        ptcb->OSTCBNext->OSTCBPrev = ptcb->OSTCBPrev;
+    }
+    OSTCBPrioTbl[ptcb->OSTCBPrio] = NULL;
+    ptcb->OSTCBNext = OSTCBFreeList;
+    OSTCBFreeList   = ptcb;
+    OSTaskCtr--;
+}
+
+OS_EVENT *OS_EventAlloc(void)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_EVENT  *pevent;
+
+    OS_ENTER_CRITICAL();
+    pevent = OSEventFreeList;
+    if (pevent != NULL) {
+        OSEventFreeList = (OS_EVENT *)pevent->OSEventPtr;
+    }
+    OS_EXIT_CRITICAL();
+    return pevent;
+}
+
+/* Called with interrupts disabled */
+void OS_EventFree(OS_EVENT *pevent)
+{
+    pevent->OSEventType = OS_EVENT_TYPE_UNUSED;
+    pevent->OSEventPtr  = OSEventFreeList;
+    pevent->OSEventCnt  = 0u;
+    OSEventFreeList     = pevent;
+}
+
+/*
+ * Makes the highest priority task waiting on the event ready to run and
+ * returns its priority. Called with interrupts disabled.
+ */
+INT8U OS_EventTaskRdy(OS_EVENT *pevent, void *pmsg, INT8U msk, INT8U pend_stat)
+{
+    OS_TCB *ptcb;
+    INT8U   x;
+    INT8U   y;
+    INT8U   prio;
+
+    y    = OSUnMapTbl[pevent->OSEventGrp];
+    x    = OSUnMapTbl[pevent->OSEventTbl[y]];
+    prio = (INT8U)((y << 3u) + x);
+
+    ptcb                 = OSTCBPrioTbl[prio];
+    ptcb->OSTCBDly       = 0u;
+    ptcb->OSTCBMsg       = pmsg;
+    ptcb->OSTCBStat     &= (INT8U)~msk;
+    ptcb->OSTCBStatPend  = pend_stat;
+    if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {
+        OSRdyGrp    |= ptcb->OSTCBBitY;
+        OSRdyTbl[y] |= ptcb->OSTCBBitX;
+    }
+    OS_EventTaskRemove(ptcb, pevent);
+    return prio;
+}
+
+/*
+ * Moves the current task from the ready list to the event's wait list.
+ * Called with interrupts disabled.
+ */
+void OS_EventTaskWait(OS_EVENT *pevent)
+{
+    INT8U y;
+
+    OSTCBCur->OSTCBEventPtr = pevent;
+
+    pevent->OSEventTbl[OSTCBCur->OSTCBY] |= OSTCBCur->OSTCBBitX;
+    pevent->OSEventGrp                   |= OSTCBCur->OSTCBBitY;
+
+    y             = OSTCBCur->OSTCBY;
+    OSRdyTbl[y]  &= (INT8U)~OSTCBCur->OSTCBBitX;
+    if (OSRdyTbl[y] == 0u) {
+        OSRdyGrp &= (INT8U)~OSTCBCur->OSTCBBitY;
+    }
+}
+
+/* Called with interrupts disabled */
+void OS_EventTaskRemove(OS_TCB *ptcb, OS_EVENT *pevent)
+{
+    INT8U y;
+
+    y                       = ptcb->OSTCBY;
+    pevent->OSEventTbl[y]  &= (INT8U)~ptcb->OSTCBBitX;
+    if (pevent->OSEventTbl[y] == 0u) {
+        pevent->OSEventGrp &= (INT8U)~ptcb->OSTCBBitY;
+    }
+    ptcb->OSTCBEventPtr = NULL;
+}
+
+void OS_EventWaitListInit(OS_EVENT *pevent)
+{
+    INT8U i;
+
+    pevent->OSEventGrp = 0u;
+    for (i = 0u; i < OS_EVENT_TBL_SIZE; i++) {
+        pevent->OSEventTbl[i] = 0u;
+    }
+}
@@ -0,0 +1,314 @@
+/*
+ * Host CPU port: ucontext task switching, emulated interrupt masking and the
+ * tick source.
+ *
+ * Time normally advances virtually: when every task is blocked the idle task
+ * delivers the next tick at once, so a 100 ms OSTimeDlyHMSM() costs no wall
+ * time. A task that keeps running without blocking is still preempted by the
+ * tick, which is taken when it leaves a critical section (i.e. on its next
+ * kernel call) after one real tick period has elapsed.
+ *
+ * With UCOS_HOST_REALTIME the idle task instead waits until the next tick is
+ * due, so an idle system takes wall time and every tick interrupt as a board
+ * does. With UCOS_HOST_TICKLESS the idle task skips the ticks nobody waits
+ * for: it takes a single timer interrupt when the earliest delay runs out and
+ * accounts for all ticks since in one go. Running tasks still see every tick.
+ *
+ * While an external interrupt is connected (OSHostIrqConnect()) the idle task
+ * spins in real time until it is raised or the next tick is due, whichever
+ * comes first, as an idle CPU waits for its interrupts.
+ *
+ * Environment:
+ *   UCOS_HOST_TICKS     stop the run after this many ticks (0/unset = never)
+ *   UCOS_HOST_REALTIME  1: idle until the next timer interrupt is due
+ *   UCOS_HOST_TICKLESS  1: no timer interrupts for idle ticks
+ */
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ucos_ii.h"
+
+static ucontext_t          OSHostMainCtx;          /* main() context, resumed on stop   */
+static volatile OS_CPU_SR  OSHostIntEn = 1u;       /* Emulated interrupt enable flag    */
+static unsigned long long  OSHostNextTickNs;       /* Real-time deadline for next tick  */
+static INT32U              OSHostTickLimit;
+static BOOLEAN             OSHostRealtime;
+static BOOLEAN             OSHostTickless;
+static void              (*OSHostIrqIsr)(void *p_arg);
+static void               *OSHostIrqArg;
+static volatile sig_atomic_t OSHostIrqPending;
+
+INT32U                     OSHostTimerIrqCtr;      /* Timer interrupts taken            */
+INT32U                     OSHostIdleTimerIrqCtr;  /* ... of which while idle           */
+INT32U                     OSHostExtIrqCtr;        /* External interrupts taken         */
+
+#define OS_HOST_TICK_NS    (1000000000uLL / OS_TICKS_PER_SEC)
+#define OS_HOST_SPIN_NS    100000uLL               /* Sleep until this close, then spin */
+
+unsigned long long OSHostTimeNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000uLL + (unsigned long long)ts.tv_nsec;
+}
+
+/* Timer interrupt as seen by a running task */
+static void OSHostTickIsr(void)
+{
+    OSHostIntEn = 0u;
+    OSHostTimerIrqCtr++;
+    OSIntEnter();
+    OSTimeTick();
+    OSIntExit();
+    OSHostIntEn = 1u;
+}
+
+/* External interrupt, taken wherever the tick would be */
+static void OSHostExtIsr(void)
+{
+    OSHostIntEn      = 0u;
+    OSHostIrqPending = 0;
+    OSHostExtIrqCtr++;
+    OSIntEnter();
+    OSHostIrqIsr(OSHostIrqArg);
+    OSIntExit();
+    OSHostIntEn      = 1u;
+}
+
+void OSHostIrqConnect(void (*isr)(void *p_arg), void *p_arg)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    OS_ENTER_CRITICAL();
+    OSHostIrqIsr     = isr;
+    OSHostIrqArg     = p_arg;
+    OSHostIrqPending = 0;
+    OS_EXIT_CRITICAL();
+}
+
+void OSHostIrqRaise(void)
+{
+    OSHostIrqPending = 1;
+}
+
+BOOLEAN OSHostIrqConnected(void)
+{
+    return (OSHostIrqIsr != NULL) ? OS_TRUE : OS_FALSE;
+}
+
+OS_CPU_SR OSHostIntDisable(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    cpu_sr      = OSHostIntEn;
+    OSHostIntEn = 0u;
+    return cpu_sr;
+}
+
+void OSHostIntRestore(OS_CPU_SR cpu_sr)
+{
+    OSHostIntEn = cpu_sr;
+    if (cpu_sr != 0u && OSRunning == OS_TRUE && OSIntNesting == 0u) {
+        if (OSHostTimeNs() >= OSHostNextTickNs) {
+            OSHostTickIsr();
+        }
+        if (OSHostIrqPending != 0 && OSHostIrqIsr != NULL) {
+            OSHostExtIsr();
+        }
+    }
+}
+
+void OSHostStop(void)
+{
+    setcontext(&OSHostMainCtx);
+}
+
+void OSHostRealtimeSet(BOOLEAN realtime)
+{
+    OSHostRealtime = realtime;
+}
+
+void OSHostTicklessSet(BOOLEAN tickless)
+{
+    OSHostTickless = tickless;
+}
+
+/* Waits like an idle CPU: sleeps most of the time, spins the last bit */
+static void OSHostWaitUntil(unsigned long long deadline)
+{
+    struct timespec    ts;
+    unsigned long long now = OSHostTimeNs();
+
+    if (now + OS_HOST_SPIN_NS < deadline) {
+        ts.tv_sec  = (time_t)((deadline - now - OS_HOST_SPIN_NS) / 1000000000uLL);
+        ts.tv_nsec = (long)((deadline - now - OS_HOST_SPIN_NS) % 1000000000uLL);
+        nanosleep(&ts, NULL);
+    }
+    while (OSHostTimeNs() < deadline) {
+    }
+}
+
+/*
+ * Next timer interrupt of the idle task: the next tick, or in tickless mode
+ * the tick on which the earliest delay runs out, with all the ticks up to
+ * it accounted for at once.
+ */
+void OSHostIdleTick(void)
+{
+    INT32U             ticks = 1u;
+    unsigned long long deadline;
+
+    if (OSHostTickless == OS_TRUE) {
+        ticks = OS_TimeNextDly();
+        if (ticks == 0u) {
+            ticks = 1u;
+        }
+    }
+    deadline = OSHostNextTickNs + (unsigned long long)(ticks - 1u) * OS_HOST_TICK_NS;
+    if (OSHostIrqIsr != NULL) {
+        while (OSHostIrqPending == 0 && OSHostTimeNs() < deadline) {
+        }
+        if (OSHostIrqPending != 0) {
+            OSHostExtIsr();
+            return;
+        }
+    } else if (OSHostRealtime == OS_TRUE) {
+        OSHostWaitUntil(deadline);
+    }
+
+    OSHostTimerIrqCtr++;
+    OSHostIdleTimerIrqCtr++;
+    OSIntEnter();
+    OS_TimeTickN(ticks);
+    if (OSHostRealtime == OS_TRUE || OSHostIrqIsr != NULL) {
+        OSHostNextTickNs = deadline + OS_HOST_TICK_NS;   /* Stay on the tick grid */
+    }
+    OSIntExit();
+}
+
+/* First code executed by every task, on its own stack */
+static void OSHostTaskStart(void)
+{
+    OS_TCB *ptcb = OSTCBCur;
+
+    OSHostIntEn = 1u;
+    ptcb->OSTCBHost.Task(ptcb->OSTCBHost.Arg);
+
+    /* Returning from a task deletes it, as OS_TaskReturn() does on v2.86+ */
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void OSTaskStkInit(OS_TCB *ptcb, void (*task)(void *p_arg), void *p_arg)
+{
+    ptcb->OSTCBHost.Task = task;
+    ptcb->OSTCBHost.Arg  = p_arg;
+
+    getcontext(&ptcb->OSTCBHost.Ctx);
+    ptcb->OSTCBHost.Ctx.uc_stack.ss_sp   = (void *)ptcb->OSTCBStkBottom;
+    ptcb->OSTCBHost.Ctx.uc_stack.ss_size = ptcb->OSTCBStkSize * sizeof(OS_STK);
+    ptcb->OSTCBHost.Ctx.uc_link          = NULL;
+    makecontext(&ptcb->OSTCBHost.Ctx, OSHostTaskStart, 0);
+}
+
+void OSStartHighRdy(void)
+{
+    OSRunning        = OS_TRUE;
+    OSHostNextTickNs = OSHostTimeNs() + OS_HOST_TICK_NS;
+    OSTaskSwHook();
+    swapcontext(&OSHostMainCtx, &OSTCBHighRdy->OSTCBHost.Ctx);
+
+    /* Back here through OSHostStop() */
+    OSRunning    = OS_FALSE;
+    OSIntNesting = 0u;
+    OSHostIntEn  = 1u;
+}
+
+void OSCtxSw(void)
+{
+    OS_TCB *ptcb = OSTCBCur;
+
+    OSTaskSwHook();
+    OSTCBCur  = OSTCBHighRdy;
+    OSPrioCur = OSPrioHighRdy;
+    swapcontext(&ptcb->OSTCBHost.Ctx, &OSTCBHighRdy->OSTCBHost.Ctx);
+}
+
+void OSIntCtxSw(void)
+{
+    OSCtxSw();
+}
+
+/*
+*********************************************************************************************************
+*                                              PORT HOOKS
+*********************************************************************************************************
+*/
+
+void OSInitHookBegin(void)
+{
+    const char *ticks    = getenv("UCOS_HOST_TICKS");
+    const char *realtime = getenv("UCOS_HOST_REALTIME");
+    const char *tickless = getenv("UCOS_HOST_TICKLESS");
+
+    OSHostTickLimit = (ticks != NULL) ? (INT32U)strtoul(ticks, NULL, 0) : 0u;
+    OSHostRealtime  = (realtime != NULL && strtoul(realtime, NULL, 0) != 0u) ? OS_TRUE : OS_FALSE;
+    OSHostTickless  = (tickless != NULL && strtoul(tickless, NULL, 0) != 0u) ? OS_TRUE : OS_FALSE;
+}
+
+void OSInitHookEnd(void)
+{
+}
+
+void OSTaskCreateHook(OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskCreateHook(ptcb);
+#endif
+}
+
+void OSTaskDelHook(OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskDelHook(ptcb);
+#endif
+}
+
+void OSTaskIdleHook(void)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskIdleHook();
+#endif
+}
+
+void OSTaskSwHook(void)
+{
+#if OS_APP_HOOKS_EN > 0
+    App_TaskSwHook();
+#endif
+}
+
+void OSTimeTickHook(void)
+{
+    OSHostNextTickNs = OSHostTimeNs() + OS_HOST_TICK_NS;
+    if (OSHostTickLimit != 0u && OSTime >= OSHostTickLimit) {
+        OSHostStop();
+    }
+#if OS_APP_HOOKS_EN > 0
+    App_TimeTickHook();
+#endif
+}
+
+/* Default application hooks, overridden by defining them in a program */
+__attribute__((weak)) void App_TaskCreateHook(OS_TCB *ptcb) { (void)ptcb; }
+__attribute__((weak)) void App_TaskDelHook(OS_TCB *ptcb)    { (void)ptcb; }
+__attribute__((weak)) void App_TaskIdleHook(void)           { }
+__attribute__((weak)) void App_TaskSwHook(void)             { }
+__attribute__((weak)) void App_TimeTickHook(void)           { }
+
+/* The Nios II HAL calls OSInit() before main(); do the same on the host */
+__attribute__((constructor)) static void OSHostBoot(void)
+{
+    OSInit();
+}
@@ -0,0 +1,361 @@
+/*
+ * Event flag groups of the host uC/OS-II.
+ *
+ * As in v2.86 a pending task links an OS_FLAG_NODE that lives on its own
+ * stack into the group's wait list; OSFlagPost walks the list and readies
+ * every task whose condition is met, and the task applies OS_FLAG_CONSUME
+ * itself once it runs again.
+ */
+#include "ucos_ii.h"
+
+static OS_FLAG_GRP  OSFlagTbl[OS_MAX_FLAGS];
+static OS_FLAG_GRP *OSFlagFreeList;
+
+/* Returns the subset of flags that satisfies wait_type, or 0 */
+static OS_FLAGS OS_FlagTest(OS_FLAGS current, OS_FLAGS flags, INT8U wait_type)
+{
+    OS_FLAGS rdy;
+
+    switch (wait_type) {
+        case OS_FLAG_WAIT_SET_ALL:
+            rdy = current & flags;
+            return (rdy == flags) ? rdy : 0u;
+
+        case OS_FLAG_WAIT_SET_ANY:
+            return current & flags;
+
+        case OS_FLAG_WAIT_CLR_ALL:
+            rdy = ~current & flags;
+            return (rdy == flags) ? rdy : 0u;
+
+        case OS_FLAG_WAIT_CLR_ANY:
+        default:
+            return ~current & flags;
+    }
+}
+
+static void OS_FlagConsume(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U wait_type)
+{
+    if (wait_type == OS_FLAG_WAIT_SET_ALL || wait_type == OS_FLAG_WAIT_SET_ANY) {
+        pgrp->OSFlagFlags &= (OS_FLAGS)~flags;
+    } else {
+        pgrp->OSFlagFlags |= flags;
+    }
+}
+
+/* Readies the task behind pnode; called with interrupts disabled */
+static void OS_FlagTaskRdy(OS_FLAG_NODE *pnode, OS_FLAGS flags_rdy, INT8U pend_stat)
+{
+    OS_TCB *ptcb = (OS_TCB *)pnode->OSFlagNodeTCB;
+
+    ptcb->OSTCBDly       = 0u;
+    ptcb->OSTCBFlagsRdy  = flags_rdy;
+    ptcb->OSTCBStat     &= (INT8U)~OS_STAT_FLAG;
+    ptcb->OSTCBStatPend  = pend_stat;
+    if (ptcb->OSTCBStat == OS_STAT_RDY) {
+        OSRdyGrp               |= ptcb->OSTCBBitY;
+        OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+    }
+    OS_FlagUnlink(pnode);
+}
+
+OS_FLAGS OSFlagAccept(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U wait_type, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_FLAGS   flags_rdy;
+    BOOLEAN    consume;
+
+    if (pgrp == NULL) {
+        *perr = OS_ERR_FLAG_INVALID_PGRP;
+        return 0u;
+    }
+    if (pgrp->OSFlagType != OS_EVENT_TYPE_FLAG) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return 0u;
+    }
+    consume    = ((wait_type & OS_FLAG_CONSUME) != 0u) ? OS_TRUE : OS_FALSE;
+    wait_type &= (INT8U)~OS_FLAG_CONSUME;
+    if (wait_type > OS_FLAG_WAIT_SET_ANY) {
+        *perr = OS_ERR_FLAG_WAIT_TYPE;
+        return 0u;
+    }
+
+    OS_ENTER_CRITICAL();
+    flags_rdy = OS_FlagTest(pgrp->OSFlagFlags, flags, wait_type);
+    if (flags_rdy != 0u && consume == OS_TRUE) {
+        OS_FlagConsume(pgrp, flags_rdy, wait_type);
+    }
+    OS_EXIT_CRITICAL();
+    *perr = (flags_rdy != 0u) ? OS_ERR_NONE : OS_ERR_FLAG_NOT_RDY;
+    return flags_rdy;
+}
+
+OS_FLAG_GRP *OSFlagCreate(OS_FLAGS flags, INT8U *perr)
+{
+    OS_CPU_SR    cpu_sr = 0u;
+    OS_FLAG_GRP *pgrp;
+
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_CREATE_ISR;
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    pgrp = OSFlagFreeList;
+    if (pgrp == NULL) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_FLAG_GRP_DEPLETED;
+        return NULL;
+    }
+    OSFlagFreeList       = (OS_FLAG_GRP *)pgrp->OSFlagWaitList;
+    pgrp->OSFlagType     = OS_EVENT_TYPE_FLAG;
+    pgrp->OSFlagFlags    = flags;
+    pgrp->OSFlagWaitList = NULL;
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return pgrp;
+}
+
+OS_FLAG_GRP *OSFlagDel(OS_FLAG_GRP *pgrp, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    BOOLEAN    tasks_waiting;
+
+    if (pgrp == NULL) {
+        *perr = OS_ERR_FLAG_INVALID_PGRP;
+        return pgrp;
+    }
+    if (pgrp->OSFlagType != OS_EVENT_TYPE_FLAG) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return pgrp;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_DEL_ISR;
+        return pgrp;
+    }
+    if (opt != OS_DEL_NO_PEND && opt != OS_DEL_ALWAYS) {
+        *perr = OS_ERR_INVALID_OPT;
+        return pgrp;
+    }
+
+    OS_ENTER_CRITICAL();
+    tasks_waiting = (pgrp->OSFlagWaitList != NULL) ? OS_TRUE : OS_FALSE;
+    if (opt == OS_DEL_NO_PEND && tasks_waiting == OS_TRUE) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_TASK_WAITING;
+        return pgrp;
+    }
+    while (pgrp->OSFlagWaitList != NULL) {
+        OS_FlagTaskRdy((OS_FLAG_NODE *)pgrp->OSFlagWaitList, 0u, OS_STAT_PEND_ABORT);
+    }
+    pgrp->OSFlagType     = OS_EVENT_TYPE_UNUSED;
+    pgrp->OSFlagFlags    = 0u;
+    pgrp->OSFlagWaitList = OSFlagFreeList;
+    OSFlagFreeList       = pgrp;
+    OS_EXIT_CRITICAL();
+    if (tasks_waiting == OS_TRUE) {
+        OS_Sched();
+    }
+    *perr = OS_ERR_NONE;
+    return NULL;
+}
+
+OS_FLAGS OSFlagPend(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U wait_type, INT32U timeout, INT8U *perr)
+{
+    OS_CPU_SR     cpu_sr = 0u;
+    OS_FLAG_NODE  node;
+    OS_FLAGS      flags_rdy;
+    BOOLEAN       consume;
+    INT8U         y;
+
+    if (pgrp == NULL) {
+        *perr = OS_ERR_FLAG_INVALID_PGRP;
+        return 0u;
+    }
+    if (pgrp->OSFlagType != OS_EVENT_TYPE_FLAG) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return 0u;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return 0u;
+    }
+    if (OSLockNesting > 0u) {
+        *perr = OS_ERR_PEND_LOCKED;
+        return 0u;
+    }
+    consume    = ((wait_type & OS_FLAG_CONSUME) != 0u) ? OS_TRUE : OS_FALSE;
+    wait_type &= (INT8U)~OS_FLAG_CONSUME;
+    if (wait_type > OS_FLAG_WAIT_SET_ANY) {
+        *perr = OS_ERR_FLAG_WAIT_TYPE;
+        return 0u;
+    }
+
+    OS_ENTER_CRITICAL();
+    flags_rdy = OS_FlagTest(pgrp->OSFlagFlags, flags, wait_type);
+    if (flags_rdy != 0u) {
+        if (consume == OS_TRUE) {
+            OS_FlagConsume(pgrp, flags_rdy, wait_type);
+        }
+        OSTCBCur->OSTCBFlagsRdy = flags_rdy;
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return flags_rdy;
+    }
+
+    /* Block: link a node at the head of the wait list and leave the ready list */
+    node.OSFlagNodeFlags    = flags;
+    node.OSFlagNodeWaitType = wait_type;
+    node.OSFlagNodeTCB      = OSTCBCur;
+    node.OSFlagNodeFlagGrp  = pgrp;
+    node.OSFlagNodePrev     = NULL;
+    node.OSFlagNodeNext     = pgrp->OSFlagWaitList;
+    if (node.OSFlagNodeNext != NULL) {
+        ((OS_FLAG_NODE *)node.OSFlagNodeNext)->OSFlagNodePrev = &node;
+    }
+    pgrp->OSFlagWaitList = &node;
+
+    OSTCBCur->OSTCBStat     |= OS_STAT_FLAG;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBDly       = timeout;
+    OSTCBCur->OSTCBFlagNode  = &node;
+    y            = OSTCBCur->OSTCBY;
+    OSRdyTbl[y] &= (INT8U)~OSTCBCur->OSTCBBitX;
+    if (OSRdyTbl[y] == 0u) {
+        OSRdyGrp &= (INT8U)~OSTCBCur->OSTCBBitY;
+    }
+    OS_EXIT_CRITICAL();
+    OS_Sched();
+
+    OS_ENTER_CRITICAL();
+    if (OSTCBCur->OSTCBStatPend != OS_STAT_PEND_OK) {
+        *perr = (OSTCBCur->OSTCBStatPend == OS_STAT_PEND_ABORT) ? OS_ERR_PEND_ABORT : OS_ERR_TIMEOUT;
+        if (OSTCBCur->OSTCBFlagNode != NULL) {
+            OS_FlagUnlink(OSTCBCur->OSTCBFlagNode);
+        }
+        OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+        OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+        OS_EXIT_CRITICAL();
+        return 0u;
+    }
+    flags_rdy = OSTCBCur->OSTCBFlagsRdy;
+    if (consume == OS_TRUE) {
+        OS_FlagConsume(pgrp, flags_rdy, wait_type);
+    }
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return flags_rdy;
+}
+
+OS_FLAGS OSFlagPendGetFlagsRdy(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    OS_FLAGS  flags;
+
+    OS_ENTER_CRITICAL();
+    flags = OSTCBCur->OSTCBFlagsRdy;
+    OS_EXIT_CRITICAL();
+    return flags;
+}
+
+OS_FLAGS OSFlagPost(OS_FLAG_GRP *pgrp, OS_FLAGS flags, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR      cpu_sr = 0u;
+    OS_FLAG_NODE  *pnode;
+    OS_FLAG_NODE  *pnext;
+    OS_FLAGS       flags_rdy;
+    OS_FLAGS       flags_cur;
+    BOOLEAN        sched;
+
+    if (pgrp == NULL) {
+        *perr = OS_ERR_FLAG_INVALID_PGRP;
+        return 0u;
+    }
+    if (pgrp->OSFlagType != OS_EVENT_TYPE_FLAG) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return 0u;
+    }
+    if (opt != OS_FLAG_SET && opt != OS_FLAG_CLR) {
+        *perr = OS_ERR_FLAG_INVALID_OPT;
+        return 0u;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (opt == OS_FLAG_SET) {
+        pgrp->OSFlagFlags |= flags;
+    } else {
+        pgrp->OSFlagFlags &= (OS_FLAGS)~flags;
+    }
+    sched = OS_FALSE;
+    pnode = (OS_FLAG_NODE *)pgrp->OSFlagWaitList;
+    while (pnode != NULL) {
+        pnext     = (OS_FLAG_NODE *)pnode->OSFlagNodeNext;
+        flags_rdy = OS_FlagTest(pgrp->OSFlagFlags, pnode->OSFlagNodeFlags, pnode->OSFlagNodeWaitType);
+        if (flags_rdy != 0u) {
+            OS_FlagTaskRdy(pnode, flags_rdy, OS_STAT_PEND_OK);
+            sched = OS_TRUE;
+        }
+        pnode = pnext;
+    }
+    flags_cur = pgrp->OSFlagFlags;
+    OS_EXIT_CRITICAL();
+    if (sched == OS_TRUE) {
+        OS_Sched();
+    }
+    *perr = OS_ERR_NONE;
+    return flags_cur;
+}
+
+OS_FLAGS OSFlagQuery(OS_FLAG_GRP *pgrp, INT8U *perr)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    OS_FLAGS  flags;
+
+    if (pgrp == NULL) {
+        *perr = OS_ERR_FLAG_INVALID_PGRP;
+        return 0u;
+    }
+    if (pgrp->OSFlagType != OS_EVENT_TYPE_FLAG) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return 0u;
+    }
+    OS_ENTER_CRITICAL();
+    flags = pgrp->OSFlagFlags;
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return flags;
+}
+
+/* Removes a node from its group's wait list; called with interrupts disabled */
+void OS_FlagUnlink(OS_FLAG_NODE *pnode)
+{
+    OS_FLAG_GRP  *pgrp;
+    OS_FLAG_NODE *pprev;
+    OS_FLAG_NODE *pnext;
+
+    pprev = (OS_FLAG_NODE *)pnode->OSFlagNodePrev;
+    pnext = (OS_FLAG_NODE *)pnode->OSFlagNodeNext;
+    if (pprev == NULL) {
+        pgrp                 = (OS_FLAG_GRP *)pnode->OSFlagNodeFlagGrp;
+        pgrp->OSFlagWaitList = pnext;
+    } else {
+        pprev->OSFlagNodeNext = pnext;
+    }
+    if (pnext != NULL) {
+        pnext->OSFlagNodePrev = pprev;
+    }
+    ((OS_TCB *)pnode->OSFlagNodeTCB)->OSTCBFlagNode = NULL;
+}
+
+void OS_FlagInit(void)
+{
+    INT16U i;
+
+    for (i = 0u; i < OS_MAX_FLAGS - 1u; i++) {
+        OSFlagTbl[i].OSFlagType     = OS_EVENT_TYPE_UNUSED;
+        OSFlagTbl[i].OSFlagWaitList = &OSFlagTbl[i + 1u];
+    }
+    OSFlagTbl[OS_MAX_FLAGS - 1u].OSFlagType     = OS_EVENT_TYPE_UNUSED;
+    OSFlagTbl[OS_MAX_FLAGS - 1u].OSFlagWaitList = NULL;
+    OSFlagFreeList = &OSFlagTbl[0];
+}
@@ -0,0 +1,206 @@
+/*
+ * Message mailboxes of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+void *OSMboxAccept(OS_EVENT *pevent)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    void      *pmsg;
+
+    if (pevent == NULL || pevent->OSEventType != OS_EVENT_TYPE_MBOX) {
+        return NULL;
+    }
+    OS_ENTER_CRITICAL();
+    pmsg               = pevent->OSEventPtr;
+    pevent->OSEventPtr = NULL;
+    OS_EXIT_CRITICAL();
+    return pmsg;
+}
+
+OS_EVENT *OSMboxCreate(void *pmsg)
+{
+    OS_EVENT *pevent;
+
+    if (OSIntNesting > 0u) {
+        return NULL;
+    }
+    pevent = OS_EventAlloc();
+    if (pevent != NULL) {
+        pevent->OSEventType = OS_EVENT_TYPE_MBOX;
+        pevent->OSEventCnt  = 0u;
+        pevent->OSEventPtr  = pmsg;
+        OS_EventWaitListInit(pevent);
+    }
+    return pevent;
+}
+
+OS_EVENT *OSMboxDel(OS_EVENT *pevent, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    BOOLEAN   tasks_waiting;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return pevent;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return pevent;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_DEL_ISR;
+        return pevent;
+    }
+
+    OS_ENTER_CRITICAL();
+    tasks_waiting = (pevent->OSEventGrp != 0u) ? OS_TRUE : OS_FALSE;
+    switch (opt) {
+        case OS_DEL_NO_PEND:
+            if (tasks_waiting == OS_TRUE) {
+                OS_EXIT_CRITICAL();
+                *perr = OS_ERR_TASK_WAITING;
+                return pevent;
+            }
+            OS_EventFree(pevent);
+            OS_EXIT_CRITICAL();
+            *perr = OS_ERR_NONE;
+            return NULL;
+
+        case OS_DEL_ALWAYS:
+            while (pevent->OSEventGrp != 0u) {
+                (void)OS_EventTaskRdy(pevent, NULL, OS_STAT_MBOX, OS_STAT_PEND_ABORT);
+            }
+            OS_EventFree(pevent);
+            OS_EXIT_CRITICAL();
+            if (tasks_waiting == OS_TRUE) {
+                OS_Sched();
+            }
+            *perr = OS_ERR_NONE;
+            return NULL;
+
+        default:
+            OS_EXIT_CRITICAL();
+            *perr = OS_ERR_INVALID_OPT;
+            return pevent;
+    }
+}
+
+void *OSMboxPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    void      *pmsg;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return NULL;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return NULL;
+    }
+    if (OSLockNesting > 0u) {
+        *perr = OS_ERR_PEND_LOCKED;
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    pmsg = pevent->OSEventPtr;
+    if (pmsg != NULL) {
+        pevent->OSEventPtr = NULL;
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return pmsg;
+    }
+    OSTCBCur->OSTCBStat     |= OS_STAT_MBOX;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBDly       = timeout;
+    OS_EventTaskWait(pevent);
+    OS_EXIT_CRITICAL();
+    OS_Sched();
+
+    OS_ENTER_CRITICAL();
+    switch (OSTCBCur->OSTCBStatPend) {
+        case OS_STAT_PEND_OK:
+            pmsg  = OSTCBCur->OSTCBMsg;
+            *perr = OS_ERR_NONE;
+            break;
+
+        case OS_STAT_PEND_ABORT:
+            pmsg  = NULL;
+            *perr = OS_ERR_PEND_ABORT;
+            break;
+
+        case OS_STAT_PEND_TO:
+        default:
+            OS_EventTaskRemove(OSTCBCur, pevent);
+            pmsg  = NULL;
+            *perr = OS_ERR_TIMEOUT;
+            break;
+    }
+    OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+    OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBEventPtr = NULL;
+    OSTCBCur->OSTCBMsg      = NULL;
+    OS_EXIT_CRITICAL();
+    return pmsg;
+}
+
+INT8U OSMboxPost(OS_EVENT *pevent, void *pmsg)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (pmsg == NULL) {
+        return OS_ERR_POST_NULL_PTR;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (pevent->OSEventGrp != 0u) {
+        (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_MBOX, OS_STAT_PEND_OK);
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return OS_ERR_NONE;
+    }
+    if (pevent->OSEventPtr != NULL) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_MBOX_FULL;
+    }
+    pevent->OSEventPtr = pmsg;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+INT8U OSMboxQuery(OS_EVENT *pevent, OS_MBOX_DATA *p_mbox_data)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     i;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (p_mbox_data == NULL) {
+        return OS_ERR_PDATA_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MBOX) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    p_mbox_data->OSEventGrp = pevent->OSEventGrp;
+    for (i = 0u; i < OS_EVENT_TBL_SIZE; i++) {
+        p_mbox_data->OSEventTbl[i] = pevent->OSEventTbl[i];
+    }
+    p_mbox_data->OSMsg = pevent->OSEventPtr;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
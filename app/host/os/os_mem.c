@@ -0,0 +1,140 @@
+/*
+ * Fixed-size memory partitions of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+static OS_MEM  OSMemTbl[OS_MAX_MEM_PART];
+static OS_MEM *OSMemFreeList;
+
+OS_MEM *OSMemCreate(void *addr, INT32U nblks, INT32U blksize, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_MEM    *pmem;
+    INT8U     *pblk;
+    void     **plink;
+    INT32U     i;
+
+    if (addr == NULL) {
+        *perr = OS_ERR_MEM_INVALID_ADDR;
+        return NULL;
+    }
+    if (((size_t)addr & (sizeof(void *) - 1u)) != 0u) {
+        *perr = OS_ERR_MEM_INVALID_ADDR;
+        return NULL;
+    }
+    if (nblks < 2u) {
+        *perr = OS_ERR_MEM_INVALID_BLKS;
+        return NULL;
+    }
+    if (blksize < sizeof(void *)) {
+        *perr = OS_ERR_MEM_INVALID_SIZE;
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    pmem = OSMemFreeList;
+    if (OSMemFreeList != NULL) {
+        OSMemFreeList = (OS_MEM *)OSMemFreeList->OSMemFreeList;
+    }
+    OS_EXIT_CRITICAL();
+    if (pmem == NULL) {
+        *perr = OS_ERR_MEM_INVALID_PART;
+        return NULL;
+    }
+
+    /* Link every block to the next one */
+    plink = (void **)addr;
+    pblk  = (INT8U *)addr + blksize;
+    for (i = 0u; i < nblks - 1u; i++) {
+        *plink = (void *)pblk;
+        plink  = (void **)pblk;
+        pblk   = pblk + blksize;
+    }
+    *plink = NULL;
+
+    pmem->OSMemAddr     = addr;
+    pmem->OSMemFreeList = addr;
+    pmem->OSMemNFree    = nblks;
+    pmem->OSMemNBlks    = nblks;
+    pmem->OSMemBlkSize  = blksize;
+    *perr               = OS_ERR_NONE;
+    return pmem;
+}
+
+void *OSMemGet(OS_MEM *pmem, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    void      *pblk;
+
+    if (pmem == NULL) {
+        *perr = OS_ERR_MEM_INVALID_PMEM;
+        return NULL;
+    }
+    OS_ENTER_CRITICAL();
+    if (pmem->OSMemNFree > 0u) {
+        pblk                = pmem->OSMemFreeList;
+        pmem->OSMemFreeList = *(void **)pblk;
+        pmem->OSMemNFree--;
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return pblk;
+    }
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_MEM_NO_FREE_BLKS;
+    return NULL;
+}
+
+INT8U OSMemPut(OS_MEM *pmem, void *pblk)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (pmem == NULL) {
+        return OS_ERR_MEM_INVALID_PMEM;
+    }
+    if (pblk == NULL) {
+        return OS_ERR_MEM_INVALID_PBLK;
+    }
+    OS_ENTER_CRITICAL();
+    if (pmem->OSMemNFree >= pmem->OSMemNBlks) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_MEM_FULL;
+    }
+    *(void **)pblk      = pmem->OSMemFreeList;
+    pmem->OSMemFreeList = pblk;
+    pmem->OSMemNFree++;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+INT8U OSMemQuery(OS_MEM *pmem, OS_MEM_DATA *p_mem_data)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (pmem == NULL) {
+        return OS_ERR_MEM_INVALID_PMEM;
+    }
+    if (p_mem_data == NULL) {
+        return OS_ERR_MEM_INVALID_PDATA;
+    }
+    OS_ENTER_CRITICAL();
+    p_mem_data->OSAddr     = pmem->OSMemAddr;
+    p_mem_data->OSFreeList = pmem->OSMemFreeList;
+    p_mem_data->OSBlkSize  = pmem->OSMemBlkSize;
+    p_mem_data->OSNBlks    = pmem->OSMemNBlks;
+    p_mem_data->OSNFree    = pmem->OSMemNFree;
+    OS_EXIT_CRITICAL();
+    p_mem_data->OSNUsed    = p_mem_data->OSNBlks - p_mem_data->OSNFree;
+    return OS_ERR_NONE;
+}
+
+void OS_MemInit(void)
+{
+    INT16U i;
+
+    for (i = 0u; i < OS_MAX_MEM_PART - 1u; i++) {
+        OSMemTbl[i].OSMemFreeList = (void *)&OSMemTbl[i + 1u];
+        OSMemTbl[i].OSMemNFree    = 0u;
+    }
+    OSMemTbl[OS_MAX_MEM_PART - 1u].OSMemFreeList = NULL;
+    OSMemFreeList = &OSMemTbl[0];
+}
@@ -0,0 +1,327 @@
+/*
+ * Mutual exclusion semaphores of the host uC/OS-II, with the v2.86 priority
+ * inheritance scheme: each mutex reserves a priority (PIP) above all its
+ * users and a low priority owner is raised to it while a higher priority
+ * task waits.
+ *
+ * OSEventCnt holds the PIP in its upper 8 bits and the owner's original
+ * priority (or OS_MUTEX_AVAILABLE) in its lower 8 bits; OSEventPtr is the
+ * owner's TCB.
+ */
+#include "ucos_ii.h"
+
+/*
+ * Moves a task to another priority, whether it is ready or waiting on an
+ * event. Called with interrupts disabled.
+ */
+static void OS_MutexSetPrio(OS_TCB *ptcb, INT8U prio)
+{
+    OS_EVENT *pevent = ptcb->OSTCBEventPtr;
+    BOOLEAN   rdy;
+    INT8U     y;
+
+    y   = ptcb->OSTCBY;
+    rdy = ((OSRdyTbl[y] & ptcb->OSTCBBitX) != 0u) ? OS_TRUE : OS_FALSE;
+    if (rdy == OS_TRUE) {
+        OSRdyTbl[y] &= (INT8U)~ptcb->OSTCBBitX;
+        if (OSRdyTbl[y] == 0u) {
+            OSRdyGrp &= (INT8U)~ptcb->OSTCBBitY;
+        }
+    }
+    if (pevent != NULL) {
+        pevent->OSEventTbl[y] &= (INT8U)~ptcb->OSTCBBitX;
+        if (pevent->OSEventTbl[y] == 0u) {
+            pevent->OSEventGrp &= (INT8U)~ptcb->OSTCBBitY;
+        }
+    }
+
+    ptcb->OSTCBPrio = prio;
+    ptcb->OSTCBY    = (INT8U)(prio >> 3u);
+    ptcb->OSTCBX    = (INT8U)(prio & 0x07u);
+    ptcb->OSTCBBitY = (INT8U)(1u << ptcb->OSTCBY);
+    ptcb->OSTCBBitX = (INT8U)(1u << ptcb->OSTCBX);
+
+    if (rdy == OS_TRUE) {
+        OSRdyGrp               |= ptcb->OSTCBBitY;
+        OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+    }
+    if (pevent != NULL) {
+        pevent->OSEventTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+        pevent->OSEventGrp               |= ptcb->OSTCBBitY;
+    }
+}
+
+/* Drops a raised owner back to its own priority. Called with interrupts disabled. */
+static void OS_MutexRestorePrio(OS_TCB *ptcb, INT8U prio, INT8U pip)
+{
+    OS_MutexSetPrio(ptcb, prio);
+    OSTCBPrioTbl[prio] = ptcb;
+    OSTCBPrioTbl[pip]  = OS_TCB_RESERVED;
+}
+
+BOOLEAN OSMutexAccept(OS_EVENT *pevent, INT8U *perr)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     pip;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return OS_FALSE;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return OS_FALSE;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return OS_FALSE;
+    }
+
+    OS_ENTER_CRITICAL();
+    if ((pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8) == OS_MUTEX_AVAILABLE) {
+        pip                 = (INT8U)(pevent->OSEventCnt >> 8u);
+        pevent->OSEventCnt &= OS_MUTEX_KEEP_UPPER_8;
+        pevent->OSEventCnt |= OSTCBCur->OSTCBPrio;
+        pevent->OSEventPtr  = OSTCBCur;
+        OS_EXIT_CRITICAL();
+        *perr = (OSTCBCur->OSTCBPrio <= pip) ? OS_ERR_PIP_LOWER : OS_ERR_NONE;
+        return OS_TRUE;
+    }
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return OS_FALSE;
+}
+
+OS_EVENT *OSMutexCreate(INT8U prio, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_EVENT  *pevent;
+
+    if (prio >= OS_LOWEST_PRIO) {
+        *perr = OS_ERR_PRIO_INVALID;
+        return NULL;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_CREATE_ISR;
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (OSTCBPrioTbl[prio] != NULL) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_PRIO_EXIST;
+        return NULL;
+    }
+    OSTCBPrioTbl[prio] = OS_TCB_RESERVED;
+    OS_EXIT_CRITICAL();
+
+    pevent = OS_EventAlloc();
+    if (pevent == NULL) {
+        OS_ENTER_CRITICAL();
+        OSTCBPrioTbl[prio] = NULL;
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_PEVENT_NULL;
+        return NULL;
+    }
+    pevent->OSEventType = OS_EVENT_TYPE_MUTEX;
+    pevent->OSEventCnt  = (INT16U)((INT16U)prio << 8u) | OS_MUTEX_AVAILABLE;
+    pevent->OSEventPtr  = NULL;
+    OS_EventWaitListInit(pevent);
+    *perr = OS_ERR_NONE;
+    return pevent;
+}
+
+OS_EVENT *OSMutexDel(OS_EVENT *pevent, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    BOOLEAN    tasks_waiting;
+    OS_TCB    *ptcb;
+    INT8U      pip;
+    INT8U      prio;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return pevent;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return pevent;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_DEL_ISR;
+        return pevent;
+    }
+    if (opt != OS_DEL_NO_PEND && opt != OS_DEL_ALWAYS) {
+        *perr = OS_ERR_INVALID_OPT;
+        return pevent;
+    }
+
+    OS_ENTER_CRITICAL();
+    tasks_waiting = (pevent->OSEventGrp != 0u) ? OS_TRUE : OS_FALSE;
+    if (opt == OS_DEL_NO_PEND && tasks_waiting == OS_TRUE) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_TASK_WAITING;
+        return pevent;
+    }
+
+    pip  = (INT8U)(pevent->OSEventCnt >> 8u);
+    prio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);
+    ptcb = (OS_TCB *)pevent->OSEventPtr;
+    if (ptcb != NULL && ptcb->OSTCBPrio == pip) {
+        OS_MutexRestorePrio(ptcb, prio, pip);
+    }
+    while (pevent->OSEventGrp != 0u) {
+        (void)OS_EventTaskRdy(pevent, NULL, OS_STAT_MUTEX, OS_STAT_PEND_ABORT);
+    }
+    OSTCBPrioTbl[pip] = NULL;
+    OS_EventFree(pevent);
+    OS_EXIT_CRITICAL();
+    if (tasks_waiting == OS_TRUE) {
+        OS_Sched();
+    }
+    *perr = OS_ERR_NONE;
+    return NULL;
+}
+
+void OSMutexPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+    INT8U      pip;
+    INT8U      mprio;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return;
+    }
+    if (OSLockNesting > 0u) {
+        *perr = OS_ERR_PEND_LOCKED;
+        return;
+    }
+
+    OS_ENTER_CRITICAL();
+    pip = (INT8U)(pevent->OSEventCnt >> 8u);
+    if ((pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8) == OS_MUTEX_AVAILABLE) {
+        pevent->OSEventCnt &= OS_MUTEX_KEEP_UPPER_8;
+        pevent->OSEventCnt |= OSTCBCur->OSTCBPrio;
+        pevent->OSEventPtr  = OSTCBCur;
+        OS_EXIT_CRITICAL();
+        *perr = (OSTCBCur->OSTCBPrio <= pip) ? OS_ERR_PIP_LOWER : OS_ERR_NONE;
+        return;
+    }
+
+    /* Raise a lower priority owner to the PIP so it cannot be preempted by medium work */
+    mprio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);
+    ptcb  = (OS_TCB *)pevent->OSEventPtr;
+    if (ptcb->OSTCBPrio > pip && mprio > OSTCBCur->OSTCBPrio) {
+        OS_MutexSetPrio(ptcb, pip);
+        OSTCBPrioTbl[pip]   = ptcb;
+        OSTCBPrioTbl[mprio] = OS_TCB_RESERVED;
+    }
+
+    OSTCBCur->OSTCBStat     |= OS_STAT_MUTEX;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBDly       = timeout;
+    OS_EventTaskWait(pevent);
+    OS_EXIT_CRITICAL();
+    OS_Sched();
+
+    OS_ENTER_CRITICAL();
+    switch (OSTCBCur->OSTCBStatPend) {
+        case OS_STAT_PEND_OK:
+            *perr = OS_ERR_NONE;
+            break;
+
+        case OS_STAT_PEND_ABORT:
+            *perr = OS_ERR_PEND_ABORT;
+            break;
+
+        case OS_STAT_PEND_TO:
+        default:
+            OS_EventTaskRemove(OSTCBCur, pevent);
+            *perr = OS_ERR_TIMEOUT;
+            break;
+    }
+    OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+    OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBEventPtr = NULL;
+    OS_EXIT_CRITICAL();
+}
+
+INT8U OSMutexPost(OS_EVENT *pevent)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     pip;
+    INT8U     prio;
+
+    if (OSIntNesting > 0u) {
+        return OS_ERR_POST_ISR;
+    }
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (OSTCBCur != (OS_TCB *)pevent->OSEventPtr) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_NOT_MUTEX_OWNER;
+    }
+    pip  = (INT8U)(pevent->OSEventCnt >> 8u);
+    prio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);
+    if (OSTCBCur->OSTCBPrio == pip) {
+        OS_MutexRestorePrio(OSTCBCur, prio, pip);
+    }
+
+    if (pevent->OSEventGrp != 0u) {
+        /* Hand the mutex straight to the highest priority waiter */
+        prio                = OS_EventTaskRdy(pevent, NULL, OS_STAT_MUTEX, OS_STAT_PEND_OK);
+        pevent->OSEventCnt &= OS_MUTEX_KEEP_UPPER_8;
+        pevent->OSEventCnt |= prio;
+        pevent->OSEventPtr  = OSTCBPrioTbl[prio];
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return (prio <= pip) ? OS_ERR_PIP_LOWER : OS_ERR_NONE;
+    }
+    pevent->OSEventCnt |= OS_MUTEX_AVAILABLE;
+    pevent->OSEventPtr  = NULL;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+INT8U OSMutexQuery(OS_EVENT *pevent, OS_MUTEX_DATA *p_mutex_data)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     i;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (p_mutex_data == NULL) {
+        return OS_ERR_PDATA_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    p_mutex_data->OSMutexPIP  = (INT8U)(pevent->OSEventCnt >> 8u);
+    p_mutex_data->OSOwnerPrio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);
+    p_mutex_data->OSValue     = (p_mutex_data->OSOwnerPrio == 0xFFu) ? OS_TRUE : OS_FALSE;
+    p_mutex_data->OSEventGrp  = pevent->OSEventGrp;
+    for (i = 0u; i < OS_EVENT_TBL_SIZE; i++) {
+        p_mutex_data->OSEventTbl[i] = pevent->OSEventTbl[i];
+    }
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
@@ -0,0 +1,304 @@
+/*
+ * Message queues of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+static OS_Q  OSQTbl[OS_MAX_QS];
+static OS_Q *OSQFreeList;
+
+void *OSQAccept(OS_EVENT *pevent, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_Q      *pq;
+    void      *pmsg;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return NULL;
+    }
+    OS_ENTER_CRITICAL();
+    pq = (OS_Q *)pevent->OSEventPtr;
+    if (pq->OSQEntries > 0u) {
+        pmsg = *pq->OSQOut++;
+        pq->OSQEntries--;
+        if (pq->OSQOut == pq->OSQEnd) {
+            pq->OSQOut = pq->OSQStart;
+        }
+        *perr = OS_ERR_NONE;
+    } else {
+        pmsg  = NULL;
+        *perr = OS_ERR_Q_EMPTY;
+    }
+    OS_EXIT_CRITICAL();
+    return pmsg;
+}
+
+OS_EVENT *OSQCreate(void **start, INT16U size)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_EVENT  *pevent;
+    OS_Q      *pq;
+
+    if (OSIntNesting > 0u) {
+        return NULL;
+    }
+    pevent = OS_EventAlloc();
+    if (pevent == NULL) {
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    pq = OSQFreeList;
+    if (pq != NULL) {
+        OSQFreeList = pq->OSQPtr;
+    }
+    OS_EXIT_CRITICAL();
+    if (pq == NULL) {
+        OS_ENTER_CRITICAL();
+        OS_EventFree(pevent);
+        OS_EXIT_CRITICAL();
+        return NULL;
+    }
+
+    pq->OSQStart        = start;
+    pq->OSQEnd          = &start[size];
+    pq->OSQIn           = start;
+    pq->OSQOut          = start;
+    pq->OSQSize         = size;
+    pq->OSQEntries      = 0u;
+    pevent->OSEventType = OS_EVENT_TYPE_Q;
+    pevent->OSEventCnt  = 0u;
+    pevent->OSEventPtr  = pq;
+    OS_EventWaitListInit(pevent);
+    return pevent;
+}
+
+OS_EVENT *OSQDel(OS_EVENT *pevent, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    BOOLEAN    tasks_waiting;
+    OS_Q      *pq;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return pevent;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return pevent;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_DEL_ISR;
+        return pevent;
+    }
+
+    OS_ENTER_CRITICAL();
+    tasks_waiting = (pevent->OSEventGrp != 0u) ? OS_TRUE : OS_FALSE;
+    if (opt != OS_DEL_NO_PEND && opt != OS_DEL_ALWAYS) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_INVALID_OPT;
+        return pevent;
+    }
+    if (opt == OS_DEL_NO_PEND && tasks_waiting == OS_TRUE) {
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_TASK_WAITING;
+        return pevent;
+    }
+    while (pevent->OSEventGrp != 0u) {
+        (void)OS_EventTaskRdy(pevent, NULL, OS_STAT_Q, OS_STAT_PEND_ABORT);
+    }
+    pq          = (OS_Q *)pevent->OSEventPtr;
+    pq->OSQPtr  = OSQFreeList;
+    OSQFreeList = pq;
+    OS_EventFree(pevent);
+    OS_EXIT_CRITICAL();
+    if (tasks_waiting == OS_TRUE) {
+        OS_Sched();
+    }
+    *perr = OS_ERR_NONE;
+    return NULL;
+}
+
+INT8U OSQFlush(OS_EVENT *pevent)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_Q      *pq;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        return OS_ERR_EVENT_TYPE;
+    }
+    OS_ENTER_CRITICAL();
+    pq             = (OS_Q *)pevent->OSEventPtr;
+    pq->OSQIn      = pq->OSQStart;
+    pq->OSQOut     = pq->OSQStart;
+    pq->OSQEntries = 0u;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+void *OSQPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_Q      *pq;
+    void      *pmsg;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return NULL;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return NULL;
+    }
+    if (OSLockNesting > 0u) {
+        *perr = OS_ERR_PEND_LOCKED;
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL();
+    pq = (OS_Q *)pevent->OSEventPtr;
+    if (pq->OSQEntries > 0u) {
+        pmsg = *pq->OSQOut++;
+        pq->OSQEntries--;
+        if (pq->OSQOut == pq->OSQEnd) {
+            pq->OSQOut = pq->OSQStart;
+        }
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return pmsg;
+    }
+    OSTCBCur->OSTCBStat     |= OS_STAT_Q;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBDly       = timeout;
+    OS_EventTaskWait(pevent);
+    OS_EXIT_CRITICAL();
+    OS_Sched();
+
+    OS_ENTER_CRITICAL();
+    switch (OSTCBCur->OSTCBStatPend) {
+        case OS_STAT_PEND_OK:
+            pmsg  = OSTCBCur->OSTCBMsg;
+            *perr = OS_ERR_NONE;
+            break;
+
+        case OS_STAT_PEND_ABORT:
+            pmsg  = NULL;
+            *perr = OS_ERR_PEND_ABORT;
+            break;
+
+        case OS_STAT_PEND_TO:
+        default:
+            OS_EventTaskRemove(OSTCBCur, pevent);
+            pmsg  = NULL;
+            *perr = OS_ERR_TIMEOUT;
+            break;
+    }
+    OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+    OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBEventPtr = NULL;
+    OSTCBCur->OSTCBMsg      = NULL;
+    OS_EXIT_CRITICAL();
+    return pmsg;
+}
+
+static INT8U OS_QPost(OS_EVENT *pevent, void *pmsg, BOOLEAN front)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_Q      *pq;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (pevent->OSEventGrp != 0u) {
+        (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return OS_ERR_NONE;
+    }
+    pq = (OS_Q *)pevent->OSEventPtr;
+    if (pq->OSQEntries >= pq->OSQSize) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_Q_FULL;
+    }
+    if (front == OS_TRUE) {
+        if (pq->OSQOut == pq->OSQStart) {
+            pq->OSQOut = pq->OSQEnd;
+        }
+        pq->OSQOut--;
+        *pq->OSQOut = pmsg;
+    } else {
+        *pq->OSQIn++ = pmsg;
+        if (pq->OSQIn == pq->OSQEnd) {
+            pq->OSQIn = pq->OSQStart;
+        }
+    }
+    pq->OSQEntries++;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+INT8U OSQPost(OS_EVENT *pevent, void *pmsg)
+{
+    return OS_QPost(pevent, pmsg, OS_FALSE);
+}
+
+INT8U OSQPostFront(OS_EVENT *pevent, void *pmsg)
+{
+    return OS_QPost(pevent, pmsg, OS_TRUE);
+}
+
+INT8U OSQQuery(OS_EVENT *pevent, OS_Q_DATA *p_q_data)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_Q      *pq;
+    INT8U      i;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (p_q_data == NULL) {
+        return OS_ERR_PDATA_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    p_q_data->OSEventGrp = pevent->OSEventGrp;
+    for (i = 0u; i < OS_EVENT_TBL_SIZE; i++) {
+        p_q_data->OSEventTbl[i] = pevent->OSEventTbl[i];
+    }
+    pq = (OS_Q *)pevent->OSEventPtr;
+    p_q_data->OSMsg   = (pq->OSQEntries > 0u) ? *pq->OSQOut : NULL;
+    p_q_data->OSNMsgs = pq->OSQEntries;
+    p_q_data->OSQSize = pq->OSQSize;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
+
+void OS_QInit(void)
+{
+    INT16U i;
+
+    for (i = 0u; i < OS_MAX_QS - 1u; i++) {
+        OSQTbl[i].OSQPtr = &OSQTbl[i + 1u];
+    }
+    OSQTbl[OS_MAX_QS - 1u].OSQPtr = NULL;
+    OSQFreeList = &OSQTbl[0];
+}
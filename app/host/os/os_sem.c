@@ -0,0 +1,198 @@
+/*
+ * Counting semaphores of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+INT16U OSSemAccept(OS_EVENT *pevent)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT16U    cnt;
+
+    if (pevent == NULL || pevent->OSEventType != OS_EVENT_TYPE_SEM) {
+        return 0u;
+    }
+    OS_ENTER_CRITICAL();
+    cnt = pevent->OSEventCnt;
+    if (cnt > 0u) {
+        pevent->OSEventCnt--;
+    }
+    OS_EXIT_CRITICAL();
+    return cnt;
+}
+
+OS_EVENT *OSSemCreate(INT16U cnt)
+{
+    OS_EVENT *pevent;
+
+    if (OSIntNesting > 0u) {
+        return NULL;
+    }
+    pevent = OS_EventAlloc();
+    if (pevent != NULL) {
+        pevent->OSEventType = OS_EVENT_TYPE_SEM;
+        pevent->OSEventCnt  = cnt;
+        pevent->OSEventPtr  = NULL;
+        OS_EventWaitListInit(pevent);
+    }
+    return pevent;
+}
+
+OS_EVENT *OSSemDel(OS_EVENT *pevent, INT8U opt, INT8U *perr)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    BOOLEAN   tasks_waiting;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return pevent;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return pevent;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_DEL_ISR;
+        return pevent;
+    }
+
+    OS_ENTER_CRITICAL();
+    tasks_waiting = (pevent->OSEventGrp != 0u) ? OS_TRUE : OS_FALSE;
+    switch (opt) {
+        case OS_DEL_NO_PEND:
+            if (tasks_waiting == OS_TRUE) {
+                OS_EXIT_CRITICAL();
+                *perr = OS_ERR_TASK_WAITING;
+                return pevent;
+            }
+            OS_EventFree(pevent);
+            OS_EXIT_CRITICAL();
+            *perr = OS_ERR_NONE;
+            return NULL;
+
+        case OS_DEL_ALWAYS:
+            while (pevent->OSEventGrp != 0u) {
+                (void)OS_EventTaskRdy(pevent, NULL, OS_STAT_SEM, OS_STAT_PEND_ABORT);
+            }
+            OS_EventFree(pevent);
+            OS_EXIT_CRITICAL();
+            if (tasks_waiting == OS_TRUE) {
+                OS_Sched();
+            }
+            *perr = OS_ERR_NONE;
+            return NULL;
+
+        default:
+            OS_EXIT_CRITICAL();
+            *perr = OS_ERR_INVALID_OPT;
+            return pevent;
+    }
+}
+
+void OSSemPend(OS_EVENT *pevent, INT32U timeout, INT8U *perr)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (pevent == NULL) {
+        *perr = OS_ERR_PEVENT_NULL;
+        return;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {
+        *perr = OS_ERR_EVENT_TYPE;
+        return;
+    }
+    if (OSIntNesting > 0u) {
+        *perr = OS_ERR_PEND_ISR;
+        return;
+    }
+    if (OSLockNesting > 0u) {
+        *perr = OS_ERR_PEND_LOCKED;
+        return;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (pevent->OSEventCnt > 0u) {
+        pevent->OSEventCnt--;
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return;
+    }
+    OSTCBCur->OSTCBStat     |= OS_STAT_SEM;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBDly       = timeout;
+    OS_EventTaskWait(pevent);
+    OS_EXIT_CRITICAL();
+    OS_Sched();
+
+    OS_ENTER_CRITICAL();
+    switch (OSTCBCur->OSTCBStatPend) {
+        case OS_STAT_PEND_OK:
+            *perr = OS_ERR_NONE;
+            break;
+
+        case OS_STAT_PEND_ABORT:
+            *perr = OS_ERR_PEND_ABORT;
+            break;
+
+        case OS_STAT_PEND_TO:
+        default:
+            OS_EventTaskRemove(OSTCBCur, pevent);
+            *perr = OS_ERR_TIMEOUT;
+            break;
+    }
+    OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+    OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+    OSTCBCur->OSTCBEventPtr = NULL;
+    OS_EXIT_CRITICAL();
+}
+
+INT8U OSSemPost(OS_EVENT *pevent)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (pevent->OSEventGrp != 0u) {
+        (void)OS_EventTaskRdy(pevent, NULL, OS_STAT_SEM, OS_STAT_PEND_OK);
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return OS_ERR_NONE;
+    }
+    if (pevent->OSEventCnt < 65535u) {
+        pevent->OSEventCnt++;
+        OS_EXIT_CRITICAL();
+        return OS_ERR_NONE;
+    }
+    OS_EXIT_CRITICAL();
+    return OS_ERR_SEM_OVF;
+}
+
+INT8U OSSemQuery(OS_EVENT *pevent, OS_SEM_DATA *p_sem_data)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     i;
+
+    if (pevent == NULL) {
+        return OS_ERR_PEVENT_NULL;
+    }
+    if (p_sem_data == NULL) {
+        return OS_ERR_PDATA_NULL;
+    }
+    if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {
+        return OS_ERR_EVENT_TYPE;
+    }
+
+    OS_ENTER_CRITICAL();
+    p_sem_data->OSEventGrp = pevent->OSEventGrp;
+    for (i = 0u; i < OS_EVENT_TBL_SIZE; i++) {
+        p_sem_data->OSEventTbl[i] = pevent->OSEventTbl[i];
+    }
+    p_sem_data->OSCnt = pevent->OSEventCnt;
+    OS_EXIT_CRITICAL();
+    return OS_ERR_NONE;
+}
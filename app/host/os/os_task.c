@@ -0,0 +1,160 @@
+/*
+ * Task management of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+INT8U OSTaskCreate(void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT8U prio)
+{
+    return OSTaskCreateExt(task, p_arg, ptos, prio, prio, NULL, 0u, NULL, OS_TASK_OPT_NONE);
+}
+
+INT8U OSTaskCreateExt(void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT8U prio,
+                      INT16U id, OS_STK *pbos, INT32U stk_size, void *pext, INT16U opt)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    INT8U      err;
+
+    if (prio > OS_LOWEST_PRIO) {
+        return OS_ERR_PRIO_INVALID;
+    }
+    /* The host switches onto the task's own stack, so it must know its extent */
+    if (pbos == NULL || stk_size == 0u) {
+        return OS_ERR_TASK_OPT;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (OSIntNesting > 0u) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_CREATE_ISR;
+    }
+    if (OSTCBPrioTbl[prio] != NULL) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_PRIO_EXIST;
+    }
+    OSTCBPrioTbl[prio] = OS_TCB_RESERVED;        /* Reserve the priority             */
+    OS_EXIT_CRITICAL();
+
+    OS_TaskStkClr(pbos, stk_size, opt);
+    err = OS_TCBInit(task, p_arg, prio, ptos, pbos, id, stk_size, pext, opt);
+    if (err == OS_ERR_NONE) {
+        if (OSRunning == OS_TRUE) {
+            OS_Sched();
+        }
+    } else {
+        OS_ENTER_CRITICAL();
+        OSTCBPrioTbl[prio] = NULL;
+        OS_EXIT_CRITICAL();
+    }
+    return err;
+}
+
+INT8U OSTaskDel(INT8U prio)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+    OS_EVENT  *pevent;
+    INT8U      y;
+
+    if (OSIntNesting > 0u) {
+        return OS_ERR_TASK_DEL_ISR;
+    }
+    if (prio == OS_TASK_IDLE_PRIO) {
+        return OS_ERR_TASK_DEL_IDLE;
+    }
+    if (prio >= OS_LOWEST_PRIO && prio != OS_PRIO_SELF) {
+        return OS_ERR_PRIO_INVALID;
+    }
+
+    OS_ENTER_CRITICAL();
+    if (prio == OS_PRIO_SELF) {
+        prio = OSTCBCur->OSTCBPrio;
+    }
+    ptcb = OSTCBPrioTbl[prio];
+    if (ptcb == NULL || ptcb == OS_TCB_RESERVED) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_NOT_EXIST;
+    }
+
+    y            = ptcb->OSTCBY;
+    OSRdyTbl[y] &= (INT8U)~ptcb->OSTCBBitX;
+    if (OSRdyTbl[y] == 0u) {
+        OSRdyGrp &= (INT8U)~ptcb->OSTCBBitY;
+    }
+    pevent = ptcb->OSTCBEventPtr;
+    if (pevent != NULL) {
+        OS_EventTaskRemove(ptcb, pevent);
+    }
+    if (ptcb->OSTCBFlagNode != NULL) {
+        OS_FlagUnlink(ptcb->OSTCBFlagNode);
+    }
+    ptcb->OSTCBDly      = 0u;
+    ptcb->OSTCBStat     = OS_STAT_RDY;
+    ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+
+    OSTaskDelHook(ptcb);
+    OS_TCBFree(ptcb);
+    OS_EXIT_CRITICAL();
+
+    if (OSRunning == OS_TRUE) {
+        OS_Sched();                              /* Does not return when deleting self */
+    }
+    return OS_ERR_NONE;
+}
+
+/*
+ * Counts the untouched (zero) entries from the bottom of the stack, which
+ * requires the task to have been created with OS_TASK_OPT_STK_CHK and its
+ * stack cleared.
+ */
+INT8U OSTaskStkChk(INT8U prio, OS_STK_DATA *p_stk_data)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+    OS_STK    *pchk;
+    INT32U     nfree;
+    INT32U     size;
+
+    if (prio > OS_LOWEST_PRIO && prio != OS_PRIO_SELF) {
+        return OS_ERR_PRIO_INVALID;
+    }
+    if (p_stk_data == NULL) {
+        return OS_ERR_PDATA_NULL;
+    }
+    p_stk_data->OSFree = 0u;
+    p_stk_data->OSUsed = 0u;
+
+    OS_ENTER_CRITICAL();
+    if (prio == OS_PRIO_SELF) {
+        prio = OSTCBCur->OSTCBPrio;
+    }
+    ptcb = OSTCBPrioTbl[prio];
+    if (ptcb == NULL || ptcb == OS_TCB_RESERVED) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_NOT_EXIST;
+    }
+    if ((ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) == 0u) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_OPT;
+    }
+    nfree = 0u;
+    size  = ptcb->OSTCBStkSize;
+    pchk  = ptcb->OSTCBStkBottom;
+    OS_EXIT_CRITICAL();
+
+    while (nfree < size && *pchk++ == (OS_STK)0) {
+        nfree++;
+    }
+    p_stk_data->OSFree = nfree * sizeof(OS_STK);
+    p_stk_data->OSUsed = (size - nfree) * sizeof(OS_STK);
+    return OS_ERR_NONE;
+}
+
+void OS_TaskStkClr(OS_STK *pbos, INT32U size, INT16U opt)
+{
+    if ((opt & OS_TASK_OPT_STK_CHK) != 0u && (opt & OS_TASK_OPT_STK_CLR) != 0u) {
+        while (size > 0u) {
+            size--;
+            *pbos++ = (OS_STK)0;
+        }
+    }
+}
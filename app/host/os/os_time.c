@@ -0,0 +1,142 @@
+/*
+ * Time management of the host uC/OS-II.
+ */
+#include "ucos_ii.h"
+
+void OSTimeDly(INT32U ticks)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT8U     y;
+
+    if (OSIntNesting > 0u || OSLockNesting > 0u) {
+        return;
+    }
+    if (ticks > 0u) {
+        OS_ENTER_CRITICAL();
+        y            = OSTCBCur->OSTCBY;
+        OSRdyTbl[y] &= (INT8U)~OSTCBCur->OSTCBBitX;
+        if (OSRdyTbl[y] == 0u) {
+            OSRdyGrp &= (INT8U)~OSTCBCur->OSTCBBitY;
+        }
+        OSTCBCur->OSTCBDly = ticks;
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+    }
+}
+
+INT8U OSTimeDlyHMSM(INT8U hours, INT8U minutes, INT8U seconds, INT16U ms)
+{
+    INT32U ticks;
+
+    if (OSIntNesting > 0u) {
+        return OS_ERR_TIME_DLY_ISR;
+    }
+    if (hours == 0u && minutes == 0u && seconds == 0u && ms == 0u) {
+        return OS_ERR_TIME_ZERO_DLY;
+    }
+    if (minutes > 59u) {
+        return OS_ERR_TIME_INVALID_MINUTES;
+    }
+    if (seconds > 59u) {
+        return OS_ERR_TIME_INVALID_SECONDS;
+    }
+    if (ms > 999u) {
+        return OS_ERR_TIME_INVALID_MS;
+    }
+
+    ticks = ((INT32U)hours * 3600uL + (INT32U)minutes * 60uL + (INT32U)seconds) * OS_TICKS_PER_SEC
+          + OS_TICKS_PER_SEC * ((INT32U)ms + 500uL / OS_TICKS_PER_SEC) / 1000uL;
+    OSTimeDly(ticks);
+    return OS_ERR_NONE;
+}
+
+INT32U OSTimeGet(void)
+{
+    OS_CPU_SR cpu_sr = 0u;
+    INT32U    ticks;
+
+    OS_ENTER_CRITICAL();
+    ticks = OSTime;
+    OS_EXIT_CRITICAL();
+    return ticks;
+}
+
+void OSTimeSet(INT32U ticks)
+{
+    OS_CPU_SR cpu_sr = 0u;
+
+    OS_ENTER_CRITICAL();
+    OSTime = ticks;
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Tick ISR body: must be called between OSIntEnter() and OSIntExit().
+ */
+void OSTimeTick(void)
+{
+    OS_TimeTickN(1u);
+}
+
+/*
+ * Accounts for several ticks in one timer interrupt, as a tickless idle
+ * does after skipping the ticks nobody was waiting for: every delay is
+ * shortened by the whole amount in a single pass over the tasks.
+ */
+void OS_TimeTickN(INT32U ticks)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+
+    OSTimeTickHook();
+
+    OS_ENTER_CRITICAL();
+    OSTime += ticks;
+    OS_EXIT_CRITICAL();
+
+    if (OSRunning == OS_TRUE) {
+        ptcb = OSTCBList;
+        while (ptcb != NULL && ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {
+            OS_ENTER_CRITICAL();
+            if (ptcb->OSTCBDly != 0u) {
+                if (ptcb->OSTCBDly > ticks) {
+                    ptcb->OSTCBDly -= ticks;
+                } else {
+                    ptcb->OSTCBDly = 0u;
+                    if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+                        ptcb->OSTCBStat     &= (INT8U)~OS_STAT_PEND_ANY;
+                        ptcb->OSTCBStatPend  = OS_STAT_PEND_TO;
+                    } else {
+                        ptcb->OSTCBStatPend  = OS_STAT_PEND_OK;
+                    }
+                    if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {
+                        OSRdyGrp               |= ptcb->OSTCBBitY;
+                        OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+                    }
+                }
+            }
+            ptcb = ptcb->OSTCBNext;
+            OS_EXIT_CRITICAL();
+        }
+    }
+}
+
+/*
+ * Ticks until the earliest delay or pend timeout runs out, 0 when no task
+ * is waiting for time.
+ */
+INT32U OS_TimeNextDly(void)
+{
+    OS_CPU_SR  cpu_sr = 0u;
+    OS_TCB    *ptcb;
+    INT32U     ticks = 0u;
+
+    OS_ENTER_CRITICAL();
+    for (ptcb = OSTCBList; ptcb != NULL; ptcb = ptcb->OSTCBNext) {
+        if (ptcb->OSTCBDly != 0u && (ticks == 0u || ptcb->OSTCBDly < ticks)) {
+            ticks = ptcb->OSTCBDly;
+        }
+    }
+    OS_EXIT_CRITICAL();
+    return ticks;
+}
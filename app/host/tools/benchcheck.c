@@ -0,0 +1,471 @@
+/*
+ * Runs the benchmark build of the lab programs several times, collects the
+ * "benchmark: " lines of lib/BenchmarkMetric and the wall-clock time of
+ * every run, and compares the means against a baseline file.
+ *
+ * usage: benchcheck [-n runs] [-t tolerance %] [-u] baseline program...
+ *
+ * Every metric is wall-clock time or a rate over it, so they all follow
+ * the speed of the machine, which on a shared or throttled host drifts by
+ * more than the tolerance between a baseline and a later run. Before each
+ * program run benchcheck times a fixed reference loop, kept as the
+ * benchcheck/reference metric, and compares every metric scaled by the
+ * reference of the baseline over the reference of this run. The loop is
+ * timed in short chunks and the median chunk taken, so like the
+ * latencies the programs measure it follows the speed of the core. It
+ * does not make up for other processes taking a share of the core, the
+ * benchmark wants an otherwise idle machine.
+ *
+ * A metric regresses when it is worse than the baseline by more than the
+ * tolerance and the difference is significant: Welch's t-test over the
+ * runs of both sides, one-sided, at 99% for the whole set of metrics
+ * together. With well over a hundred metrics, 99% per metric would flag
+ * one by chance in most runs, so each is tested at 1% divided by their
+ * number (Bonferroni). Metrics printed as informational are compared but
+ * never regress, and do not count towards that number. Exits with 1 when any metric regressed
+ * or a program failed. With -u the baseline is rewritten from this run
+ * instead. The reference scaling lets a baseline recorded on one machine
+ * gate runs on another; a baseline of the machine itself is still the
+ * closer comparison.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define PREFIX          "benchmark: "
+#define MAX_METRICS     1024
+#define MAX_RUNS        32
+#define NAME_SIZE       128
+#define UNIT_SIZE       16
+
+#define REFERENCE_NAME  "benchcheck/reference"
+#define REFERENCE_STEPS 40000       // per chunk, about 100 us
+#define REFERENCE_CHUNKS 101
+
+typedef struct {
+    char name[NAME_SIZE];
+    char unit[UNIT_SIZE];
+    int higherIsBetter;
+    int informational;
+    int count;
+    double samples[MAX_RUNS];
+    double mean;
+    double stddev;
+} Metric;
+
+static Metric metrics[MAX_METRICS];
+static int metricCount;
+static Metric baselines[MAX_METRICS];
+static int baselineCount;
+static volatile unsigned referenceSink;
+
+static Metric* findMetric(Metric* list, int count, const char* name)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        if (strcmp(list[i].name, name) == 0)
+            return &list[i];
+    return NULL;
+}
+
+static void addSample(const char* name, double value, const char* unit, int higherIsBetter, int informational)
+{
+    Metric* metric = findMetric(metrics, metricCount, name);
+
+    if (metric == NULL) {
+        if (metricCount == MAX_METRICS)
+            return;
+        metric = &metrics[metricCount++];
+        snprintf(metric->name, sizeof(metric->name), "%s", name);
+        snprintf(metric->unit, sizeof(metric->unit), "%s", unit);
+        metric->higherIsBetter = higherIsBetter;
+        metric->informational = informational;
+    }
+    if (metric->count < MAX_RUNS)
+        metric->samples[metric->count++] = value;
+}
+
+static void summarize(Metric* metric)
+{
+    double sum = 0;
+    double squares = 0;
+    int i;
+
+    for (i = 0; i < metric->count; i++)
+        sum += metric->samples[i];
+    metric->mean = metric->count > 0 ? sum / metric->count : 0;
+    for (i = 0; i < metric->count; i++)
+        squares += (metric->samples[i] - metric->mean) * (metric->samples[i] - metric->mean);
+    metric->stddev = metric->count > 1 ? sqrt(squares / (metric->count - 1)) : 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Times a chunk of the reference loop in microseconds, the median of
+ * REFERENCE_CHUNKS: random increments over a buffer larger than the
+ * first-level caches, so memory as well as the core counts, like in the
+ * programs
+ */
+static double referenceTime(void)
+{
+    static unsigned char buffer[1 << 20];
+    double chunks[REFERENCE_CHUNKS];
+    double start;
+    unsigned state = 1;
+    unsigned sum = 0;
+    int chunk;
+    long i;
+
+    for (chunk = 0; chunk < REFERENCE_CHUNKS; chunk++) {
+        start = now();
+        for (i = 0; i < REFERENCE_STEPS; i++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            sum += buffer[state & (sizeof(buffer) - 1)]++;
+        }
+        chunks[chunk] = (now() - start) * 1e6;
+    }
+    referenceSink = sum;
+    qsort(chunks, REFERENCE_CHUNKS, sizeof(chunks[0]), compareDoubles);
+    return chunks[REFERENCE_CHUNKS / 2];
+}
+
+/* Runs the program once and collects its metrics, returns 0 when it failed */
+static int runProgram(const char* path)
+{
+    const char* program = strrchr(path, '/') != NULL ? strrchr(path, '/') + 1 : path;
+    char line[4096];
+    char name[NAME_SIZE];
+    char metricName[64];
+    char unit[UNIT_SIZE];
+    char direction[8];
+    char flag[8];
+    double value;
+    double start;
+    FILE* output;
+    int status;
+    int fields;
+
+    addSample(REFERENCE_NAME, referenceTime(), "us", 0, 1);
+
+    start = now();
+    if ((output = popen(path, "r")) == NULL) {
+        perror(path);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), output) != NULL) {
+        const char* text = strstr(line, PREFIX);
+
+        if (text == NULL)
+            continue;
+        fields = sscanf(text + strlen(PREFIX), "%63s %lf %15s %7s %7s", metricName, &value, unit, direction, flag);
+        if (fields < 4)
+            continue;
+        snprintf(name, sizeof(name), "%s/%s", program, metricName);
+        addSample(name, value, unit, strcmp(direction, "higher") == 0, fields == 5 && strcmp(flag, "info") == 0);
+    }
+    status = pclose(output);
+    if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s failed (status %d)\n", path, status);
+        return 0;
+    }
+
+    // includes starting the process and printing, informational only
+    snprintf(name, sizeof(name), "%s/runtime", program);
+    addSample(name, (now() - start) * 1e3, "ms", 0, 1);
+    return 1;
+}
+
+static int readBaseline(const char* path)
+{
+    FILE* input = fopen(path, "r");
+    char line[512];
+    char direction[8];
+    Metric* metric;
+
+    if (input == NULL)
+        return 0;
+    while (fgets(line, sizeof(line), input) != NULL && baselineCount < MAX_METRICS) {
+        if (line[0] == '#')
+            continue;
+        metric = &baselines[baselineCount];
+        if (sscanf(line, "%127s %15s %7s %lf %lf %d", metric->name, metric->unit, direction,
+                    &metric->mean, &metric->stddev, &metric->count) != 6)
+            continue;
+        metric->higherIsBetter = strcmp(direction, "higher") == 0;
+        baselineCount++;
+    }
+    fclose(input);
+    return 1;
+}
+
+static int writeBaseline(const char* path, int runs)
+{
+    FILE* output = fopen(path, "w");
+    int i;
+
+    if (output == NULL) {
+        perror(path);
+        return 0;
+    }
+    fprintf(output, "# Host regression benchmark baseline, %d runs per program (make benchmark-baseline)\n", runs);
+    fprintf(output, "# metric  unit  better  mean  stddev  runs\n");
+    for (i = 0; i < metricCount; i++)
+        fprintf(output, "%s %s %s %.6g %.6g %d\n", metrics[i].name, metrics[i].unit,
+                metrics[i].higherIsBetter ? "higher" : "lower",
+                metrics[i].mean, metrics[i].stddev, metrics[i].count);
+    fclose(output);
+    return 1;
+}
+
+/* Continued fraction of the incomplete beta function, by the modified Lentz method */
+static double betaFraction(double a, double b, double x)
+{
+    const double tiny = 1e-30;
+    double c = 1;
+    double d = 1 - (a + b) * x / (a + 1);
+    double h;
+    double term;
+    double delta;
+    int m;
+
+    d = 1 / (fabs(d) < tiny ? tiny : d);
+    h = d;
+    for (m = 1; m <= 200; m++) {
+        term = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+        d = 1 + term * d;
+        d = 1 / (fabs(d) < tiny ? tiny : d);
+        c = 1 + term / c;
+        c = fabs(c) < tiny ? tiny : c;
+        h *= d * c;
+
+        term = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+        d = 1 + term * d;
+        d = 1 / (fabs(d) < tiny ? tiny : d);
+        c = 1 + term / c;
+        c = fabs(c) < tiny ? tiny : c;
+        delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1) < 1e-12)
+            break;
+    }
+    return h;
+}
+
+/* Regularized incomplete beta function I_x(a, b) */
+static double incompleteBeta(double a, double b, double x)
+{
+    double front;
+
+    if (x <= 0)
+        return 0;
+    if (x >= 1)
+        return 1;
+    front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x));
+    if (x < (a + 1) / (a + b + 2))
+        return front * betaFraction(a, b, x) / a;
+    return 1 - front * betaFraction(b, a, 1 - x) / b;
+}
+
+/* Probability of Student's t with df degrees of freedom being t or more */
+static double upperTail(double t, double df)
+{
+    double half = 0.5 * incompleteBeta(df / 2, 0.5, df / (df + t * t));
+
+    return t > 0 ? half : 1 - half;
+}
+
+/*
+ * Welch's t of the change from the baseline towards worse, positive when
+ * the current runs are worse, and its degrees of freedom
+ */
+static double welch(const Metric* base, const Metric* current, double* df)
+{
+    double baseVariance = base->stddev * base->stddev / (base->count > 0 ? base->count : 1);
+    double currentVariance = current->stddev * current->stddev / current->count;
+    double error = sqrt(baseVariance + currentVariance);
+    double difference = current->mean - base->mean;
+    double t;
+
+    if (current->higherIsBetter)
+        difference = -difference;
+
+    // no spread on either side: any difference counts
+    *df = 1;
+    if (error == 0)
+        return difference > 0 ? INFINITY : difference < 0 ? -INFINITY : 0;
+
+    t = difference / error;
+    *df = (baseVariance + currentVariance) * (baseVariance + currentVariance) /
+         ((base->count > 1 ? baseVariance * baseVariance / (base->count - 1) : 0) +
+          (current->count > 1 ? currentVariance * currentVariance / (current->count - 1) : 0));
+    if (*df < 1)
+        *df = 1;
+    return t;
+}
+
+/*
+ * Copies the metric with its samples as if taken on the machine of the
+ * baseline: times multiplied by speed, the baseline over this run's
+ * reference time, and rates divided by it
+ */
+static void normalize(Metric* normalized, const Metric* metric, double speed)
+{
+    int i;
+
+    *normalized = *metric;
+    if (strcmp(metric->name, REFERENCE_NAME) == 0)
+        return;
+    for (i = 0; i < metric->count; i++)
+        normalized->samples[i] = metric->higherIsBetter ? metric->samples[i] / speed : metric->samples[i] * speed;
+    summarize(normalized);
+}
+
+static int compare(double tolerance)
+{
+    const Metric* base;
+    const Metric* reference;
+    const Metric* baseReference;
+    Metric normalized;
+    const Metric* current = &normalized;
+    const char* verdict;
+    double speed = 1;
+    double significance;
+    double change;
+    double df;
+    double t;
+    int gated = 0;
+    int regressions = 0;
+    int improvements = 0;
+    int informational = 0;
+    int i;
+
+    reference = findMetric(metrics, metricCount, REFERENCE_NAME);
+    baseReference = findMetric(baselines, baselineCount, REFERENCE_NAME);
+    if (reference != NULL && baseReference != NULL && reference->mean > 0 && baseReference->mean > 0) {
+        speed = baseReference->mean / reference->mean;
+        printf("reference loop %.3g us, baseline %.3g us: metrics scaled to the baseline's machine speed (x%.3f)\n\n",
+                reference->mean, baseReference->mean, speed);
+    } else {
+        printf("no reference loop in the baseline: metrics compared unscaled, rerun make benchmark-baseline\n\n");
+    }
+
+    for (i = 0; i < metricCount; i++)
+        if (!metrics[i].informational && findMetric(baselines, baselineCount, metrics[i].name) != NULL)
+            gated++;
+    significance = 0.01 / (gated > 0 ? gated : 1);
+
+    printf("%-48s %14s %14s %8s %7s  %s\n", "metric", "baseline", "now", "change", "t", "verdict");
+    for (i = 0; i < metricCount; i++) {
+        normalize(&normalized, &metrics[i], speed);
+        if (current->informational)
+            informational++;
+        base = findMetric(baselines, baselineCount, current->name);
+        if (base == NULL) {
+            printf("%-48s %14s %14.6g %8s %7s  new\n", current->name, "-", current->mean, "", "");
+            continue;
+        }
+
+        change = base->mean != 0 ? 100.0 * (current->mean - base->mean) / fabs(base->mean) : 0;
+        t = welch(base, current, &df);
+        verdict = "ok";
+        if (current->informational) {
+            verdict = "info";
+        } else if (upperTail(t, df) < significance && fabs(change) > tolerance) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (upperTail(-t, df) < significance && fabs(change) > tolerance) {
+            verdict = "improved";
+            improvements++;
+        }
+        printf("%-48s %14.6g %14.6g %+7.1f%% %7.2f  %s\n", current->name, base->mean, current->mean,
+                change, t, verdict);
+    }
+    for (i = 0; i < baselineCount; i++)
+        if (findMetric(metrics, metricCount, baselines[i].name) == NULL)
+            printf("%-48s %14.6g %14s %8s %7s  missing\n", baselines[i].name, baselines[i].mean, "-", "", "");
+
+    printf("%d metrics, %d informational, %d regressed, %d improved beyond %.0f%% at 99%% confidence over %d\n",
+            metricCount, informational, regressions, improvements, tolerance, gated);
+    return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* baseline;
+    double tolerance = 25;
+    int runs = 5;
+    int update = 0;
+    int failures = 0;
+    int option;
+    int run;
+    int i;
+
+    while ((option = getopt(argc, argv, "n:t:u")) != -1) {
+        switch (option) {
+        case 'n':
+            runs = atoi(optarg);
+            break;
+        case 't':
+            tolerance = atof(optarg);
+            break;
+        case 'u':
+            update = 1;
+            break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind + 2 > argc || runs < 2 || runs > MAX_RUNS) {
+        fprintf(stderr, "usage: %s [-n runs (2..%d)] [-t tolerance %%] [-u] baseline program...\n", argv[0], MAX_RUNS);
+        return 2;
+    }
+    baseline = argv[optind++];
+
+    // runs interleaved, so a slow spell of the machine hits every program alike
+    for (run = 0; run < runs; run++) {
+        fprintf(stderr, "run %d of %d\n", run + 1, runs);
+        for (i = optind; i < argc; i++)
+            if (!runProgram(argv[i]))
+                failures++;
+    }
+    for (i = 0; i < metricCount; i++)
+        summarize(&metrics[i]);
+
+    if (update) {
+        if (!writeBaseline(baseline, runs))
+            return 1;
+        printf("%d metrics written to %s\n", metricCount, baseline);
+        return failures > 0;
+    }
+
+    if (!readBaseline(baseline)) {
+        fprintf(stderr, "no baseline at %s, run make benchmark-baseline first\n", baseline);
+        return 1;
+    }
+    if (compare(tolerance) > 0 || failures > 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ * Converts the scheduler trace dumped by lib/TraceRecorder into Chrome trace
+ * event JSON, which chrome://tracing and ui.perfetto.dev open as one
+ * timeline per task: running intervals, blocking intervals named after the
+ * object waited for, posts and ticks. A summary of the CPU share, the
+ * activations and the blocked time of every task goes to stderr.
+ *
+ * usage: traceconvert [console log] > trace.json
+ *
+ * The log is read from stdin when no file is given; only the lines with
+ * the "trace: " prefix are used, so the whole console output of a program
+ * can be passed in, e.g. ./bin/TwoTasks | ./bin/traceconvert > trace.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PREFIX          "trace: "
+#define MAX_PRIORITIES  256
+#define MAX_OBJECTS     65536
+#define TICKS_TID       1000
+
+/* Keep in step with lib/TraceRecorder.h */
+enum {
+    EVENT_SWITCH,
+    EVENT_TICK,
+    EVENT_POST,
+    EVENT_PEND,
+    EVENT_PEND_DONE,
+    EVENT_PEND_TIMEOUT,
+    EVENT_MARK
+};
+
+typedef struct {
+    char* name;
+    int seen;
+    double runningUs;
+    double blockedUs;
+    unsigned long activations;
+    double runStart;            // -1 while not running
+    double pendStart;           // -1 while not in a pend
+    unsigned int pendObject;
+    int blocked;                // switched out during the current pend
+    double blockStart;          // switched out
+    double blockEnd;            // switched back in
+} Task;
+
+static Task tasks[MAX_PRIORITIES];
+static char* objectNames[MAX_OBJECTS];
+static double frequency;
+static int running = -1;
+static int firstEvent = 1;
+static int records;
+static unsigned long long now;      // unwrapped timestamp
+static unsigned long lastRaw;
+static unsigned long long origin;
+
+static char* copyName(const char* text)
+{
+    size_t length = strcspn(text, "\r\n");
+    char* name = malloc(length + 1);
+
+    memcpy(name, text, length);
+    name[length] = '\0';
+    return name;
+}
+
+static const char* taskName(int priority)
+{
+    static char buffer[16];
+
+    if (tasks[priority].name != NULL)
+        return tasks[priority].name;
+    snprintf(buffer, sizeof(buffer), "task %d", priority);
+    return buffer;
+}
+
+static const char* objectName(unsigned int object)
+{
+    static char buffer[16];
+
+    if (objectNames[object] != NULL)
+        return objectNames[object];
+    snprintf(buffer, sizeof(buffer), "object %04x", object);
+    return buffer;
+}
+
+static double toUs(unsigned long long timestamp)
+{
+    return (double)(timestamp - origin) * 1e6 / frequency;
+}
+
+static void separator(void)
+{
+    if (!firstEvent)
+        printf(",\n");
+    firstEvent = 0;
+}
+
+static void complete(int priority, const char* category, const char* name, double start, double end)
+{
+    separator();
+    printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            name, category, priority, start, end - start);
+}
+
+static void instant(int tid, const char* category, const char* name, double at)
+{
+    separator();
+    printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+            name, category, tid, at);
+}
+
+static void startRunning(int priority, double at)
+{
+    running = priority;
+    if (tasks[priority].blocked)
+        tasks[priority].blockEnd = at;
+    tasks[priority].seen = 1;
+    tasks[priority].runStart = at;
+    tasks[priority].activations++;
+}
+
+static void stopRunning(double at)
+{
+    Task* task;
+
+    if (running < 0)
+        return;
+    task = &tasks[running];
+    if (task->runStart >= 0) {
+        complete(running, "run", "running", task->runStart, at);
+        task->runningUs += at - task->runStart;
+    }
+    task->runStart = -1;
+    if (task->pendStart >= 0 && !task->blocked) {
+        task->blocked = 1;
+        task->blockStart = at;
+        task->blockEnd = at;
+    }
+    running = -1;
+}
+
+static void handleRecord(const char* hex)
+{
+    char field[9];
+    unsigned long raw;
+    unsigned int event;
+    unsigned int priority;
+    unsigned int argument;
+    char name[64];
+    Task* task;
+    double at;
+
+    memcpy(field, hex, 8);
+    field[8] = '\0';
+    raw = strtoul(field, NULL, 16);
+    memcpy(field, hex + 8, 2);
+    field[2] = '\0';
+    event = strtoul(field, NULL, 16);
+    memcpy(field, hex + 10, 2);
+    priority = strtoul(field, NULL, 16);
+    memcpy(field, hex + 12, 4);
+    field[4] = '\0';
+    argument = strtoul(field, NULL, 16);
+
+    // 32 bit timestamps, unwrapped on the assumption that no gap is longer
+    if (records++ == 0)
+        now = origin = raw;
+    else
+        now += (unsigned long)((raw - lastRaw) & 0xffffffffUL);
+    lastRaw = raw;
+    at = toUs(now);
+
+    if (running < 0 && event != EVENT_SWITCH)
+        startRunning(priority, at);
+
+    task = &tasks[priority];
+    switch (event) {
+    case EVENT_SWITCH:
+        stopRunning(at);
+        startRunning(priority, at);
+        break;
+
+    case EVENT_TICK:
+        instant(TICKS_TID, "tick", "tick", at);
+        break;
+
+    case EVENT_POST:
+        snprintf(name, sizeof(name), "post %s", objectName(argument));
+        instant(priority, "post", name, at);
+        break;
+
+    case EVENT_PEND:
+        task->pendStart = at;
+        task->pendObject = argument;
+        task->blocked = 0;
+        break;
+
+    case EVENT_PEND_DONE:
+    case EVENT_PEND_TIMEOUT:
+        if (task->pendStart >= 0 && task->blocked) {
+            snprintf(name, sizeof(name), "%s %s", event == EVENT_PEND_DONE ? "blocked on" : "timed out on",
+                    objectName(task->pendObject));
+            // from the switch out to the switch back in, between the running intervals
+            complete(priority, "block", name, task->blockStart, task->blockEnd);
+            task->blocked = 0;
+            task->blockedUs += task->blockEnd - task->blockStart;
+        }
+        task->pendStart = -1;
+        break;
+
+    case EVENT_MARK:
+        snprintf(name, sizeof(name), "mark %u", argument);
+        instant(priority, "mark", name, at);
+        break;
+    }
+}
+
+static void handleLine(const char* line)
+{
+    const char* text = strstr(line, PREFIX);
+    unsigned int id;
+    int offset;
+
+    if (text == NULL)
+        return;
+    text += strlen(PREFIX);
+
+    if (sscanf(text, "begin %lf", &frequency) == 1) {
+        printf("{\"traceEvents\":[\n");
+        return;
+    }
+    if (strncmp(text, "overhead ", 9) == 0) {
+        unsigned long long mean, max;
+
+        if (sscanf(text + 9, "%llu %llu", &mean, &max) == 2 && frequency > 0)
+            fprintf(stderr, "recording cost per event: mean %.0f ns, max %.0f ns\n",
+                    mean * 1e9 / frequency, max * 1e9 / frequency);
+        return;
+    }
+    if (sscanf(text, "task %u %n", &id, &offset) == 1 && id < MAX_PRIORITIES) {
+        tasks[id].name = copyName(text + offset);
+        return;
+    }
+    if (sscanf(text, "object %u %n", &id, &offset) == 1 && id < MAX_OBJECTS) {
+        objectNames[id] = copyName(text + offset);
+        return;
+    }
+    if (strncmp(text, "end", 3) == 0)
+        return;
+
+    // records: 16 hex digits each, separated by spaces
+    while (strspn(text, "0123456789abcdef") >= 16) {
+        handleRecord(text);
+        text += 16;
+        text += strspn(text, " ");
+    }
+}
+
+static void finish(void)
+{
+    double total;
+    int priority;
+
+    stopRunning(toUs(now));
+    total = toUs(now);
+
+    separator();
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"ticks\"}}", TICKS_TID);
+    for (priority = 0; priority < MAX_PRIORITIES; priority++) {
+        if (!tasks[priority].seen && tasks[priority].name == NULL)
+            continue;
+        separator();
+        printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s (%d)\"}}",
+                priority, taskName(priority), priority);
+        separator();
+        printf("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+                priority, priority);
+    }
+    printf("\n]}\n");
+
+    fprintf(stderr, "%d records over %.1f us\n", records, total);
+    fprintf(stderr, "task                  prio   cpu %%  activations  blocked (us)\n");
+    for (priority = 0; priority < MAX_PRIORITIES; priority++) {
+        if (!tasks[priority].seen)
+            continue;
+        fprintf(stderr, "%-20s %5d  %6.2f  %11lu  %12.1f\n", taskName(priority), priority,
+                total > 0 ? 100.0 * tasks[priority].runningUs / total : 0.0,
+                tasks[priority].activations, tasks[priority].blockedUs);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* input = stdin;
+    char line[4096];
+    int priority;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [console log] > trace.json\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && (input = fopen(argv[1], "r")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    for (priority = 0; priority < MAX_PRIORITIES; priority++) {
+        tasks[priority].runStart = -1;
+        tasks[priority].pendStart = -1;
+    }
+
+    while (fgets(line, sizeof(line), input) != NULL)
+        handleLine(line);
+
+    if (frequency <= 0) {
+        fprintf(stderr, "no trace found in the input\n");
+        return 1;
+    }
+    finish();
+    return 0;
+}
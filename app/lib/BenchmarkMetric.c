@@ -0,0 +1,32 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "BenchmarkMetric.h"
+
+void benchmarkMetric(double value, const char* unit, BenchmarkDirection direction, const char* format, ...)
+{
+    char name[64];
+    va_list arguments;
+    int i;
+
+    va_start(arguments, format);
+    vsnprintf(name, sizeof(name), format, arguments);
+    va_end(arguments);
+
+    for (i = 0; name[i] != '\0'; i++)
+        if (name[i] == ' ')
+            name[i] = '-';
+
+    printf(BENCHMARK_PREFIX "%s %.6g %s %s%s\n", name, value, unit,
+            direction & BENCHMARK_HIGHER_IS_BETTER ? "higher" : "lower",
+            direction & BENCHMARK_INFORMATIONAL ? " info" : "");
+}
+
+void benchmarkEnd(void)
+{
+#ifdef __nios2__
+    // end of transmission, makes nios2-terminal quit
+    putchar('\004');
+#endif
+    fflush(stdout);
+}
@@ -0,0 +1,43 @@
+#ifndef BENCHMARK_METRIC_H
+#define BENCHMARK_METRIC_H
+
+/*
+ * Machine-readable results for the host regression benchmark.
+ *
+ * Builds with -DBENCHMARK print every BENCHMARK_METRIC() as one line
+ *
+ *     benchmark: <name> <value> <unit> <lower|higher>[ info]
+ *
+ * next to the program's own table, for host/tools/benchcheck to collect
+ * and compare against host/benchmarks/baseline.txt or a baseline recorded
+ * on the machine (see "make benchmark" in host/Makefile). The name is
+ * built from a printf format; spaces in it become dashes. A direction
+ * or'ed with BENCHMARK_INFORMATIONAL marks a metric too noisy to gate on:
+ * it is compared and printed, but never counts as a regression.
+ * BENCHMARK_END() ends the output of a board run with ^D, which quits
+ * "nios2-terminal -q" (see "make placement-compare" in ProjectMakefile);
+ * on the host it prints nothing. Without BENCHMARK the macros compile to
+ * nothing.
+ */
+
+#define BENCHMARK_PREFIX    "benchmark: "
+
+typedef enum {
+    BENCHMARK_LOWER_IS_BETTER,
+    BENCHMARK_HIGHER_IS_BETTER,
+    BENCHMARK_INFORMATIONAL = 2     // flag, or'ed with one of the above
+} BenchmarkDirection;
+
+#ifdef BENCHMARK
+#define BENCHMARK_METRIC(value, unit, direction, ...)   benchmarkMetric((value), (unit), (direction), __VA_ARGS__)
+#define BENCHMARK_END()                                 benchmarkEnd()
+#else
+#define BENCHMARK_METRIC(value, unit, direction, ...)
+#define BENCHMARK_END()
+#endif
+
+void benchmarkMetric(double value, const char* unit, BenchmarkDirection direction, const char* format, ...);
+
+void benchmarkEnd(void);
+
+#endif /* BENCHMARK_METRIC_H */
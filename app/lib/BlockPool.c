@@ -0,0 +1,114 @@
+#include <stdio.h>
+
+#include "BlockPool.h"
+
+// alt_u64 storage keeps every block aligned for pointers and 64-bit fields
+#define BLOCK_POOL_STORAGE(blockSize, blocks) \
+    static alt_u64 blockPoolStorage##blockSize[(blockSize) / 8 * (blocks)];
+BLOCK_POOL_CLASSES(BLOCK_POOL_STORAGE)
+
+#define BLOCK_POOL_CLASS(blockSize, blocks) \
+    { NULL, (alt_u8*)blockPoolStorage##blockSize, (alt_u8*)blockPoolStorage##blockSize + (blockSize) * (blocks), \
+      (blockSize), (blocks), 0, 0, 0 },
+static BlockPoolClass blockPoolClasses[] = {
+    BLOCK_POOL_CLASSES(BLOCK_POOL_CLASS)
+};
+
+#define BLOCK_POOL_CLASS_COUNT  (sizeof(blockPoolClasses) / sizeof(blockPoolClasses[0]))
+
+int blockPoolInit(void)
+{
+    BlockPoolClass* class;
+    INT8U err;
+    alt_u32 i;
+
+    for (i = 0; i < BLOCK_POOL_CLASS_COUNT; i++) {
+        class = &blockPoolClasses[i];
+        class->partition = OSMemCreate(class->start, class->blocks, class->blockSize, &err);
+        if (class->partition == NULL) {
+            printf("blockPoolInit: cannot create the %lu byte partition (error %u)\n",
+                    (unsigned long)class->blockSize, err);
+            return 0;
+        }
+        class->inUse     = 0;
+        class->highWater = 0;
+        class->failures  = 0;
+    }
+    return 1;
+}
+
+static BlockPoolClass* blockPoolFindClass(alt_u32 size)
+{
+    alt_u32 i;
+
+    for (i = 0; i < BLOCK_POOL_CLASS_COUNT; i++)
+        if (size <= blockPoolClasses[i].blockSize)
+            return &blockPoolClasses[i];
+    return NULL;
+}
+
+void* blockPoolGet(alt_u32 size)
+{
+    OS_CPU_SR cpu_sr = 0;
+    BlockPoolClass* class;
+    void* block;
+    INT8U err;
+
+    class = blockPoolFindClass(size);
+    if (class == NULL || class->partition == NULL)
+        return NULL;
+
+    block = OSMemGet(class->partition, &err);
+
+    OS_ENTER_CRITICAL();
+    if (block != NULL) {
+        class->inUse++;
+        if (class->inUse > class->highWater)
+            class->highWater = class->inUse;
+    } else {
+        class->failures++;
+    }
+    OS_EXIT_CRITICAL();
+    return block;
+}
+
+void blockPoolPut(void* block)
+{
+    OS_CPU_SR cpu_sr = 0;
+    BlockPoolClass* class;
+    alt_u32 i;
+
+    if (block == NULL)
+        return;
+
+    for (i = 0; i < BLOCK_POOL_CLASS_COUNT; i++) {
+        class = &blockPoolClasses[i];
+        if ((alt_u8*)block >= class->start && (alt_u8*)block < class->end) {
+            OSMemPut(class->partition, block);
+            OS_ENTER_CRITICAL();
+            class->inUse--;
+            OS_EXIT_CRITICAL();
+            return;
+        }
+    }
+}
+
+const BlockPoolClass* blockPoolClass(alt_u32 size)
+{
+    return blockPoolFindClass(size);
+}
+
+void blockPoolPrintStatistics(void)
+{
+    const BlockPoolClass* class;
+    alt_u32 i;
+
+    printf("block size  blocks  in use  high-water  failures\n");
+    for (i = 0; i < BLOCK_POOL_CLASS_COUNT; i++) {
+        class = &blockPoolClasses[i];
+        printf("%10lu  %6lu  %6lu  %10lu  %8lu\n",
+                (unsigned long)class->blockSize, (unsigned long)class->blocks,
+                (unsigned long)class->inUse, (unsigned long)class->highWater,
+                (unsigned long)class->failures);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Fixed-block allocator over uC/OS-II memory partitions.
+ *
+ * Every size class is one OS_MEM partition carved out of static storage,
+ * so a get or put is a free-list pop or push with a bounded, data
+ * independent cost and the heap is never touched. A request is served by
+ * the smallest class whose blocks are large enough; when that class is
+ * exhausted the request fails (and is counted) rather than spilling into a
+ * larger class, keeping the classes independent of each other.
+ *
+ * The classes are listed as X(blockSize, blocks) entries and can be
+ * replaced by defining BLOCK_POOL_CLASSES before including this header in
+ * every file that uses it, e.g. with -D. Block sizes must be multiples of 8
+ * in increasing order, and each class needs at least 2 blocks.
+ */
+
+#ifndef BLOCK_POOL_CLASSES
+#define BLOCK_POOL_CLASSES(X)   \
+    X(16,   32)                 \
+    X(64,   32)                 \
+    X(256,  16)                 \
+    X(1024,  8)                 \
+    X(4096,  4)
+#endif
+
+typedef struct {
+    OS_MEM* partition;
+    alt_u8* start;              // address range of the class, used by blockPoolPut
+    alt_u8* end;
+    alt_u32 blockSize;
+    alt_u32 blocks;
+    alt_u32 inUse;
+    alt_u32 highWater;          // most blocks ever in use at once
+    alt_u32 failures;           // gets refused because the class was empty
+} BlockPoolClass;
+
+/* Creates one partition per class; returns 0 when the OS has too few partitions */
+int   blockPoolInit(void);
+
+/* Returns a block of at least size bytes, or NULL */
+void* blockPoolGet(alt_u32 size);
+
+/* Returns a block obtained from blockPoolGet; NULL is ignored */
+void  blockPoolPut(void* block);
+
+/* Typed allocation: Foo* foo = blockPoolNew(Foo); */
+#define blockPoolNew(type)              ((type*)blockPoolGet(sizeof(type)))
+#define blockPoolNewArray(type, count)  ((type*)blockPoolGet(sizeof(type) * (count)))
+
+/* Counters of the class serving the given size, NULL if no class is large enough */
+const BlockPoolClass* blockPoolClass(alt_u32 size);
+
+/* Prints block size, blocks, in use, high-water and failures of every class */
+void  blockPoolPrintStatistics(void);
+
+#endif /* BLOCK_POOL_H */
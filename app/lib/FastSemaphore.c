@@ -0,0 +1,68 @@
+#include "FastSemaphore.h"
+
+/* Adds delta to the count in one atomic step and returns the old count */
+#ifdef __nios2__
+
+// no atomic instructions, so interrupts are masked around the update
+static alt_32 fastSemAdd(volatile alt_32* count, alt_32 delta)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_32 old;
+
+    OS_ENTER_CRITICAL();
+    old = *count;
+    *count = old + delta;
+    OS_EXIT_CRITICAL();
+    return old;
+}
+
+#else
+
+#define fastSemAdd(count, delta)    __atomic_fetch_add((count), (delta), __ATOMIC_ACQ_REL)
+
+#endif
+
+int fastSemInit(FastSemaphore* semaphore, alt_u16 count)
+{
+    semaphore->count = count;
+    semaphore->event = OSSemCreate(0);
+    return semaphore->event != NULL;
+}
+
+void fastSemDelete(FastSemaphore* semaphore)
+{
+    INT8U err;
+
+    OSSemDel(semaphore->event, OS_DEL_ALWAYS, &err);
+    semaphore->event = NULL;
+}
+
+void fastSemPost(FastSemaphore* semaphore)
+{
+    // the token goes to a blocked task, who counted itself in already
+    if (fastSemAdd(&semaphore->count, 1) < 0)
+        OSSemPost(semaphore->event);
+}
+
+void fastSemPend(FastSemaphore* semaphore)
+{
+    INT8U err;
+
+    // a post that came in since is kept by the OS semaphore
+    if (fastSemAdd(&semaphore->count, -1) <= 0)
+        OSSemPend(semaphore->event, 0, &err);
+}
+
+int fastSemAccept(FastSemaphore* semaphore)
+{
+    OS_CPU_SR cpu_sr = 0;
+    int taken = 0;
+
+    OS_ENTER_CRITICAL();
+    if (semaphore->count > 0) {
+        semaphore->count--;
+        taken = 1;
+    }
+    OS_EXIT_CRITICAL();
+    return taken;
+}
@@ -0,0 +1,40 @@
+#ifndef FAST_SEMAPHORE_H
+#define FAST_SEMAPHORE_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Counting semaphore with an uncontended fast path.
+ *
+ * The count lives in the structure: positive is the number of tokens,
+ * negative the number of tasks blocked in fastSemPend(). Post and pend
+ * change it in one atomic step (on the Nios II, which has no atomic
+ * instructions, with interrupts masked for just the update) and only go
+ * through an OS_EVENT semaphore, and so the scheduler, when a task has to
+ * block or be woken. A post that nobody waits for and a pend that finds a
+ * token never enter the kernel.
+ *
+ * Pends wait for ever; there is no timeout, a timed out waiter could not
+ * take its place in the count back without racing a post. fastSemPost()
+ * may be called from an interrupt.
+ */
+
+typedef struct {
+    volatile alt_32 count;
+    OS_EVENT* event;            // blocked tasks wait here
+} FastSemaphore;
+
+/* Returns 0 when the OS semaphore could not be created */
+int   fastSemInit(FastSemaphore* semaphore, alt_u16 count);
+
+/* Nobody may be waiting */
+void  fastSemDelete(FastSemaphore* semaphore);
+
+void  fastSemPost(FastSemaphore* semaphore);
+void  fastSemPend(FastSemaphore* semaphore);
+
+/* Takes a token if there is one, returns 0 otherwise */
+int   fastSemAccept(FastSemaphore* semaphore);
+
+#endif /* FAST_SEMAPHORE_H */
@@ -0,0 +1,121 @@
+#include <string.h>
+
+#include "HandshakeEngine.h"
+#include "TaskStatistics.h"
+#include "TraceRecorder.h"
+
+int handshakeEngineInit(HandshakeEngine* engine, const HandshakeTransition* table, int transitions,
+                        INT8U participants, OS_FLAGS initialFlags, HandshakeAction action)
+{
+    OS_FLAGS consumed[HANDSHAKE_ENGINE_MAX_PARTICIPANTS];
+    OS_FLAGS others;
+    const HandshakeTransition* transition;
+    INT8U err;
+    int i;
+    int p;
+
+    if (participants == 0 || participants > HANDSHAKE_ENGINE_MAX_PARTICIPANTS || transitions > HANDSHAKE_ENGINE_NO_TRANSITION)
+        return 0;
+
+    engine->table        = table;
+    engine->action       = action;
+    engine->participants = participants;
+    memset(engine->next, HANDSHAKE_ENGINE_NO_TRANSITION, sizeof(engine->next));
+    memset(consumed, 0, sizeof(consumed));
+
+    for (i = 0; i < transitions; i++) {
+        transition = &table[i];
+        if (transition->participant >= participants ||
+                transition->from >= HANDSHAKE_ENGINE_MAX_STATES ||
+                transition->to >= HANDSHAKE_ENGINE_MAX_STATES ||
+                (transition->consume & ~transition->wait) != 0)
+            return 0;
+
+        // one transition per state keeps each participant deterministic
+        if (engine->next[transition->participant][transition->from] != HANDSHAKE_ENGINE_NO_TRANSITION)
+            return 0;
+        engine->next[transition->participant][transition->from] = i;
+        consumed[transition->participant] |= transition->consume;
+    }
+
+    // a flag consumed by one participant must not be waited for by another
+    for (i = 0; i < transitions; i++) {
+        others = 0;
+        for (p = 0; p < participants; p++)
+            if (p != table[i].participant)
+                others |= consumed[p];
+        if ((table[i].wait & others) != 0)
+            return 0;
+    }
+
+    for (p = 0; p < participants; p++) {
+        engine->state[p] = 0;
+        engine->taken[p] = 0;
+    }
+
+    engine->flags = OSFlagCreate(initialFlags, &err);
+    return engine->flags != NULL;
+}
+
+void handshakeEngineDelete(HandshakeEngine* engine)
+{
+    INT8U err;
+
+    OSFlagDel(engine->flags, OS_DEL_ALWAYS, &err);
+    engine->flags = NULL;
+}
+
+INT8U handshakeEngineStep(HandshakeEngine* engine, INT8U participant)
+{
+    const HandshakeTransition* transition;
+    alt_u8 index;
+    INT8U err;
+
+    index = engine->next[participant][engine->state[participant]];
+    if (index == HANDSHAKE_ENGINE_NO_TRANSITION)
+        return OS_ERR_INVALID_OPT;
+    transition = &engine->table[index];
+
+    if (transition->wait != 0) {
+        TRACE_RECORD_PEND(engine->flags);
+        if (transition->consume == transition->wait) {
+            OSFlagPend(engine->flags, transition->wait, OS_FLAG_WAIT_SET_ALL + OS_FLAG_CONSUME, 0, &err);
+        } else {
+            OSFlagPend(engine->flags, transition->wait, OS_FLAG_WAIT_SET_ALL, 0, &err);
+            if (err == OS_ERR_NONE && transition->consume != 0)
+                OSFlagPost(engine->flags, transition->consume, OS_FLAG_CLR, &err);
+        }
+        TRACE_RECORD_PEND_DONE(engine->flags, err);
+        if (err != OS_ERR_NONE)
+            return err;
+    }
+
+    engine->state[participant] = transition->to;
+    engine->taken[participant]++;
+    if (engine->action != NULL)
+        engine->action(engine, participant, transition);
+
+    err = OS_ERR_NONE;
+    if (transition->clear != 0 || transition->set != 0) {
+        TRACE_RECORD_POST(engine->flags);
+        TASK_STATS_FLAG_POST(engine->flags);
+    }
+    if (transition->clear != 0)
+        OSFlagPost(engine->flags, transition->clear, OS_FLAG_CLR, &err);
+    if (transition->set != 0)
+        OSFlagPost(engine->flags, transition->set, OS_FLAG_SET, &err);
+    return err;
+}
+
+INT8U handshakeEngineRun(HandshakeEngine* engine, INT8U participant, alt_u32 transitions)
+{
+    INT8U err = OS_ERR_NONE;
+    alt_u32 i;
+
+    for (i = 0; transitions == 0 || i < transitions; i++) {
+        err = handshakeEngineStep(engine, participant);
+        if (err != OS_ERR_NONE)
+            break;
+    }
+    return err;
+}
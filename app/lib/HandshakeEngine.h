@@ -0,0 +1,75 @@
+#ifndef HANDSHAKE_ENGINE_H
+#define HANDSHAKE_ENGINE_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Table-driven handshake between N tasks over one event flag group.
+ *
+ * Every participant is a small state machine; all of them start in state
+ * 0. A protocol is a table of transitions, at most one per (participant,
+ * state). A participant takes its transition once every flag in wait is
+ * set, which is a single OSFlagPend() however many peers it waits for, so
+ * the task is readied once per transition instead of once per peer. The
+ * flags in consume are cleared as the transition is taken; consume must
+ * be part of wait, and a consumed flag may only be waited for by one
+ * participant or the others could miss it. After the action the flags in
+ * clear and then the flags in set are posted, telling the peers about the
+ * new state.
+ *
+ * Each participant task calls handshakeEngineRun() with its own index.
+ */
+
+#define HANDSHAKE_ENGINE_MAX_PARTICIPANTS   16
+#define HANDSHAKE_ENGINE_MAX_STATES         8
+#define HANDSHAKE_ENGINE_NO_TRANSITION      0xff
+
+typedef struct {
+    INT8U participant;
+    INT8U from;
+    INT8U to;
+    OS_FLAGS wait;          // all of these must be set, 0 to go ahead at once
+    OS_FLAGS consume;       // part of wait cleared when the transition is taken
+    OS_FLAGS clear;         // cleared after the action
+    OS_FLAGS set;           // set after the action, once clear is done
+} HandshakeTransition;
+
+typedef struct HandshakeEngine HandshakeEngine;
+
+/* Called by the participant between its wakeup and posting the new flags */
+typedef void (*HandshakeAction)(HandshakeEngine* engine, INT8U participant, const HandshakeTransition* transition);
+
+struct HandshakeEngine {
+    const HandshakeTransition* table;
+    OS_FLAG_GRP* flags;
+    HandshakeAction action;             // may be NULL
+    INT8U participants;
+    INT8U state[HANDSHAKE_ENGINE_MAX_PARTICIPANTS];
+    alt_u32 taken[HANDSHAKE_ENGINE_MAX_PARTICIPANTS];
+    alt_u8 next[HANDSHAKE_ENGINE_MAX_PARTICIPANTS][HANDSHAKE_ENGINE_MAX_STATES];  // table index per state
+};
+
+/*
+ * Checks the table and creates the flag group with initialFlags set.
+ * Returns 0 when the table breaks one of the rules above or the group
+ * could not be created.
+ */
+int   handshakeEngineInit(HandshakeEngine* engine, const HandshakeTransition* table, int transitions,
+                          INT8U participants, OS_FLAGS initialFlags, HandshakeAction action);
+
+void  handshakeEngineDelete(HandshakeEngine* engine);
+
+/*
+ * Waits for and takes the next transition of the participant. Returns
+ * OS_ERR_INVALID_OPT when it has none out of its current state.
+ */
+INT8U handshakeEngineStep(HandshakeEngine* engine, INT8U participant);
+
+/*
+ * Takes the given number of transitions (0 for ever); stops early when the
+ * participant has no transition out of its state or a wait fails.
+ */
+INT8U handshakeEngineRun(HandshakeEngine* engine, INT8U participant, alt_u32 transitions);
+
+#endif /* HANDSHAKE_ENGINE_H */
@@ -0,0 +1,136 @@
+#include "IrqTimer.h"
+#include "Timestamp.h"
+
+static void (*irqTimerIsr)(alt_u64 raised, void* context);
+static void* irqTimerContext;
+
+#ifdef IRQ_TIMER_BASE
+
+#include "sys/alt_irq.h"
+#include "altera_avalon_timer_regs.h"
+
+#define IRQ_TIMER_RUN   (ALTERA_AVALON_TIMER_CONTROL_ITO_MSK | \
+                         ALTERA_AVALON_TIMER_CONTROL_CONT_MSK | \
+                         ALTERA_AVALON_TIMER_CONTROL_START_MSK)
+
+static alt_u32 irqTimerPeriodCycles;
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void irqTimerInterrupt(void* context)
+#else
+static void irqTimerInterrupt(void* context, alt_u32 id)
+#endif
+{
+    alt_u32 remaining;
+    alt_u64 now;
+
+    IOWR_ALTERA_AVALON_TIMER_SNAPL(IRQ_TIMER_BASE, 0);
+    now = timestampNow();
+    remaining = IORD_ALTERA_AVALON_TIMER_SNAPL(IRQ_TIMER_BASE) |
+                (IORD_ALTERA_AVALON_TIMER_SNAPH(IRQ_TIMER_BASE) << 16);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(IRQ_TIMER_BASE, 0);
+
+    // the counter was reloaded with the period when it ran out and counts down from there
+    irqTimerIsr(now - (alt_u64)(irqTimerPeriodCycles - 1 - remaining) * timestampFrequency() / IRQ_TIMER_FREQ,
+            irqTimerContext);
+}
+
+static void irqTimerConnect(int connect)
+{
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+    alt_ic_isr_register(IRQ_TIMER_IRQ_INTERRUPT_CONTROLLER_ID, IRQ_TIMER_IRQ,
+            connect ? irqTimerInterrupt : NULL, NULL, NULL);
+#else
+    alt_irq_register(IRQ_TIMER_IRQ, NULL, connect ? irqTimerInterrupt : NULL);
+#endif
+}
+
+int irqTimerStart(alt_u32 periodUs, void (*isr)(alt_u64 raised, void* context), void* context)
+{
+    irqTimerIsr = isr;
+    irqTimerContext = context;
+    irqTimerPeriodCycles = (alt_u32)((alt_u64)IRQ_TIMER_FREQ * periodUs / 1000000);
+
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(IRQ_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(IRQ_TIMER_BASE, 0);
+    irqTimerConnect(1);
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(IRQ_TIMER_BASE, (irqTimerPeriodCycles - 1) & 0xffff);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(IRQ_TIMER_BASE, (irqTimerPeriodCycles - 1) >> 16);
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(IRQ_TIMER_BASE, IRQ_TIMER_RUN);
+    return 1;
+}
+
+void irqTimerStop(void)
+{
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(IRQ_TIMER_BASE, ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+    IOWR_ALTERA_AVALON_TIMER_STATUS(IRQ_TIMER_BASE, 0);
+    irqTimerConnect(0);
+}
+
+#elif defined(__nios2__)
+
+int irqTimerStart(alt_u32 periodUs, void (*isr)(alt_u64 raised, void* context), void* context)
+{
+    return 0;
+}
+
+void irqTimerStop(void)
+{
+}
+
+#else
+
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+static volatile alt_u64 irqTimerRaised;
+
+/* Arrival of the signal is the interrupt request */
+static void irqTimerSignal(int signal)
+{
+    irqTimerRaised = timestampNow();
+    OSHostIrqRaise();
+}
+
+static void irqTimerInterrupt(void* context)
+{
+    irqTimerIsr(irqTimerRaised, irqTimerContext);
+}
+
+static void irqTimerSetInterval(alt_u32 periodUs)
+{
+    struct itimerval interval;
+
+    interval.it_interval.tv_sec = periodUs / 1000000;
+    interval.it_interval.tv_usec = periodUs % 1000000;
+    interval.it_value = interval.it_interval;
+    setitimer(ITIMER_REAL, &interval, NULL);
+}
+
+int irqTimerStart(alt_u32 periodUs, void (*isr)(alt_u64 raised, void* context), void* context)
+{
+    struct sigaction action;
+
+    irqTimerIsr = isr;
+    irqTimerContext = context;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = irqTimerSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGALRM, &action, NULL) != 0)
+        return 0;
+
+    OSHostIrqConnect(irqTimerInterrupt, NULL);
+    irqTimerSetInterval(periodUs);
+    return 1;
+}
+
+void irqTimerStop(void)
+{
+    irqTimerSetInterval(0);
+    OSHostIrqConnect(NULL, NULL);
+}
+
+#endif
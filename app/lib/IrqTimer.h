@@ -0,0 +1,43 @@
+#ifndef IRQ_TIMER_H
+#define IRQ_TIMER_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Periodic interrupt for latency measurements.
+ *
+ * irqTimerStart() calls isr(raised, context) from an interrupt every
+ * periodUs, with the timestampNow() time the interrupt was raised at, so
+ * the ISR can tell how long it took to get there. The ISR runs between
+ * OSIntEnter() and OSIntExit() and may post to the kernel.
+ *
+ * On the board the interrupt is that of a second interval timer, timer_1
+ * of the DE2 and DE2-115 designs unless IRQ_TIMER_BASE and its companions
+ * name another one; the HAL's interrupt entry brackets the ISR with
+ * OSIntEnter() and OSIntExit(). The raise time is worked back from the
+ * timer's snapshot: how far the counter has run down since it ran out. The
+ * DE0-Nano design has no second timer and irqTimerStart() fails.
+ *
+ * On the host the interrupt is the external interrupt of the port, raised
+ * from SIGALRM by setitimer(); the time the signal arrived is the raise
+ * time. It is taken at the end of the running task's next critical
+ * section, or at once from the idle task.
+ */
+
+#ifdef __nios2__
+#if !defined(IRQ_TIMER_BASE) && defined(TIMER_1_BASE)
+#define IRQ_TIMER_BASE                          TIMER_1_BASE
+#define IRQ_TIMER_IRQ                           TIMER_1_IRQ
+#define IRQ_TIMER_IRQ_INTERRUPT_CONTROLLER_ID   TIMER_1_IRQ_INTERRUPT_CONTROLLER_ID
+#define IRQ_TIMER_FREQ                          TIMER_1_FREQ
+#endif
+#endif
+
+/* Starts the interrupt; returns 1, or 0 when there is no timer for it */
+int  irqTimerStart(alt_u32 periodUs, void (*isr)(alt_u64 raised, void* context), void* context);
+
+/* Stops the interrupt, no ISR runs after it returns */
+void irqTimerStop(void);
+
+#endif /* IRQ_TIMER_H */
@@ -0,0 +1,132 @@
+#include <stdio.h>
+
+#include "LatencyHistogram.h"
+
+#define SUB_BUCKETS       (1u << LATENCY_HISTOGRAM_SUB_BITS)
+#define HALF_SUB_BUCKETS  (1u << (LATENCY_HISTOGRAM_SUB_BITS - 1))
+
+static alt_u32 bucketIndex(alt_u32 value)
+{
+    alt_u32 shift;
+
+    if (value < SUB_BUCKETS)
+        return value;
+
+    // value >> shift lands in [HALF_SUB_BUCKETS, SUB_BUCKETS)
+    shift = (31 - __builtin_clz(value)) - LATENCY_HISTOGRAM_SUB_BITS + 1;
+    return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + (value >> shift) - HALF_SUB_BUCKETS;
+}
+
+/* Midpoint of the range of values counted in a bucket */
+static alt_u64 bucketValue(alt_u32 index)
+{
+    alt_u32 shift;
+    alt_u64 low;
+
+    if (index < SUB_BUCKETS)
+        return index;
+
+    shift = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+    low   = (alt_u64)((index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS) << shift;
+    return low + ((1ULL << shift) >> 1);
+}
+
+void latencyHistogramReset(LatencyHistogram* histogram)
+{
+    int i;
+
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+        histogram->counts[i] = 0;
+    histogram->count     = 0;
+    histogram->overflows = 0;
+    histogram->min       = ~0ULL;
+    histogram->max       = 0;
+    histogram->sum       = 0;
+}
+
+void latencyHistogramRecord(LatencyHistogram* histogram, alt_u64 value)
+{
+    if (value > 0xFFFFFFFFULL) {
+        histogram->overflows++;
+        histogram->counts[LATENCY_HISTOGRAM_BUCKETS - 1]++;
+    } else {
+        histogram->counts[bucketIndex((alt_u32)value)]++;
+    }
+
+    histogram->count++;
+    histogram->sum += value;
+    if (value < histogram->min)
+        histogram->min = value;
+    if (value > histogram->max)
+        histogram->max = value;
+}
+
+alt_u64 latencyHistogramPercentile(const LatencyHistogram* histogram, alt_u32 partsPerMillion)
+{
+    alt_u64 rank;
+    alt_u64 seen = 0;
+    alt_u64 value;
+    int i;
+
+    if (histogram->count == 0)
+        return 0;
+
+    // smallest value with at least partsPerMillion of the samples at or below it
+    rank = ((alt_u64)histogram->count * partsPerMillion + 999999) / 1000000;
+    if (rank == 0)
+        rank = 1;
+
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank)
+            break;
+    }
+
+    // the exact extremes are known, never report past them
+    value = bucketValue(i);
+    if (value < histogram->min)
+        value = histogram->min;
+    if (value > histogram->max)
+        value = histogram->max;
+    return value;
+}
+
+alt_u64 latencyHistogramMean(const LatencyHistogram* histogram)
+{
+    if (histogram->count == 0)
+        return 0;
+    return histogram->sum / histogram->count;
+}
+
+static alt_u64 cyclesToNs(alt_u64 cycles, alt_u64 frequency)
+{
+    return cycles * 1000000000ULL / frequency;
+}
+
+void latencyHistogramPrint(const LatencyHistogram* histogram, const char* name, alt_u64 frequency)
+{
+    alt_u64 values[6];
+    int i;
+
+    if (histogram->count == 0) {
+        printf("%-16s no samples\n", name);
+        return;
+    }
+
+    values[0] = histogram->min;
+    values[1] = latencyHistogramPercentile(histogram, LATENCY_P50);
+    values[2] = latencyHistogramPercentile(histogram, LATENCY_P99);
+    values[3] = latencyHistogramPercentile(histogram, LATENCY_P999);
+    values[4] = histogram->max;
+    values[5] = latencyHistogramMean(histogram);
+
+    printf("%-16s n=%lu\n", name, (unsigned long)histogram->count);
+    printf("  %-8s %10s %10s %10s %10s %10s %10s\n", "", "min", "p50", "p99", "p99.9", "max", "mean");
+    printf("  %-8s", "cycles");
+    for (i = 0; i < 6; i++)
+        printf(" %10llu", (unsigned long long)values[i]);
+    printf("\n  %-8s", "ns");
+    for (i = 0; i < 6; i++)
+        printf(" %10llu", (unsigned long long)cyclesToNs(values[i], frequency));
+    printf("\n");
+}
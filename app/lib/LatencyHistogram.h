@@ -0,0 +1,42 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "alt_types.h"
+
+/*
+ * Preallocated log-linear (HDR-style) latency histogram.
+ *
+ * Values below 2^LATENCY_HISTOGRAM_SUB_BITS are counted exactly; above that
+ * every power-of-two range is split into 2^(LATENCY_HISTOGRAM_SUB_BITS-1)
+ * linear buckets, so a recorded value is off by at most 1/64 (1.6%) of
+ * itself. Recording is a handful of instructions and never allocates, so it
+ * can sit on a measured path. Min, max and the mean are kept exactly.
+ */
+
+#define LATENCY_HISTOGRAM_SUB_BITS   7
+#define LATENCY_HISTOGRAM_BUCKETS    ((1 << LATENCY_HISTOGRAM_SUB_BITS) + \
+                                      (32 - LATENCY_HISTOGRAM_SUB_BITS) * (1 << (LATENCY_HISTOGRAM_SUB_BITS - 1)))
+
+/* Percentiles are given in parts per million, e.g. 999000 for p99.9 */
+#define LATENCY_P50     500000
+#define LATENCY_P99     990000
+#define LATENCY_P999    999000
+
+typedef struct {
+    alt_u32 counts[LATENCY_HISTOGRAM_BUCKETS];
+    alt_u32 count;
+    alt_u32 overflows;   // samples >= 2^32, counted in the last bucket
+    alt_u64 min;
+    alt_u64 max;
+    alt_u64 sum;
+} LatencyHistogram;
+
+void    latencyHistogramReset(LatencyHistogram* histogram);
+void    latencyHistogramRecord(LatencyHistogram* histogram, alt_u64 value);
+alt_u64 latencyHistogramPercentile(const LatencyHistogram* histogram, alt_u32 partsPerMillion);
+alt_u64 latencyHistogramMean(const LatencyHistogram* histogram);
+
+/* Prints count, min/p50/p99/p99.9/max and mean, in cycles and in ns */
+void    latencyHistogramPrint(const LatencyHistogram* histogram, const char* name, alt_u64 frequency);
+
+#endif /* LATENCY_HISTOGRAM_H */
@@ -0,0 +1,30 @@
+#ifndef MEMORY_PLACEMENT_H
+#define MEMORY_PLACEMENT_H
+
+/*
+ * Placement of hot data in on-chip memory.
+ *
+ * The Nios II/e of the pre-built designs has no data cache, so every access
+ * to a stack, a TCB or an event goes out to SDRAM. A program with a
+ * placement profile, placement/<program>.mk, is linked on the DE2 and the
+ * DE2-115 with an output section .fast in the on-chip memory, ahead of the
+ * SDRAM sections (see "Memory placement" in ProjectMakefile). The section
+ * takes the kernel code and data the profile lists, all small data (the
+ * ready list, OSTCBCur, OSTCBHighRdy and the like) and every variable
+ * declared FAST_DATA:
+ *
+ *     OS_STK task0Stack[TASK0_STACKSIZE] FAST_DATA;
+ *
+ * FAST_DATA variables are loaded by nios2-download like initialised data,
+ * so they start out zero but are not cleared again on a reset. Builds
+ * without a profile, those for the DE0-Nano, which has no on-chip memory,
+ * and the host build leave FAST_DATA empty.
+ */
+
+#ifdef MEMORY_PLACEMENT
+#define FAST_DATA   __attribute__((section(".fast_data")))
+#else
+#define FAST_DATA
+#endif
+
+#endif /* MEMORY_PLACEMENT_H */
@@ -0,0 +1,107 @@
+#include "MessageRing.h"
+
+int messageRingInit(MessageRing* ring, alt_u32* pool, alt_u32 slotSize, alt_u32 slots)
+{
+    ring->pool            = pool;
+    ring->slotWords       = MESSAGE_RING_SLOT_WORDS(slotSize);
+    ring->slotSize        = slotSize;
+    ring->mask            = slots - 1;
+    ring->head            = 0;
+    ring->tail            = 0;
+    ring->producerWaiting = 0;
+    ring->consumerWaiting = 0;
+    ring->itemsSemaphore  = OSSemCreate(0);
+    ring->spaceSemaphore  = OSSemCreate(0);
+
+    return ring->itemsSemaphore != NULL && ring->spaceSemaphore != NULL;
+}
+
+void messageRingDelete(MessageRing* ring)
+{
+    INT8U err;
+
+    OSSemDel(ring->itemsSemaphore, OS_DEL_ALWAYS, &err);
+    OSSemDel(ring->spaceSemaphore, OS_DEL_ALWAYS, &err);
+    ring->itemsSemaphore = NULL;
+    ring->spaceSemaphore = NULL;
+}
+
+void* messageRingClaim(MessageRing* ring)
+{
+    OS_CPU_SR cpu_sr = 0;
+    INT8U err;
+
+    while (ring->head - ring->tail > ring->mask) {
+        // the consumer cannot release in between setting the flag and the check
+        OS_ENTER_CRITICAL();
+        if (ring->head - ring->tail > ring->mask) {
+            ring->producerWaiting = 1;
+            OS_EXIT_CRITICAL();
+            OSSemPend(ring->spaceSemaphore, 0, &err);
+        } else {
+            OS_EXIT_CRITICAL();
+        }
+    }
+
+    return &ring->pool[(ring->head & ring->mask) * ring->slotWords + 1];
+}
+
+void messageRingPublish(MessageRing* ring, alt_u32 length)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u8 wake;
+
+    ring->pool[(ring->head & ring->mask) * ring->slotWords] = length;
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (ring->consumerWaiting) {
+        OS_ENTER_CRITICAL();
+        wake = ring->consumerWaiting;
+        ring->consumerWaiting = 0;
+        OS_EXIT_CRITICAL();
+        if (wake)
+            OSSemPost(ring->itemsSemaphore);
+    }
+}
+
+void* messageRingReceive(MessageRing* ring, alt_u32* length)
+{
+    OS_CPU_SR cpu_sr = 0;
+    INT8U err;
+    alt_u32* slot;
+
+    while (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == ring->tail) {
+        OS_ENTER_CRITICAL();
+        if (ring->head == ring->tail) {
+            ring->consumerWaiting = 1;
+            OS_EXIT_CRITICAL();
+            OSSemPend(ring->itemsSemaphore, 0, &err);
+        } else {
+            OS_EXIT_CRITICAL();
+        }
+    }
+
+    slot = &ring->pool[(ring->tail & ring->mask) * ring->slotWords];
+    *length = slot[0];
+    return &slot[1];
+}
+
+void messageRingRelease(MessageRing* ring)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u8 wake;
+
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // let a blocked producer refill in one go once half of the ring is free
+    if (ring->producerWaiting && ring->head - ring->tail <= (ring->mask + 1) / 2) {
+        OS_ENTER_CRITICAL();
+        wake = ring->producerWaiting;
+        ring->producerWaiting = 0;
+        OS_EXIT_CRITICAL();
+        if (wake)
+            OSSemPost(ring->spaceSemaphore);
+    }
+}
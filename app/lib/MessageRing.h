@@ -0,0 +1,63 @@
+#ifndef MESSAGE_RING_H
+#define MESSAGE_RING_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Zero-copy single-producer/single-consumer message channel.
+ *
+ * Messages live in a ring of fixed-size slots in a caller-provided static
+ * pool. The producer claims the next free slot, fills it in place and
+ * publishes it; the consumer gets a pointer to the oldest published slot,
+ * reads it in place and releases it. No payload is ever copied.
+ *
+ * Each index is written by one side only, so claiming, publishing and
+ * releasing are plain loads and stores. A task only blocks, on one of two
+ * semaphores, when the ring is empty (consumer) or full (producer): the
+ * waiting side sets a flag under a critical section and the other side
+ * posts only when it sees that flag. A blocked producer is woken once half
+ * of the ring is free again, so a full ring drains in a burst instead of
+ * switching tasks on every slot.
+ */
+
+typedef struct {
+    alt_u32* pool;
+    alt_u32 slotWords;              // length word + payload, in words
+    alt_u32 slotSize;               // maximum payload in bytes
+    alt_u32 mask;                   // slots - 1, slots is a power of two
+    volatile alt_u32 head;          // slots published, written by the producer
+    volatile alt_u32 tail;          // slots released, written by the consumer
+    volatile alt_u8 producerWaiting;
+    volatile alt_u8 consumerWaiting;
+    OS_EVENT* itemsSemaphore;       // posted when an empty ring gets a message
+    OS_EVENT* spaceSemaphore;       // posted when a full ring is half free
+} MessageRing;
+
+/* Size of the pool backing a ring, in alt_u32 words */
+#define MESSAGE_RING_SLOT_WORDS(slotSize)           (1 + ((slotSize) + 3) / 4)
+#define MESSAGE_RING_POOL_WORDS(slotSize, slots)    (MESSAGE_RING_SLOT_WORDS(slotSize) * (slots))
+
+/*
+ * slots must be a power of two and pool at least
+ * MESSAGE_RING_POOL_WORDS(slotSize, slots) long. Returns 0 when the
+ * semaphores could not be created.
+ */
+int messageRingInit(MessageRing* ring, alt_u32* pool, alt_u32 slotSize, alt_u32 slots);
+
+/* Deletes the semaphores; neither side may be using the ring */
+void  messageRingDelete(MessageRing* ring);
+
+/* Producer: returns the payload of the next free slot, blocking while the ring is full */
+void* messageRingClaim(MessageRing* ring);
+
+/* Producer: makes the claimed slot, holding length bytes, visible to the consumer */
+void  messageRingPublish(MessageRing* ring, alt_u32 length);
+
+/* Consumer: returns the oldest published payload, blocking while the ring is empty */
+void* messageRingReceive(MessageRing* ring, alt_u32* length);
+
+/* Consumer: hands the received slot back to the producer */
+void  messageRingRelease(MessageRing* ring);
+
+#endif /* MESSAGE_RING_H */
@@ -0,0 +1,97 @@
+#include <stdio.h>
+
+#include "OutputServer.h"
+#include "TaskStatistics.h"
+#include "TraceRecorder.h"
+
+static OS_EVENT* outputQueue;
+static void* outputQueueStorage[OUTPUT_SERVER_QUEUE_SIZE];
+static char outputBuffer[OUTPUT_SERVER_BUFFER_SIZE];
+static OS_STK outputServerStack[OUTPUT_SERVER_STACKSIZE];
+static OutputServerStatistics outputStatistics;
+
+static alt_u32 outputServerFlush(alt_u32 length)
+{
+    if (length > 0) {
+        fwrite(outputBuffer, 1, length, stdout);
+        fflush(stdout);
+        outputStatistics.flushes++;
+        outputStatistics.bytes += length;
+    }
+    return 0;
+}
+
+static void outputServerTask(void* pdata)
+{
+    const char* text;
+    alt_u32 length;
+    INT8U err;
+
+    while (1) {
+        TRACE_RECORD_PEND(outputQueue);
+        text = OSQPend(outputQueue, 0, &err);
+        TRACE_RECORD_PEND_DONE(outputQueue, err);
+
+        // coalesce everything queued so far into as few writes as possible
+        length = 0;
+        while (text != NULL) {
+            while (*text != '\0') {
+                if (length == OUTPUT_SERVER_BUFFER_SIZE)
+                    length = outputServerFlush(length);
+                outputBuffer[length++] = *text++;
+            }
+            text = OSQAccept(outputQueue, &err);
+        }
+        outputServerFlush(length);
+    }
+}
+
+INT8U outputServerStart(INT8U priority)
+{
+    outputQueue = OSQCreate(outputQueueStorage, OUTPUT_SERVER_QUEUE_SIZE);
+    if (outputQueue == NULL)
+        return OS_ERR_PEVENT_NULL;
+#ifdef TRACE_RECORDER
+    traceRecorderNameObject(outputQueue, "output queue");
+#endif
+
+    return OSTaskCreateExt
+        ( outputServerTask,                                 // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &outputServerStack[OUTPUT_SERVER_STACKSIZE-1],    // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &outputServerStack[0],                            // Pointer to bottom of task stack
+          OUTPUT_SERVER_STACKSIZE,                          // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
+
+INT8U outputServerPost(const char* text)
+{
+    OS_CPU_SR cpu_sr = 0;
+    INT8U err;
+
+    TRACE_RECORD_POST(outputQueue);
+    TASK_STATS_POST(outputQueue);
+    err = OSQPost(outputQueue, (void*)text);
+
+    OS_ENTER_CRITICAL();
+    if (err == OS_ERR_NONE)
+        outputStatistics.posts++;
+    else
+        outputStatistics.dropped++;
+    OS_EXIT_CRITICAL();
+    return err;
+}
+
+void outputServerGetStatistics(OutputServerStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    *statistics = outputStatistics;
+    OS_EXIT_CRITICAL();
+}
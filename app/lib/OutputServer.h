@@ -0,0 +1,42 @@
+#ifndef OUTPUT_SERVER_H
+#define OUTPUT_SERVER_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Console output server.
+ *
+ * Tasks hand strings to a dedicated output task by posting a pointer to a
+ * message queue, which takes constant time and never waits for the UART.
+ * The server wakes on the first string, takes everything else already
+ * queued, copies it into one buffer and writes that with a single fwrite,
+ * so bursts of short messages become few large transfers.
+ *
+ * The server does not copy a string until it prints it, so posted strings
+ * must stay unchanged until then (string literals or static buffers). When
+ * the queue is full the string is dropped and counted instead of blocking.
+ * Give the server a priority below the tasks that print, so it runs when
+ * they wait and can batch their output.
+ */
+
+#define OUTPUT_SERVER_QUEUE_SIZE    32
+#define OUTPUT_SERVER_BUFFER_SIZE   512
+#define OUTPUT_SERVER_STACKSIZE     2048
+
+typedef struct {
+    alt_u32 posts;
+    alt_u32 dropped;        // posts refused because the queue was full
+    alt_u32 flushes;        // fwrite calls
+    alt_u32 bytes;
+} OutputServerStatistics;
+
+/* Creates the queue and the server task at the given priority */
+INT8U outputServerStart(INT8U priority);
+
+/* Queues text for printing; returns OS_ERR_Q_FULL when it was dropped */
+INT8U outputServerPost(const char* text);
+
+void  outputServerGetStatistics(OutputServerStatistics* statistics);
+
+#endif /* OUTPUT_SERVER_H */
@@ -0,0 +1,186 @@
+#include <string.h>
+
+#include "PerfBackend.h"
+
+#ifdef __nios2__
+
+#include "altera_avalon_performance_counter.h"
+#include "Timestamp.h"
+
+static int perfNiosOpen(void)
+{
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    return 1;
+}
+
+static void perfNiosClose(void)
+{
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+}
+
+static alt_u64 perfNiosNow(void)
+{
+    return timestampNow();
+}
+
+static alt_u64 perfNiosFrequency(void)
+{
+    return (alt_u64)ALT_CPU_FREQ;
+}
+
+const PerfBackend perfBackendNios = {
+    "nios", perfNiosOpen, perfNiosClose, perfNiosNow, perfNiosFrequency
+};
+
+static const PerfBackend* const perfBackends[] = { &perfBackendNios };
+
+#else
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PERF_BACKEND_CALIBRATION_NS     20000000ULL
+
+static alt_u64 perfMonotonicNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (alt_u64)ts.tv_sec * 1000000000ULL + (alt_u64)ts.tv_nsec;
+}
+
+/* Counts per second of the given counter, measured over 20 ms */
+static alt_u64 perfCalibrate(alt_u64 (*now)(void))
+{
+    alt_u64 startNs = perfMonotonicNow();
+    alt_u64 start = now();
+    alt_u64 elapsedNs;
+
+    do {
+        elapsedNs = perfMonotonicNow() - startNs;
+    } while (elapsedNs < PERF_BACKEND_CALIBRATION_NS);
+    return (now() - start) * 1000000000ULL / elapsedNs;
+}
+
+static int perfMonotonicOpen(void)
+{
+    return 1;
+}
+
+static void perfMonotonicClose(void)
+{
+}
+
+static alt_u64 perfMonotonicFrequency(void)
+{
+    return 1000000000ULL;
+}
+
+const PerfBackend perfBackendMonotonic = {
+    "monotonic", perfMonotonicOpen, perfMonotonicClose, perfMonotonicNow, perfMonotonicFrequency
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <x86intrin.h>
+
+static alt_u64 perfTscFrequencyValue;
+
+static alt_u64 perfTscNow(void)
+{
+    return (alt_u64)__rdtsc();
+}
+
+static int perfTscOpen(void)
+{
+    if (perfTscFrequencyValue == 0)
+        perfTscFrequencyValue = perfCalibrate(perfTscNow);
+    return 1;
+}
+
+static alt_u64 perfTscFrequency(void)
+{
+    return perfTscFrequencyValue;
+}
+
+const PerfBackend perfBackendTsc = {
+    "tsc", perfTscOpen, perfMonotonicClose, perfTscNow, perfTscFrequency
+};
+
+#endif
+
+// user space CPU cycles of this thread, read with one read() per sample
+static int perfEventFd = -1;
+static alt_u64 perfEventFrequencyValue;
+
+static alt_u64 perfEventNow(void)
+{
+    alt_u64 cycles = 0;
+
+    if (read(perfEventFd, &cycles, sizeof(cycles)) != sizeof(cycles))
+        return 0;
+    return cycles;
+}
+
+static int perfEventOpen(void)
+{
+    struct perf_event_attr attr;
+
+    if (perfEventFd >= 0)
+        return 1;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perfEventFd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (perfEventFd < 0)
+        return 0;
+
+    ioctl(perfEventFd, PERF_EVENT_IOC_ENABLE, 0);
+    perfEventFrequencyValue = perfCalibrate(perfEventNow);
+    return 1;
+}
+
+static void perfEventClose(void)
+{
+    if (perfEventFd < 0)
+        return;
+    close(perfEventFd);
+    perfEventFd = -1;
+}
+
+static alt_u64 perfEventFrequency(void)
+{
+    return perfEventFrequencyValue;
+}
+
+const PerfBackend perfBackendPerfEvent = {
+    "perf", perfEventOpen, perfEventClose, perfEventNow, perfEventFrequency
+};
+
+static const PerfBackend* const perfBackends[] = {
+    &perfBackendMonotonic,
+#if defined(__x86_64__) || defined(__i386__)
+    &perfBackendTsc,
+#endif
+    &perfBackendPerfEvent
+};
+
+#endif
+
+const PerfBackend* perfBackendFind(const char* name)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(perfBackends) / sizeof(perfBackends[0]); i++)
+        if (strcmp(perfBackends[i]->name, name) == 0)
+            return perfBackends[i];
+    return NULL;
+}
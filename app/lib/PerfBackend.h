@@ -0,0 +1,49 @@
+#ifndef PERF_BACKEND_H
+#define PERF_BACKEND_H
+
+#include "alt_types.h"
+
+/*
+ * Clock sources for lib/PerfScope.
+ *
+ * A backend is a free-running counter: now() reads it and frequency() says
+ * how fast it counts, so a report reads the same whatever counts the
+ * cycles. On the board the global counter of the performance counter
+ * peripheral is used, which open() resets and starts. On the host there
+ * is CLOCK_MONOTONIC_RAW, the TSC on x86 and the CPU cycle counter through
+ * perf_event_open(); the frequency of the last two is measured against
+ * CLOCK_MONOTONIC_RAW when they are opened. perf_event_open() may be
+ * refused (see /proc/sys/kernel/perf_event_paranoid), open() then
+ * returns 0.
+ */
+
+typedef struct {
+    const char* name;
+    int     (*open)(void);          // returns 0 when the counter is not available
+    void    (*close)(void);
+    alt_u64 (*now)(void);
+    alt_u64 (*frequency)(void);     // counts per second
+} PerfBackend;
+
+#ifdef __nios2__
+
+extern const PerfBackend perfBackendNios;
+
+#define PERF_BACKEND_DEFAULT    (&perfBackendNios)
+
+#else
+
+extern const PerfBackend perfBackendMonotonic;
+extern const PerfBackend perfBackendPerfEvent;
+#if defined(__x86_64__) || defined(__i386__)
+extern const PerfBackend perfBackendTsc;
+#endif
+
+#define PERF_BACKEND_DEFAULT    (&perfBackendMonotonic)
+
+#endif
+
+/* Looks a backend up by name ("nios", "monotonic", "tsc", "perf"), NULL if unknown */
+const PerfBackend* perfBackendFind(const char* name);
+
+#endif /* PERF_BACKEND_H */
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PerfScope.h"
+
+static PerfSection perfSections[PERF_SCOPE_MAX_SECTIONS];
+static int perfSectionCount;
+static const PerfBackend* perfBackend = PERF_BACKEND_DEFAULT;
+
+// sections begun and not yet ended, innermost last
+static alt_u8 perfOpen[PERF_SCOPE_MAX_DEPTH];
+static int perfOpenCount;
+
+int perfScopeInit(const PerfBackend* backend)
+{
+#ifndef __nios2__
+    const char* name = getenv("PERF_SCOPE_BACKEND");
+
+    if (backend == NULL && name != NULL)
+        backend = perfBackendFind(name);
+#endif
+    if (backend == NULL)
+        backend = PERF_BACKEND_DEFAULT;
+
+    perfBackend = backend;
+    if (backend->open())
+        return 1;
+
+    printf("Performance counter \"%s\" not available, using \"%s\"\n",
+            backend->name, PERF_BACKEND_DEFAULT->name);
+    perfBackend = PERF_BACKEND_DEFAULT;
+    perfBackend->open();
+    return 0;
+}
+
+void perfScopeClose(void)
+{
+    perfBackend->close();
+}
+
+int perfScopeSection(const char* name)
+{
+    OS_CPU_SR cpu_sr = 0;
+    int i;
+
+    OS_ENTER_CRITICAL();
+    for (i = 0; i < perfSectionCount; i++) {
+        if (strcmp(perfSections[i].name, name) == 0) {
+            OS_EXIT_CRITICAL();
+            return i;
+        }
+    }
+    if (perfSectionCount == PERF_SCOPE_MAX_SECTIONS) {
+        OS_EXIT_CRITICAL();
+        return PERF_SCOPE_NONE;
+    }
+    i = perfSectionCount++;
+    memset(&perfSections[i], 0, sizeof(perfSections[i]));
+    perfSections[i].name = name;
+    OS_EXIT_CRITICAL();
+    return i;
+}
+
+void perfScopeBegin(int section)
+{
+    OS_CPU_SR cpu_sr = 0;
+    PerfSection* s;
+
+    if (section < 0 || section >= perfSectionCount)
+        return;
+
+    s = &perfSections[section];
+    OS_ENTER_CRITICAL();
+    if (s->active++ == 0) {
+        if (s->count == 0)
+            s->depth = perfOpenCount;
+        if (perfOpenCount < PERF_SCOPE_MAX_DEPTH)
+            perfOpen[perfOpenCount++] = section;
+        s->start = perfBackend->now();
+    }
+    OS_EXIT_CRITICAL();
+}
+
+void perfScopeEnd(int section)
+{
+    alt_u64 now = perfBackend->now();
+    OS_CPU_SR cpu_sr = 0;
+    alt_u64 elapsed;
+    PerfSection* s;
+    int i;
+
+    if (section < 0 || section >= perfSectionCount)
+        return;
+
+    s = &perfSections[section];
+    OS_ENTER_CRITICAL();
+    if (s->active == 0 || --s->active > 0) {
+        OS_EXIT_CRITICAL();
+        return;
+    }
+
+    elapsed = now - s->start;
+    if (s->count == 0 || elapsed < s->min)
+        s->min = elapsed;
+    if (elapsed > s->max)
+        s->max = elapsed;
+    s->sum += elapsed;
+    s->count++;
+
+    // usually the innermost, but a section ended in another task need not be
+    for (i = perfOpenCount - 1; i >= 0; i--) {
+        if (perfOpen[i] == section) {
+            memmove(&perfOpen[i], &perfOpen[i + 1], perfOpenCount - i - 1);
+            perfOpenCount--;
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+void perfScopeReset(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    int i;
+
+    OS_ENTER_CRITICAL();
+    for (i = 0; i < perfSectionCount; i++) {
+        perfSections[i].sum = 0;
+        perfSections[i].min = 0;
+        perfSections[i].max = 0;
+        perfSections[i].count = 0;
+        perfSections[i].active = 0;
+    }
+    perfOpenCount = 0;
+    OS_EXIT_CRITICAL();
+}
+
+const PerfSection* perfScopeGet(int section)
+{
+    if (section < 0 || section >= perfSectionCount)
+        return NULL;
+    return &perfSections[section];
+}
+
+const PerfBackend* perfScopeBackend(void)
+{
+    return perfBackend;
+}
+
+static double perfScopeUs(alt_u64 counts, alt_u64 frequency)
+{
+    return (double)counts * 1e6 / frequency;
+}
+
+void perfScopePrint(void)
+{
+    alt_u64 frequency = perfBackend->frequency();
+    const PerfSection* s;
+    int i;
+
+    printf("Sections measured with \"%s\" at %llu counts/s\n",
+            perfBackend->name, (unsigned long long)frequency);
+    printf("%-28s %10s %14s %10s %10s %10s\n", "section", "count", "total (us)", "min (us)", "mean (us)", "max (us)");
+    for (i = 0; i < perfSectionCount; i++) {
+        s = &perfSections[i];
+        printf("%*s%-*s %10lu %14.1f %10.3f %10.3f %10.3f\n",
+                2 * s->depth, "", 28 - 2 * s->depth, s->name,
+                (unsigned long)s->count,
+                perfScopeUs(s->sum, frequency),
+                perfScopeUs(s->min, frequency),
+                s->count > 0 ? perfScopeUs(s->sum, frequency) / s->count : 0.0,
+                perfScopeUs(s->max, frequency));
+    }
+}
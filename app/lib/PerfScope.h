@@ -0,0 +1,62 @@
+#ifndef PERF_SCOPE_H
+#define PERF_SCOPE_H
+
+#include "includes.h"
+#include "alt_types.h"
+#include "PerfBackend.h"
+
+/*
+ * Named measurement sections on top of a PerfBackend.
+ *
+ * Sections are registered by name at run time, as many as
+ * PERF_SCOPE_MAX_SECTIONS, and keep count, sum, min and max of the time
+ * between perfScopeBegin() and perfScopeEnd(). A begin and its end may be in
+ * different tasks, as for a context switch. Sections nest: one begun while
+ * others are open is shown indented under the innermost of them in the
+ * report, and a section begun again before its end (recursion) is timed
+ * from the outermost begin to the matching end.
+ *
+ * The report is the same on the board and on the host, only the backend
+ * that counts differs; PERF_SCOPE_BACKEND selects a host backend by name
+ * at init.
+ */
+
+#define PERF_SCOPE_MAX_SECTIONS     64
+#define PERF_SCOPE_MAX_DEPTH        8
+#define PERF_SCOPE_NONE             (-1)
+
+typedef struct {
+    const char* name;
+    alt_u64 start;
+    alt_u64 sum;
+    alt_u64 min;
+    alt_u64 max;
+    alt_u32 count;
+    alt_u8 active;      // begins not yet ended
+    alt_u8 depth;       // number of open sections at the first begin
+} PerfSection;
+
+/*
+ * Opens the backend, NULL for PERF_BACKEND_DEFAULT or the one named in the
+ * PERF_SCOPE_BACKEND environment variable on the host. Falls back to the
+ * default and returns 0 when the backend cannot be opened.
+ */
+int   perfScopeInit(const PerfBackend* backend);
+void  perfScopeClose(void);
+
+/* Id of the section with the given name, registered on first use */
+int   perfScopeSection(const char* name);
+
+void  perfScopeBegin(int section);
+void  perfScopeEnd(int section);
+
+/* Clears the statistics of every section, keeping the sections */
+void  perfScopeReset(void);
+
+const PerfSection* perfScopeGet(int section);
+const PerfBackend* perfScopeBackend(void);
+
+/* Prints count, total, min, mean and max of every section */
+void  perfScopePrint(void);
+
+#endif /* PERF_SCOPE_H */
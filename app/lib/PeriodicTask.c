@@ -0,0 +1,315 @@
+#include <stdio.h>
+
+#include "PeriodicTask.h"
+#include "StackProfile.h"
+#include "Timestamp.h"
+
+#define PERIODIC_TASK_US_PER_TICK   (1000000 / OS_TICKS_PER_SEC)
+
+// Liu-Layland bound n (2^(1/n) - 1) in parts per million, ln 2 beyond the table
+static const alt_u32 periodicTaskBounds[] = { 1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062 };
+#define PERIODIC_TASK_BOUND_LIMIT   693147
+
+static PeriodicTask* periodicTasks;
+static int periodicTaskCount;
+static PeriodicTask* periodicTaskOf[OS_LOWEST_PRIO + 1];
+static alt_u32 periodicTaskUtilisation;     // parts per million
+static alt_u32 periodicTaskBound;
+static const char* periodicTaskAdmission = "not started";
+static INT16U periodicTaskReportPeriod;
+static OS_STK periodicTaskReportStack[PERIODIC_TASK_REPORT_STACKSIZE];
+
+/* Tasks are created with their priority as task ID, which a mutex ceiling leaves alone */
+static PeriodicTask* periodicTaskOfTcb(const OS_TCB* ptcb)
+{
+    return ptcb->OSTCBId <= OS_LOWEST_PRIO ? periodicTaskOf[ptcb->OSTCBId] : NULL;
+}
+
+/* Shortest period first, then shortest deadline, then as listed */
+static int periodicTaskBefore(const PeriodicTask* tasks, int a, int b)
+{
+    if (tasks[a].periodTicks != tasks[b].periodTicks)
+        return tasks[a].periodTicks < tasks[b].periodTicks;
+    if (tasks[a].deadlineTicks != tasks[b].deadlineTicks)
+        return tasks[a].deadlineTicks < tasks[b].deadlineTicks;
+    return a < b;
+}
+
+/*
+ * Worst-case response time of the task: its budget plus the budgets of the
+ * tasks above it released meanwhile, R = C + sum(ceil(R / T) * C) over
+ * those, iterated up to the fixed point. Stops once past the deadline.
+ */
+static alt_u32 periodicTaskResponseBound(const PeriodicTask* tasks, int count, int i)
+{
+    alt_u64 deadlineUs = (alt_u64)tasks[i].deadlineTicks * PERIODIC_TASK_US_PER_TICK;
+    alt_u64 periodUs;
+    alt_u64 response = tasks[i].budgetUs;
+    alt_u64 previous = 0;
+    int j;
+
+    while (response != previous && response <= deadlineUs) {
+        previous = response;
+        response = tasks[i].budgetUs;
+        for (j = 0; j < count; j++) {
+            if (tasks[j].priority >= tasks[i].priority)
+                continue;
+            periodUs = (alt_u64)tasks[j].periodTicks * PERIODIC_TASK_US_PER_TICK;
+            response += (previous + periodUs - 1) / periodUs * tasks[j].budgetUs;
+        }
+    }
+    return response > 0xffffffffu ? 0xffffffffu : (alt_u32)response;
+}
+
+/* Returns 1 when the set is schedulable and records how it was admitted */
+static int periodicTaskAdmit(PeriodicTask* tasks, int count)
+{
+    int implicitDeadlines = 1;
+    int responsesMet = 1;
+    int belowBound;
+    int i;
+
+    periodicTaskUtilisation = 0;
+    for (i = 0; i < count; i++) {
+        periodicTaskUtilisation += (alt_u32)((alt_u64)tasks[i].budgetUs * 1000000 /
+                ((alt_u64)tasks[i].periodTicks * PERIODIC_TASK_US_PER_TICK));
+        if (tasks[i].deadlineTicks != tasks[i].periodTicks)
+            implicitDeadlines = 0;
+    }
+    periodicTaskBound = count <= (int)(sizeof(periodicTaskBounds) / sizeof(periodicTaskBounds[0])) ?
+            periodicTaskBounds[count - 1] : PERIODIC_TASK_BOUND_LIMIT;
+
+    for (i = 0; i < count; i++) {
+        tasks[i].responseBoundUs = periodicTaskResponseBound(tasks, count, i);
+        if (tasks[i].responseBoundUs > (alt_u32)tasks[i].deadlineTicks * PERIODIC_TASK_US_PER_TICK)
+            responsesMet = 0;
+    }
+
+    // the bound holds for deadlines equal to the periods only
+    belowBound = implicitDeadlines && periodicTaskUtilisation <= periodicTaskBound;
+    if (belowBound)
+        periodicTaskAdmission = "admitted by the utilisation bound";
+    else if (responsesMet)
+        periodicTaskAdmission = "admitted by response-time analysis";
+    else
+        periodicTaskAdmission = "not schedulable";
+    return belowBound || responsesMet;
+}
+
+static void periodicTaskRun(void* pdata)
+{
+    OS_CPU_SR cpu_sr = 0;
+    PeriodicTask* task = pdata;
+    PeriodicTaskStatistics* statistics = &task->statistics;
+    INT32U release;
+    INT32U wait;
+    alt_u64 released;
+    alt_u64 ended;
+    alt_u64 execution;
+    alt_u64 response;
+
+    while (1) {
+        // OSTime is read outside of a critical section, on whose exit the
+        // host port takes a due tick; a tick that still comes before the
+        // delay starts makes this release one tick late
+        wait = task->nextRelease - OSTime;
+        while ((INT32S)wait > 0) {
+            OSTimeDly(wait < PERIODIC_TASK_MAX_DELAY ? wait : PERIODIC_TASK_MAX_DELAY);
+            wait = task->nextRelease - OSTime;
+        }
+
+        OS_ENTER_CRITICAL();
+        release = task->nextRelease;
+        released = task->releaseStamp;
+        task->nextRelease += task->periodTicks;
+        task->executed = 0;
+        task->switchedIn = timestampNow();
+        task->inJob = 1;
+        OS_EXIT_CRITICAL();
+
+        task->job(task->pdata);
+
+        OS_ENTER_CRITICAL();
+        ended = timestampNow();
+        task->inJob = 0;
+        execution = task->executed + ended - task->switchedIn;
+        response = ended - released;
+        statistics->jobs++;
+        if (OSTime - release >= task->deadlineTicks)
+            statistics->deadlineMisses++;
+        if (execution * 1000000 > (alt_u64)task->budgetUs * timestampFrequency())
+            statistics->overBudget++;
+        statistics->executionSum += execution;
+        if (execution > statistics->executionMax)
+            statistics->executionMax = execution;
+        statistics->responseSum += response;
+        if (response > statistics->responseMax)
+            statistics->responseMax = response;
+        OS_EXIT_CRITICAL();
+    }
+}
+
+INT8U periodicTasksStart(PeriodicTask* tasks, int count, INT8U highestPriority)
+{
+    PeriodicTask* task;
+    INT32U firstRelease = OSTimeGet() + 1;
+    INT8U err;
+    int i;
+    int j;
+
+    if (count <= 0)
+        return OS_ERR_NONE;
+
+    // rejected here, before the admission test divides by the periods and
+    // before the first task is created
+    for (i = 0; i < count; i++)
+        if (tasks[i].periodTicks == 0 || tasks[i].deadlineTicks == 0 ||
+                tasks[i].deadlineTicks > tasks[i].periodTicks)
+            return PERIODIC_TASK_ERR_TIMING;
+    if ((int)highestPriority + count - 1 > OS_LOWEST_PRIO - OS_N_SYS_TASKS)
+        return OS_ERR_PRIO_INVALID;
+
+    for (i = 0; i < count; i++) {
+        tasks[i].priority = highestPriority;
+        for (j = 0; j < count; j++)
+            if (j != i && periodicTaskBefore(tasks, j, i))
+                tasks[i].priority++;
+    }
+    periodicTasks = tasks;
+    periodicTaskCount = count;
+    if (!periodicTaskAdmit(tasks, count))
+        return PERIODIC_TASK_ERR_UNSCHEDULABLE;
+
+    for (i = 0; i < count; i++) {
+        task = &tasks[i];
+        task->nextRelease = firstRelease;
+        task->releaseStamp = timestampNow();
+        task->inJob = 0;
+        periodicTaskOf[task->priority] = task;
+        err = OSTaskCreateExt
+            ( periodicTaskRun,                              // Pointer to task code
+              task,                                         // Pointer to argument passed to task
+              &task->stack[task->stackSize-1],              // Pointer to top of task stack
+              task->priority,                               // Desired Task priority
+              task->priority,                               // Task ID
+              &task->stack[0],                              // Pointer to bottom of task stack
+              task->stackSize,                              // Stacksize
+              NULL,                                         // Pointer to user supplied memory (not needed)
+              OS_TASK_OPT_STK_CHK |                         // Stack Checking enabled
+              OS_TASK_OPT_STK_CLR                           // Stack Cleared
+            );
+        if (err != OS_ERR_NONE) {
+            periodicTaskOf[task->priority] = NULL;
+            return err;
+        }
+#ifdef STACK_PROFILE
+        stackProfileAdd(task->priority, task->stackSizeMacro);
+#endif
+    }
+    return OS_ERR_NONE;
+}
+
+/* Called with interrupts disabled, OSTCBCur is switched out for OSTCBHighRdy */
+void periodicTaskSwitchHook(void)
+{
+    PeriodicTask* task;
+    alt_u64 now;
+
+    if (periodicTaskCount == 0)
+        return;
+    now = timestampNow();
+
+    // the first switch, from OSStart(), has no task to switch out
+    if (OSTCBCur != OSTCBHighRdy) {
+        task = periodicTaskOfTcb(OSTCBCur);
+        if (task != NULL && task->inJob)
+            task->executed += now - task->switchedIn;
+    }
+    task = periodicTaskOfTcb(OSTCBHighRdy);
+    if (task != NULL)
+        task->switchedIn = now;
+}
+
+/*
+ * Runs before the tick advances OSTime. Every task whose next release is
+ * still ahead is stamped, so the stamp left once the release has come is
+ * the tick it came on, also when the tick accounts for several at once.
+ */
+void periodicTaskTickHook(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u64 now;
+    int i;
+
+    if (periodicTaskCount == 0)
+        return;
+
+    OS_ENTER_CRITICAL();
+    now = timestampNow();
+    for (i = 0; i < periodicTaskCount; i++)
+        if ((INT32S)(OSTime - periodicTasks[i].nextRelease) < 0)
+            periodicTasks[i].releaseStamp = now;
+    OS_EXIT_CRITICAL();
+}
+
+void periodicTaskGet(const PeriodicTask* task, PeriodicTaskStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    *statistics = task->statistics;
+    OS_EXIT_CRITICAL();
+}
+
+void periodicTaskPrint(void)
+{
+    PeriodicTaskStatistics statistics;
+    double usPerTick = 1e6 / timestampFrequency();
+    const PeriodicTask* task;
+    int i;
+
+    printf("Periodic tasks: utilisation %.1f%%, bound %.1f%% for %d tasks, %s\n",
+            periodicTaskUtilisation / 10000.0, periodicTaskBound / 10000.0, periodicTaskCount,
+            periodicTaskAdmission);
+    printf("task                 prio  period  deadline  budget (us)  bound (us)     jobs  misses  over budget"
+           "  execution mean (us)   max (us)  response mean (us)   max (us)\n");
+    for (i = 0; i < periodicTaskCount; i++) {
+        task = &periodicTasks[i];
+        periodicTaskGet(task, &statistics);
+        printf("%-20s %4d  %6u  %8u  %11lu  %10lu  %7lu  %6lu  %11lu  %19.2f  %9.2f  %18.2f  %9.2f\n",
+                task->name, task->priority, task->periodTicks, task->deadlineTicks,
+                (unsigned long)task->budgetUs, (unsigned long)task->responseBoundUs,
+                (unsigned long)statistics.jobs, (unsigned long)statistics.deadlineMisses,
+                (unsigned long)statistics.overBudget,
+                statistics.jobs > 0 ? statistics.executionSum * usPerTick / statistics.jobs : 0.0,
+                statistics.executionMax * usPerTick,
+                statistics.jobs > 0 ? statistics.responseSum * usPerTick / statistics.jobs : 0.0,
+                statistics.responseMax * usPerTick);
+    }
+}
+
+static void periodicTaskReportTask(void* pdata)
+{
+    while (1) {
+        OSTimeDly(periodicTaskReportPeriod);
+        periodicTaskPrint();
+    }
+}
+
+INT8U periodicTaskReportStart(INT8U priority, INT16U periodTicks)
+{
+    periodicTaskReportPeriod = periodTicks > 0 ? periodTicks : 1;
+
+    return OSTaskCreateExt
+        ( periodicTaskReportTask,                           // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &periodicTaskReportStack[PERIODIC_TASK_REPORT_STACKSIZE-1], // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &periodicTaskReportStack[0],                      // Pointer to bottom of task stack
+          PERIODIC_TASK_REPORT_STACKSIZE,                   // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
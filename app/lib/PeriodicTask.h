@@ -0,0 +1,131 @@
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Rate-monotonic periodic tasks.
+ *
+ * A program lists its periodic tasks once, as a macro that applies its
+ * argument to every task, the way lib/TaskTable.h lists the startup tasks:
+ *
+ *   #define APP_PERIODIC_TASKS(TASK) \
+ *       TASK(Task1, job1, NULL, TASK1_PERIOD_TICKS, TASK1_DEADLINE_TICKS, TASK1_BUDGET_US, TASK1_STACKSIZE) \
+ *       TASK(Task2, job2, NULL, TASK2_PERIOD_TICKS, TASK2_DEADLINE_TICKS, TASK2_BUDGET_US, TASK2_STACKSIZE)
+ *
+ *   PERIODIC_TASK_TABLE(APP_PERIODIC_TASKS);
+ *
+ * with name, job, argument, period and relative deadline in ticks (0 for
+ * the period), execution budget in microseconds and stack size per task.
+ * The job is a function that does one period's work and returns; the
+ * module's task calls it once per release. Releases are absolute, the
+ * k-th at start + k * period, so the period does not drift with the time
+ * the job takes. A job that ends after its next release is followed by
+ * the next job at once.
+ *
+ * periodicTasksStart() gives the tasks rate-monotonic priorities from
+ * highestPriority down, the shortest period highest (ties by deadline,
+ * then as listed), and admits the set only if it is schedulable with the
+ * budgets as worst-case execution times: by the Liu-Layland utilisation
+ * bound when every deadline is the period, otherwise, or when the bound
+ * is exceeded, by response-time analysis. A set that is not admitted is
+ * not created. The priorities taken are highestPriority and the next
+ * periodicTaskTableSize - 1 below it.
+ *
+ * Per job the module records the execution time, the CPU time the job
+ * ran for, and the response time, from the release tick to the end of
+ * the job, both in Timestamp.h ticks, and whether the job missed its
+ * deadline: it is missed when the deadline tick had come by the time the
+ * job ended. A job running longer than its budget is counted as over
+ * budget. The program calls periodicTaskSwitchHook() and
+ * periodicTaskTickHook() from its App_TaskSwHook() and App_TimeTickHook():
+ * the switch hook leaves out the time a job is preempted, and the tick
+ * hook stamps the tick each release comes on. Interrupts are charged to
+ * the job they interrupt. The statistics are kept from the start, so the
+ * maxima are the worst case seen.
+ */
+
+#define PERIODIC_TASK_REPORT_STACKSIZE  1024
+
+// returned by periodicTasksStart() for a set that fails the admission test
+#define PERIODIC_TASK_ERR_UNSCHEDULABLE 250u
+// and for a task with a period or deadline of 0 or a deadline past its period
+#define PERIODIC_TASK_ERR_TIMING        251u
+
+// longest single OSTimeDly(), whose argument is an INT16U on the board
+#define PERIODIC_TASK_MAX_DELAY         65535u
+
+typedef struct {
+    alt_u32 jobs;               // jobs ended
+    alt_u32 deadlineMisses;
+    alt_u32 overBudget;         // jobs that ran longer than the budget
+    alt_u64 executionSum;
+    alt_u64 executionMax;
+    alt_u64 responseSum;
+    alt_u64 responseMax;
+} PeriodicTaskStatistics;
+
+typedef struct {
+    const char* name;
+    void      (*job)(void* pdata);
+    void*       pdata;
+    INT16U      periodTicks;
+    INT16U      deadlineTicks;
+    alt_u32     budgetUs;           // worst-case execution time the admission test assumes
+    OS_STK*     stack;              // bottom of the stack
+    INT32U      stackSize;
+    const char* stackSizeMacro;     // name of the macro that sizes the stack
+
+    INT8U       priority;           // assigned by periodicTasksStart()
+    alt_u32     responseBoundUs;    // worst-case response time of the admission test
+
+    // written by the task and the hooks
+    INT32U      nextRelease;        // tick of the next release
+    alt_u64     releaseStamp;       // timestamp of the last tick up to it
+    alt_u64     executed;           // execution time of the running job so far
+    alt_u64     switchedIn;
+    alt_u8      inJob;
+    PeriodicTaskStatistics statistics;
+} PeriodicTask;
+
+#define PERIODIC_TASK_STACK(name, job, pdata, period, deadline, budgetUs, stackSize) \
+    OS_STK name[stackSize];
+
+// the parameters are not named after the fields, which would replace the designators
+#define PERIODIC_TASK_ENTRY(task, code, arg, period, deadline, budget, size) \
+    { .name = #task, .job = code, .pdata = arg, .periodTicks = period, \
+      .deadlineTicks = (deadline) != 0 ? (deadline) : (period), .budgetUs = budget, \
+      .stack = periodicTaskStacks.task, .stackSize = size, .stackSizeMacro = #size },
+
+#define PERIODIC_TASK_TABLE(TASKS) \
+    struct PeriodicTaskStacks { TASKS(PERIODIC_TASK_STACK) } periodicTaskStacks; \
+    PeriodicTask periodicTaskTable[] = { TASKS(PERIODIC_TASK_ENTRY) }; \
+    const int periodicTaskTableSize = sizeof(periodicTaskTable) / sizeof(periodicTaskTable[0])
+
+/*
+ * Checks the tasks' timing and priorities, assigns the priorities, runs
+ * the admission test and creates the tasks, released together on the next
+ * tick. Returns PERIODIC_TASK_ERR_TIMING for a period or deadline of 0 or
+ * a deadline past the period, OS_ERR_PRIO_INVALID when the priorities
+ * would run below OS_LOWEST_PRIO - OS_N_SYS_TASKS, both before any task is
+ * created, PERIODIC_TASK_ERR_UNSCHEDULABLE when the set is not admitted,
+ * the error of the first task that cannot be created, or OS_ERR_NONE. Builds with
+ * -DSTACK_PROFILE also register each stack with the profiler.
+ */
+INT8U periodicTasksStart(PeriodicTask* tasks, int count, INT8U highestPriority);
+
+/* To be called from App_TaskSwHook() and App_TimeTickHook() */
+void  periodicTaskSwitchHook(void);
+void  periodicTaskTickHook(void);
+
+/* Copies the statistics of the task */
+void  periodicTaskGet(const PeriodicTask* task, PeriodicTaskStatistics* statistics);
+
+/* Prints the admission test and the job statistics of every task */
+void  periodicTaskPrint(void);
+
+/* Starts a task that prints periodicTaskPrint() every periodTicks */
+INT8U periodicTaskReportStart(INT8U priority, INT16U periodTicks);
+
+#endif /* PERIODIC_TASK_H */
@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "ReadyBitmap.h"
+
+#if READY_BITMAP_LEVELS % 32 != 0 || READY_BITMAP_LEVELS > 1024
+#error "READY_BITMAP_LEVELS must be a multiple of 32 up to 1024"
+#endif
+
+void readyBitmapInit(ReadyBitmap* bitmap)
+{
+    memset(bitmap, 0, sizeof(*bitmap));
+}
+
+void readyBitmapInsert(ReadyBitmap* bitmap, ReadyNode* node, alt_u16 priority)
+{
+    ReadyNode* head = bitmap->heads[priority];
+
+    node->priority = priority;
+    if (head == NULL) {
+        node->next = node;
+        node->prev = node;
+        bitmap->heads[priority] = node;
+        bitmap->leaves[priority >> 5] |= 1UL << (priority & 31);
+        bitmap->group |= 1UL << (priority >> 5);
+    } else {
+        // the back of the circle is just before the head
+        node->next = head;
+        node->prev = head->prev;
+        head->prev->next = node;
+        head->prev = node;
+    }
+}
+
+void readyBitmapRemove(ReadyBitmap* bitmap, ReadyNode* node)
+{
+    alt_u16 priority = node->priority;
+
+    if (node->next == node) {
+        bitmap->heads[priority] = NULL;
+        bitmap->leaves[priority >> 5] &= ~(1UL << (priority & 31));
+        if (bitmap->leaves[priority >> 5] == 0)
+            bitmap->group &= ~(1UL << (priority >> 5));
+    } else {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        if (bitmap->heads[priority] == node)
+            bitmap->heads[priority] = node->next;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+}
@@ -0,0 +1,79 @@
+#ifndef READY_BITMAP_H
+#define READY_BITMAP_H
+
+#include "alt_types.h"
+
+/*
+ * Ready list for more priorities than uC/OS-II has, with any number of
+ * entries per priority.
+ *
+ * The uC/OS-II ready list is one bit per priority in eight bytes, resolved
+ * with two OSUnMapTbl lookups, so it stops at 64 priorities with one task
+ * each. Here every priority has a bit in a 32 bit leaf word and every leaf
+ * word a bit in a 32 bit group word; the highest priority (the lowest
+ * number, as in uC/OS-II) is two count-trailing-zeros away, up to 1024
+ * priorities. The entries of a priority are kept in a circular list whose
+ * head is the one to run, and readyBitmapRotate() moves the head to the
+ * back for round-robin.
+ *
+ * The count is __builtin_ctz(). The Nios II has no instruction for it, so
+ * there it is a short libgcc routine, still without a loop over the
+ * priorities.
+ *
+ * Nothing is locked; callers that share a bitmap between tasks or with an
+ * interrupt hold a critical section around every call.
+ */
+
+#ifndef READY_BITMAP_LEVELS
+#define READY_BITMAP_LEVELS     256         // multiple of 32, at most 1024
+#endif
+
+#define READY_BITMAP_WORDS      (READY_BITMAP_LEVELS / 32)
+
+typedef struct ReadyNode {
+    struct ReadyNode* next;
+    struct ReadyNode* prev;
+    alt_u16 priority;
+} ReadyNode;
+
+typedef struct {
+    alt_u32 group;                              // bit n: leaves[n] is not 0
+    alt_u32 leaves[READY_BITMAP_WORDS];         // bit n of word w: priority 32 * w + n is ready
+    ReadyNode* heads[READY_BITMAP_LEVELS];      // next to run at each priority
+} ReadyBitmap;
+
+void  readyBitmapInit(ReadyBitmap* bitmap);
+
+/* Adds the node at the back of its priority, which must be below READY_BITMAP_LEVELS */
+void  readyBitmapInsert(ReadyBitmap* bitmap, ReadyNode* node, alt_u16 priority);
+
+/* Takes the node out, it must be in the bitmap */
+void  readyBitmapRemove(ReadyBitmap* bitmap, ReadyNode* node);
+
+/* Highest priority with a node in it, -1 when the bitmap is empty */
+static inline int readyBitmapHighestPriority(const ReadyBitmap* bitmap)
+{
+    int word;
+
+    if (bitmap->group == 0)
+        return -1;
+    word = __builtin_ctz(bitmap->group);
+    return (word << 5) + __builtin_ctz(bitmap->leaves[word]);
+}
+
+/* The node to run next, NULL when the bitmap is empty */
+static inline ReadyNode* readyBitmapHighest(const ReadyBitmap* bitmap)
+{
+    int priority = readyBitmapHighestPriority(bitmap);
+
+    return priority < 0 ? NULL : bitmap->heads[priority];
+}
+
+/* Moves the head of the priority to the back, the next node runs */
+static inline void readyBitmapRotate(ReadyBitmap* bitmap, alt_u16 priority)
+{
+    if (bitmap->heads[priority] != NULL)
+        bitmap->heads[priority] = bitmap->heads[priority]->next;
+}
+
+#endif /* READY_BITMAP_H */
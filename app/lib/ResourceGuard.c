@@ -0,0 +1,61 @@
+#include "ResourceGuard.h"
+#include "TaskStatistics.h"
+#include "TraceRecorder.h"
+
+INT8U resourceGuardCreate(ResourceGuard* guard, ResourceGuardMode mode, INT8U ceilingPriority)
+{
+    INT8U err = OS_ERR_NONE;
+
+    guard->mode = mode;
+    if (mode == RESOURCE_GUARD_MUTEX) {
+        guard->event = OSMutexCreate(ceilingPriority, &err);
+    } else {
+        guard->event = OSSemCreate(1); // Initialize with state = 1 (= available)
+        if (guard->event == NULL)
+            err = OS_ERR_PEVENT_NULL;
+    }
+    return err;
+}
+
+void resourceGuardDelete(ResourceGuard* guard)
+{
+    INT8U err;
+
+    if (guard->mode == RESOURCE_GUARD_MUTEX)
+        OSMutexDel(guard->event, OS_DEL_ALWAYS, &err);
+    else
+        OSSemDel(guard->event, OS_DEL_ALWAYS, &err);
+    guard->event = NULL;
+}
+
+INT8U resourceGuardLock(ResourceGuard* guard)
+{
+    INT8U err;
+
+    TRACE_RECORD_PEND(guard->event);
+    if (guard->mode == RESOURCE_GUARD_MUTEX) {
+        OSMutexPend(guard->event, 0, &err);
+        // the guard is held, the caller merely sits above the ceiling
+        if (err == OS_ERR_PIP_LOWER)
+            err = OS_ERR_NONE;
+    } else {
+        OSSemPend(guard->event, 0, &err);
+    }
+    TRACE_RECORD_PEND_DONE(guard->event, err);
+    return err;
+}
+
+void resourceGuardUnlock(ResourceGuard* guard)
+{
+    TRACE_RECORD_POST(guard->event);
+    TASK_STATS_POST(guard->event);
+    if (guard->mode == RESOURCE_GUARD_MUTEX)
+        OSMutexPost(guard->event);
+    else
+        OSSemPost(guard->event);
+}
+
+const char* resourceGuardModeName(ResourceGuardMode mode)
+{
+    return mode == RESOURCE_GUARD_MUTEX ? "mutex" : "semaphore";
+}
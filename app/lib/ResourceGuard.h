@@ -0,0 +1,51 @@
+#ifndef RESOURCE_GUARD_H
+#define RESOURCE_GUARD_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Lock for a resource shared between tasks of different priorities.
+ *
+ * In semaphore mode it is a binary OSSem, as the labs used originally: a
+ * low priority holder can be preempted by medium priority work while a
+ * high priority task waits, so that wait is unbounded. In mutex mode it is
+ * an OSMutex whose priority (the ceiling) is above every task using the
+ * guard; as soon as a higher priority task waits, the holder runs at the
+ * ceiling until it unlocks, so the wait is bounded by the critical section.
+ *
+ * Programs take the mode from RESOURCE_GUARD_DEFAULT_MODE, which is mutex
+ * mode when built with -DRESOURCE_GUARD_USE_MUTEX.
+ */
+
+typedef enum {
+    RESOURCE_GUARD_SEMAPHORE,
+    RESOURCE_GUARD_MUTEX
+} ResourceGuardMode;
+
+#ifdef RESOURCE_GUARD_USE_MUTEX
+#define RESOURCE_GUARD_DEFAULT_MODE     RESOURCE_GUARD_MUTEX
+#else
+#define RESOURCE_GUARD_DEFAULT_MODE     RESOURCE_GUARD_SEMAPHORE
+#endif
+
+typedef struct {
+    OS_EVENT* event;
+    ResourceGuardMode mode;
+} ResourceGuard;
+
+/*
+ * ceilingPriority is only used in mutex mode; it must be unused and higher
+ * (numerically lower) than the priority of every task taking the guard.
+ * Returns OS_ERR_NONE or the error of the failed create.
+ */
+INT8U resourceGuardCreate(ResourceGuard* guard, ResourceGuardMode mode, INT8U ceilingPriority);
+void  resourceGuardDelete(ResourceGuard* guard);
+
+/* Blocks until the guard is held; returns OS_ERR_NONE on success */
+INT8U resourceGuardLock(ResourceGuard* guard);
+void  resourceGuardUnlock(ResourceGuard* guard);
+
+const char* resourceGuardModeName(ResourceGuardMode mode);
+
+#endif /* RESOURCE_GUARD_H */
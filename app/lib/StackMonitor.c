@@ -0,0 +1,168 @@
+#include <stdio.h>
+
+#include "StackMonitor.h"
+
+static StackMonitorEntry stackMonitorEntries[STACK_MONITOR_MAX_TASKS];
+static int stackMonitorCount;
+static INT16U stackMonitorPeriod;
+static INT16U stackMonitorReportPeriods;
+static OS_STK stackMonitorStack[STACK_MONITOR_STACKSIZE];
+
+INT8U stackMonitorAdd(INT8U priority, const char* name, INT8U alertPercent)
+{
+    OS_CPU_SR cpu_sr = 0;
+    StackMonitorEntry* entry;
+    OS_TCB* ptcb;
+
+    if (stackMonitorCount == STACK_MONITOR_MAX_TASKS)
+        return OS_ERR_TASK_NOT_EXIST;
+
+    entry = &stackMonitorEntries[stackMonitorCount];
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBPrioTbl[priority];
+    if (ptcb == NULL || ptcb == OS_TCB_RESERVED) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_NOT_EXIST;
+    }
+    if ((ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) == 0) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_OPT;
+    }
+    entry->bottom = ptcb->OSTCBStkBottom;
+    entry->size   = ptcb->OSTCBStkSize;
+    OS_EXIT_CRITICAL();
+
+    entry->name         = name;
+    entry->priority     = priority;
+    entry->alertPercent = alertPercent;
+    entry->watermark    = entry->size;
+    entry->sampled      = 0;
+    entry->alerted      = 0;
+    stackMonitorCount++;
+    return OS_ERR_NONE;
+}
+
+static alt_u32 stackMonitorUsedPercent(const StackMonitorEntry* entry)
+{
+    return (entry->size - entry->watermark) * 100 / entry->size;
+}
+
+static void stackMonitorUpdate(StackMonitorEntry* entry)
+{
+    alt_u32 i;
+    alt_u32 zeros;
+    alt_u32 lowest;
+
+    if (!entry->sampled) {
+        // first sample: count the untouched entries from the bottom, as OSTaskStkChk does
+        for (i = 0; i < entry->size && entry->bottom[i] == 0; i++)
+            ;
+        entry->watermark = i;
+        entry->sampled = 1;
+        return;
+    }
+
+    // the stack only gets deeper, so look just below the last known watermark
+    i = entry->watermark;
+    lowest = entry->watermark;
+    zeros = 0;
+    while (i > 0 && zeros < STACK_MONITOR_ZERO_RUN) {
+        i--;
+        if (entry->bottom[i] != 0) {
+            lowest = i;
+            zeros = 0;
+        } else {
+            zeros++;
+        }
+    }
+    entry->watermark = lowest;
+}
+
+void stackMonitorSample(void)
+{
+    StackMonitorEntry* entry;
+    alt_u32 percent;
+    int i;
+
+    for (i = 0; i < stackMonitorCount; i++) {
+        entry = &stackMonitorEntries[i];
+        stackMonitorUpdate(entry);
+
+        percent = stackMonitorUsedPercent(entry);
+        if (entry->alerted || percent < entry->alertPercent)
+            continue;
+        entry->alerted = 1;
+        if (entry->watermark == 0)
+            printf("Stack alert: %s (priority %u) reached the bottom of its %lu byte stack\n",
+                    entry->name, entry->priority, (unsigned long)(entry->size * sizeof(OS_STK)));
+        else
+            printf("Stack alert: %s (priority %u) used %lu%% of its stack (%lu of %lu bytes)\n",
+                    entry->name, entry->priority, (unsigned long)percent,
+                    (unsigned long)((entry->size - entry->watermark) * sizeof(OS_STK)),
+                    (unsigned long)(entry->size * sizeof(OS_STK)));
+    }
+}
+
+void stackMonitorPrint(void)
+{
+    const StackMonitorEntry* entry;
+    int i;
+
+    printf("task                 prio   size (B)  high-water (B)  used\n");
+    for (i = 0; i < stackMonitorCount; i++) {
+        entry = &stackMonitorEntries[i];
+        printf("%-20s %4u  %9lu  %14lu  %3lu%%\n", entry->name, entry->priority,
+                (unsigned long)(entry->size * sizeof(OS_STK)),
+                (unsigned long)((entry->size - entry->watermark) * sizeof(OS_STK)),
+                (unsigned long)stackMonitorUsedPercent(entry));
+    }
+}
+
+const StackMonitorEntry* stackMonitorFind(INT8U priority)
+{
+    int i;
+
+    for (i = 0; i < stackMonitorCount; i++)
+        if (stackMonitorEntries[i].priority == priority)
+            return &stackMonitorEntries[i];
+    return NULL;
+}
+
+static void stackMonitorTask(void* pdata)
+{
+    INT16U samples = 0;
+
+    while (1) {
+        stackMonitorSample();
+
+        if (stackMonitorReportPeriods != 0 && ++samples == stackMonitorReportPeriods) {
+            stackMonitorPrint();
+            samples = 0;
+        }
+        OSTimeDly(stackMonitorPeriod);
+    }
+}
+
+INT8U stackMonitorStart(INT8U priority, INT16U periodTicks, INT16U reportPeriods)
+{
+    INT8U err;
+
+    stackMonitorPeriod = periodTicks > 0 ? periodTicks : 1;
+    stackMonitorReportPeriods = reportPeriods;
+
+    err = OSTaskCreateExt
+        ( stackMonitorTask,                                 // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &stackMonitorStack[STACK_MONITOR_STACKSIZE-1],    // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &stackMonitorStack[0],                            // Pointer to bottom of task stack
+          STACK_MONITOR_STACKSIZE,                          // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+    if (err == OS_ERR_NONE)
+        err = stackMonitorAdd(priority, "StackMonitor", 75);
+    return err;
+}
@@ -0,0 +1,61 @@
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Periodic stack-usage monitor.
+ *
+ * A low priority task wakes every periodTicks, updates the high-water mark
+ * of each registered task and prints an alert the first time a task's
+ * usage crosses its threshold (or reaches the bottom of its stack).
+ *
+ * Stacks must start out zeroed (OS_TASK_OPT_STK_CLR, or a static array
+ * created once) and grow downwards. The first sample of a task counts the
+ * untouched entries from the bottom like OSTaskStkChk; later samples only
+ * scan down from the last watermark and stop after
+ * STACK_MONITOR_ZERO_RUN zero entries in a row, so a sample costs a few
+ * words per task unless the stack actually grew. A frame that leaves more
+ * than that many words below the watermark unwritten is only seen once
+ * something beneath it is written.
+ */
+
+#define STACK_MONITOR_MAX_TASKS     16
+#define STACK_MONITOR_STACKSIZE     1024
+#define STACK_MONITOR_ZERO_RUN      32
+
+typedef struct {
+    const char* name;
+    OS_STK* bottom;
+    alt_u32 size;               // in OS_STK entries
+    alt_u32 watermark;          // untouched entries above the bottom, size before the first sample
+    INT8U priority;
+    INT8U alertPercent;
+    alt_u8 sampled;
+    alt_u8 alerted;
+} StackMonitorEntry;
+
+/*
+ * Registers the task at the given priority, which must have been created
+ * with OS_TASK_OPT_STK_CHK. alertPercent is the usage that raises an alert.
+ */
+INT8U stackMonitorAdd(INT8U priority, const char* name, INT8U alertPercent);
+
+/*
+ * Starts the monitor task, which also watches its own stack. Every
+ * reportPeriods samples it prints the table of stackMonitorPrint(), never
+ * when reportPeriods is 0.
+ */
+INT8U stackMonitorStart(INT8U priority, INT16U periodTicks, INT16U reportPeriods);
+
+/* Updates every watermark once and raises the alerts due */
+void  stackMonitorSample(void);
+
+/* Prints size, high-water mark and usage of every registered task */
+void  stackMonitorPrint(void);
+
+/* Entry of the task at the given priority, NULL when it is not registered */
+const StackMonitorEntry* stackMonitorFind(INT8U priority);
+
+#endif /* STACK_MONITOR_H */
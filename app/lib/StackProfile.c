@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "StackProfile.h"
+
+typedef struct {
+    const char* macroName;
+    OS_STK* bottom;
+    alt_u32 size;               // in OS_STK entries
+    INT8U priority;
+} StackProfileEntry;
+
+static StackProfileEntry stackProfileEntries[STACK_PROFILE_MAX_TASKS];
+static int stackProfileCount;
+static OS_STK stackProfileStack[STACK_PROFILE_STACKSIZE];
+
+INT8U stackProfileAdd(INT8U priority, const char* macroName)
+{
+    OS_CPU_SR cpu_sr = 0;
+    StackProfileEntry* entry;
+    OS_TCB* ptcb;
+    int i;
+
+    if (stackProfileCount == STACK_PROFILE_MAX_TASKS)
+        return OS_ERR_TASK_NOT_EXIST;
+
+    entry = &stackProfileEntries[stackProfileCount];
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBPrioTbl[priority];
+    if (ptcb == NULL || ptcb == OS_TCB_RESERVED) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_NOT_EXIST;
+    }
+    if ((ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) == 0) {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_TASK_OPT;
+    }
+    // tasks created again on the same stack are registered once
+    for (i = 0; i < stackProfileCount; i++) {
+        if (stackProfileEntries[i].bottom == ptcb->OSTCBStkBottom) {
+            OS_EXIT_CRITICAL();
+            return OS_ERR_NONE;
+        }
+    }
+    entry->bottom = ptcb->OSTCBStkBottom;
+    entry->size   = ptcb->OSTCBStkSize;
+    OS_EXIT_CRITICAL();
+
+    entry->macroName = macroName;
+    entry->priority  = priority;
+    stackProfileCount++;
+    return OS_ERR_NONE;
+}
+
+static alt_u32 stackProfileUsed(const StackProfileEntry* entry)
+{
+    alt_u32 nfree = 0;
+
+    while (nfree < entry->size && entry->bottom[nfree] == 0)
+        nfree++;
+    return entry->size - nfree;
+}
+
+/* Depth plus margin, rounded up so the stack keeps its alignment */
+static alt_u32 stackProfileSize(alt_u32 used)
+{
+    alt_u32 size = used * (100 + STACK_PROFILE_MARGIN_PERCENT) / 100 + STACK_PROFILE_MARGIN_ENTRIES;
+
+    return (size + STACK_PROFILE_ALIGN_ENTRIES - 1) / STACK_PROFILE_ALIGN_ENTRIES * STACK_PROFILE_ALIGN_ENTRIES;
+}
+
+void stackProfileWrite(const char* program)
+{
+    const StackProfileEntry* entry;
+    alt_u32 depth;
+    alt_u32 used;
+    alt_u32 size;
+    alt_u8 exhausted;
+    int i;
+    int j;
+
+    printf(STACK_PROFILE_PREFIX "/* Generated by the STACK_PROFILE build of %s after %lu ticks, do not edit */\n",
+            program, (unsigned long)OSTimeGet());
+    printf(STACK_PROFILE_PREFIX "#ifndef STACK_SIZES_H\n");
+    printf(STACK_PROFILE_PREFIX "#define STACK_SIZES_H\n");
+    printf(STACK_PROFILE_PREFIX "\n");
+    printf(STACK_PROFILE_PREFIX "#define STACK_SIZES_PROFILED\n");
+
+    for (i = 0; i < stackProfileCount; i++) {
+        entry = &stackProfileEntries[i];
+
+        // macros shared by several stacks are written once, at their first entry
+        for (j = 0; j < i; j++)
+            if (strcmp(stackProfileEntries[j].macroName, entry->macroName) == 0)
+                break;
+        if (j < i)
+            continue;
+
+        used = 0;
+        size = 0;
+        exhausted = 0;
+        for (j = i; j < stackProfileCount; j++) {
+            if (strcmp(stackProfileEntries[j].macroName, entry->macroName) != 0)
+                continue;
+            depth = stackProfileUsed(&stackProfileEntries[j]);
+            if (depth > used)
+                used = depth;
+            if (stackProfileEntries[j].size > size)
+                size = stackProfileEntries[j].size;
+            if (depth == stackProfileEntries[j].size)
+                exhausted = 1;
+        }
+
+        if (exhausted)
+            // the real depth is unknown, so double the stack and profile again
+            printf(STACK_PROFILE_PREFIX "#define %-28s %6lu  // exhausted all %lu entries, profile again\n",
+                    entry->macroName, (unsigned long)(2 * size), (unsigned long)size);
+        else
+            printf(STACK_PROFILE_PREFIX "#define %-28s %6lu  // %lu of %lu entries used\n",
+                    entry->macroName, (unsigned long)stackProfileSize(used),
+                    (unsigned long)used, (unsigned long)size);
+    }
+
+    printf(STACK_PROFILE_PREFIX "\n");
+    printf(STACK_PROFILE_PREFIX "#endif /* STACK_SIZES_H */\n");
+}
+
+/* True once no registered stack belongs to a live task any more */
+static alt_u8 stackProfileTasksDone(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    OS_TCB* ptcb;
+    alt_u8 done = 1;
+    int i;
+
+    OS_ENTER_CRITICAL();
+    for (i = 0; i < stackProfileCount; i++) {
+        ptcb = OSTCBPrioTbl[stackProfileEntries[i].priority];
+        if (ptcb != NULL && ptcb != OS_TCB_RESERVED && ptcb->OSTCBStkBottom == stackProfileEntries[i].bottom)
+            done = 0;
+    }
+    OS_EXIT_CRITICAL();
+    return done;
+}
+
+static void stackProfileTask(void* pdata)
+{
+    const char* program = pdata;
+    INT32U start = OSTimeGet();
+
+    while (!stackProfileTasksDone() && OSTimeGet() - start < STACK_PROFILE_TICKS)
+        OSTimeDly(STACK_PROFILE_POLL_TICKS);
+
+    stackProfileWrite(program);
+#ifdef __nios2__
+    // end of transmission, makes nios2-terminal quit
+    putchar('\004');
+#endif
+    fflush(stdout);
+    exit(0);
+}
+
+INT8U stackProfileStart(const char* program)
+{
+    return OSTaskCreateExt
+        ( stackProfileTask,                                 // Pointer to task code
+          (void*)program,                                   // Pointer to argument passed to task
+          &stackProfileStack[STACK_PROFILE_STACKSIZE-1],    // Pointer to top of task stack
+          STACK_PROFILE_PRIORITY,                           // Desired Task priority
+          STACK_PROFILE_PRIORITY,                           // Task ID
+          &stackProfileStack[0],                            // Pointer to bottom of task stack
+          STACK_PROFILE_STACKSIZE,                          // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
@@ -0,0 +1,65 @@
+#ifndef STACK_PROFILE_H
+#define STACK_PROFILE_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Stack-size profiler.
+ *
+ * A program built with -DSTACK_PROFILE registers each of its task stacks
+ * under the name of the macro that sizes it and starts the profiler. The
+ * profiler task waits until every registered task has been deleted or
+ * STACK_PROFILE_TICKS have passed, measures the deepest use of each stack
+ * and prints a header that defines every macro as that depth plus a
+ * margin, then ends the program. Each line of the header is prefixed with
+ * STACK_PROFILE_PREFIX so the build can pick it out of the console output
+ * (see "make stackprofile" in host/Makefile and ProjectMakefile).
+ *
+ * A later build force-includes the header; it defines STACK_SIZES_PROFILED
+ * so the program skips its own defaults. Stacks registered under the same
+ * macro (an array of worker stacks) get the deepest use of any of them.
+ * Profile again after changing what a task calls, the sizes have little
+ * slack by design.
+ *
+ * The depth is the count of untouched entries from the bottom, as
+ * OSTaskStkChk() reports, but taken from the stack memory itself so tasks
+ * that deleted themselves before the end are still measured. Tasks must be
+ * created with OS_TASK_OPT_STK_CHK and start out with a zeroed stack.
+ * Interrupts run on the interrupted task's stack, so the margin also
+ * covers an interrupt frame taken at the deepest point of the run.
+ */
+
+#define STACK_PROFILE_MAX_TASKS         64
+#define STACK_PROFILE_STACKSIZE         1024
+#define STACK_PROFILE_POLL_TICKS        10
+#define STACK_PROFILE_MARGIN_PERCENT    25
+#define STACK_PROFILE_MARGIN_ENTRIES    64      // interrupt frame and HAL handlers
+#define STACK_PROFILE_ALIGN_ENTRIES     8
+#define STACK_PROFILE_PREFIX            "stack-profile: "
+
+#ifndef STACK_PROFILE_TICKS
+#define STACK_PROFILE_TICKS             10000
+#endif
+
+// below every application task, above the system tasks
+#ifndef STACK_PROFILE_PRIORITY
+#define STACK_PROFILE_PRIORITY          (OS_LOWEST_PRIO - OS_N_SYS_TASKS)
+#endif
+
+/*
+ * Registers the stack of the task at the given priority, sized by the
+ * macro named macroName.
+ */
+INT8U stackProfileAdd(INT8U priority, const char* macroName);
+
+/*
+ * Starts the profiler task, which prints the header for the named program
+ * and exits once the registered tasks are gone or the time is up.
+ */
+INT8U stackProfileStart(const char* program);
+
+/* Prints the header for the stack use seen so far */
+void  stackProfileWrite(const char* program);
+
+#endif /* STACK_PROFILE_H */
@@ -0,0 +1,256 @@
+#include <stdio.h>
+
+#include "TaskStatistics.h"
+#include "Timestamp.h"
+
+#ifdef __nios2__
+#include "altera_avalon_performance_counter.h"
+#endif
+
+static TaskStatistics taskStats[OS_LOWEST_PRIO + 1];
+static const char* taskStatsNames[OS_LOWEST_PRIO + 1];
+static alt_u64 taskStatsSwitchedIn[OS_LOWEST_PRIO + 1];
+static alt_u64 taskStatsSwitchedOut[OS_LOWEST_PRIO + 1];
+static alt_u64 taskStatsReadied[OS_LOWEST_PRIO + 1];
+static alt_u8 taskStatsWaiting[OS_LOWEST_PRIO + 1];
+static alt_u64 taskStatsResetTime;
+static volatile alt_u8 taskStatsEnabled;
+static INT16U taskStatsPeriod;
+static OS_STK taskStatsStack[TASK_STATS_STACKSIZE];
+
+/*
+ * Tasks are kept under the priority they were created at, their task ID
+ * in these programs, so the time they run at a mutex ceiling stays theirs.
+ */
+static INT8U taskStatsIndex(const OS_TCB* ptcb)
+{
+    return ptcb->OSTCBId <= OS_LOWEST_PRIO ? (INT8U)ptcb->OSTCBId : ptcb->OSTCBPrio;
+}
+
+void taskStatsReset(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u64 now;
+    int i;
+
+    OS_ENTER_CRITICAL();
+    now = timestampNow();
+    for (i = 0; i <= OS_LOWEST_PRIO; i++) {
+        taskStats[i].runTime     = 0;
+        taskStats[i].activations = 0;
+        taskStats[i].preemptions = 0;
+        taskStats[i].wakeups     = 0;
+        taskStats[i].latencySum  = 0;
+        taskStats[i].latencyMax  = 0;
+    }
+    if (OSRunning == OS_TRUE)
+        taskStatsSwitchedIn[taskStatsIndex(OSTCBCur)] = now;
+    taskStatsResetTime = now;
+    OS_EXIT_CRITICAL();
+}
+
+void taskStatsInit(void)
+{
+#ifdef __nios2__
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+#endif
+    taskStatsReset();
+    taskStatsEnabled = 1;
+}
+
+void taskStatsName(INT8U priority, const char* name)
+{
+    if (priority <= OS_LOWEST_PRIO)
+        taskStatsNames[priority] = name;
+}
+
+/* Called with interrupts disabled, OSTCBCur is switched out for OSTCBHighRdy */
+void taskStatsSwitchHook(void)
+{
+    TaskStatistics* statistics;
+    alt_u64 latency;
+    alt_u64 now;
+    INT8U index;
+
+    if (!taskStatsEnabled)
+        return;
+    now = timestampNow();
+
+    // the first switch, from OSStart(), has no task to switch out
+    if (OSTCBCur != OSTCBHighRdy) {
+        index = taskStatsIndex(OSTCBCur);
+        taskStats[index].runTime += now - taskStatsSwitchedIn[index];
+        if ((OSRdyTbl[OSTCBCur->OSTCBY] & OSTCBCur->OSTCBBitX) != 0) {
+            taskStats[index].preemptions++;
+        } else {
+            taskStatsWaiting[index] = 1;
+            taskStatsSwitchedOut[index] = now;
+        }
+    }
+
+    index = taskStatsIndex(OSTCBHighRdy);
+    statistics = &taskStats[index];
+    statistics->activations++;
+    taskStatsSwitchedIn[index] = now;
+    if (taskStatsWaiting[index]) {
+        taskStatsWaiting[index] = 0;
+        if (taskStatsReadied[index] >= taskStatsSwitchedOut[index]) {
+            latency = now - taskStatsReadied[index];
+            statistics->wakeups++;
+            statistics->latencySum += latency;
+            if (latency > statistics->latencyMax)
+                statistics->latencyMax = latency;
+        }
+    }
+}
+
+/*
+ * Runs before the tick counts the delays down. Every task still waiting
+ * for time is stamped, so the stamp left once it is readied is the tick
+ * that readied it.
+ */
+void taskStatsTickHook(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    OS_TCB* ptcb;
+    alt_u64 now;
+
+    if (!taskStatsEnabled)
+        return;
+
+    OS_ENTER_CRITICAL();
+    now = timestampNow();
+    for (ptcb = OSTCBList; ptcb != NULL; ptcb = ptcb->OSTCBNext)
+        if (ptcb->OSTCBDly != 0)
+            taskStatsReadied[taskStatsIndex(ptcb)] = now;
+    OS_EXIT_CRITICAL();
+}
+
+/* A post readies the highest priority waiter, as OS_EventTaskRdy() picks it */
+void taskStatsPost(OS_EVENT* event)
+{
+    OS_CPU_SR cpu_sr = 0;
+    INT8U y;
+    INT8U priority;
+    OS_TCB* ptcb;
+
+    if (!taskStatsEnabled || event == NULL)
+        return;
+
+    OS_ENTER_CRITICAL();
+    if (event->OSEventGrp != 0) {
+#if OS_LOWEST_PRIO <= 63
+        y = OSUnMapTbl[event->OSEventGrp];
+        priority = (INT8U)((y << 3) + OSUnMapTbl[event->OSEventTbl[y]]);
+#else
+        if ((event->OSEventGrp & 0xFF) != 0)
+            y = OSUnMapTbl[event->OSEventGrp & 0xFF];
+        else
+            y = OSUnMapTbl[(event->OSEventGrp >> 8) & 0xFF] + 8;
+        if ((event->OSEventTbl[y] & 0xFF) != 0)
+            priority = (INT8U)((y << 4) + OSUnMapTbl[event->OSEventTbl[y] & 0xFF]);
+        else
+            priority = (INT8U)((y << 4) + OSUnMapTbl[(event->OSEventTbl[y] >> 8) & 0xFF] + 8);
+#endif
+        ptcb = OSTCBPrioTbl[priority];
+        if (ptcb != NULL && ptcb != OS_TCB_RESERVED)
+            taskStatsReadied[taskStatsIndex(ptcb)] = timestampNow();
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * Every waiter is stamped, not just the ones the post satisfies; the others
+ * are stamped again by the post that does ready them.
+ */
+void taskStatsFlagPost(OS_FLAG_GRP* group)
+{
+    OS_CPU_SR cpu_sr = 0;
+    OS_FLAG_NODE* node;
+    alt_u64 now;
+
+    if (!taskStatsEnabled || group == NULL)
+        return;
+
+    OS_ENTER_CRITICAL();
+    now = timestampNow();
+    for (node = (OS_FLAG_NODE*)group->OSFlagWaitList; node != NULL; node = (OS_FLAG_NODE*)node->OSFlagNodeNext)
+        taskStatsReadied[taskStatsIndex((OS_TCB*)node->OSFlagNodeTCB)] = now;
+    OS_EXIT_CRITICAL();
+}
+
+int taskStatsGet(INT8U priority, TaskStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    if (priority > OS_LOWEST_PRIO)
+        return 0;
+
+    OS_ENTER_CRITICAL();
+    *statistics = taskStats[priority];
+    if (OSRunning == OS_TRUE && taskStatsIndex(OSTCBCur) == priority)
+        statistics->runTime += timestampNow() - taskStatsSwitchedIn[priority];
+    OS_EXIT_CRITICAL();
+
+    return statistics->activations != 0 || statistics->runTime != 0;
+}
+
+alt_u64 taskStatsElapsed(void)
+{
+    return timestampNow() - taskStatsResetTime;
+}
+
+void taskStatsPrint(void)
+{
+    TaskStatistics statistics;
+    alt_u64 elapsed = taskStatsElapsed();
+    double usPerTick = 1e6 / timestampFrequency();
+    char name[16];
+    const char* shown;
+    int i;
+
+    printf("Task statistics over %.1f ms\n", elapsed * usPerTick / 1000);
+    printf("task                 prio   cpu %%  activations  preemptions  wakeups  latency mean (us)   max (us)\n");
+    for (i = 0; i <= OS_LOWEST_PRIO; i++) {
+        if (!taskStatsGet(i, &statistics))
+            continue;
+        shown = taskStatsNames[i];
+        if (shown == NULL) {
+            snprintf(name, sizeof(name), i == OS_TASK_IDLE_PRIO ? "idle" : "task %d", i);
+            shown = name;
+        }
+        printf("%-20s %4d  %6.2f  %11lu  %11lu  %7lu  %17.2f  %9.2f\n", shown, i,
+                elapsed > 0 ? 100.0 * statistics.runTime / elapsed : 0.0,
+                (unsigned long)statistics.activations, (unsigned long)statistics.preemptions,
+                (unsigned long)statistics.wakeups,
+                statistics.wakeups > 0 ? statistics.latencySum * usPerTick / statistics.wakeups : 0.0,
+                statistics.latencyMax * usPerTick);
+    }
+}
+
+static void taskStatsTask(void* pdata)
+{
+    while (1) {
+        OSTimeDly(taskStatsPeriod);
+        taskStatsPrint();
+        taskStatsReset();
+    }
+}
+
+INT8U taskStatsStart(INT8U priority, INT16U periodTicks)
+{
+    taskStatsPeriod = periodTicks > 0 ? periodTicks : 1;
+
+    return OSTaskCreateExt
+        ( taskStatsTask,                                    // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &taskStatsStack[TASK_STATS_STACKSIZE-1],          // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &taskStatsStack[0],                               // Pointer to bottom of task stack
+          TASK_STATS_STACKSIZE,                             // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
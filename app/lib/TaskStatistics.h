@@ -0,0 +1,85 @@
+#ifndef TASK_STATISTICS_H
+#define TASK_STATISTICS_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Per-task CPU and scheduling statistics.
+ *
+ * The program calls taskStatsSwitchHook() and taskStatsTickHook() from its
+ * App_TaskSwHook() and App_TimeTickHook(). Every context switch charges
+ * the time since the previous one to the task switched out and counts an
+ * activation of the task switched in. A task switched out while it is
+ * still ready was preempted.
+ *
+ * A task switched out while it waits is stamped with the time it becomes
+ * ready again, and the time from that stamp to its switch in is its
+ * ready-to-running latency. Ticks stamp every task waiting for time, and
+ * the TASK_STATS_POST macros in the instrumented libraries stamp the task
+ * a post is about to ready before posting, as the kernel itself cannot be
+ * hooked. A wakeup without a stamp, such as a post outside of the
+ * instrumented libraries to a task pending without a timeout, is not
+ * counted. Builds without -DTASK_STATISTICS compile the macros to nothing.
+ *
+ * Interrupts are charged to the task they interrupt, and times are in
+ * Timestamp.h ticks. On the board taskStatsInit() starts the performance
+ * counter the timestamps are read from.
+ */
+
+#define TASK_STATS_STACKSIZE        1024
+
+typedef struct {
+    alt_u64 runTime;            // time spent running
+    alt_u32 activations;        // times switched in
+    alt_u32 preemptions;        // times switched out while still ready
+    alt_u32 wakeups;            // ready-to-running latencies measured
+    alt_u64 latencySum;
+    alt_u64 latencyMax;
+} TaskStatistics;
+
+#ifdef TASK_STATISTICS
+#define TASK_STATS_POST(event)          taskStatsPost(event)
+#define TASK_STATS_FLAG_POST(group)     taskStatsFlagPost(group)
+#else
+#define TASK_STATS_POST(event)
+#define TASK_STATS_FLAG_POST(group)
+#endif
+
+/* Clears the statistics and starts collecting them */
+void  taskStatsInit(void);
+
+/* Name shown for the task at the given priority in the report */
+void  taskStatsName(INT8U priority, const char* name);
+
+/* To be called from App_TaskSwHook() and App_TimeTickHook() */
+void  taskStatsSwitchHook(void);
+void  taskStatsTickHook(void);
+
+/* Stamp the waiters a post to the event or flag group will ready */
+void  taskStatsPost(OS_EVENT* event);
+void  taskStatsFlagPost(OS_FLAG_GRP* group);
+
+/* Clears the statistics of every task, the time of a report starts over */
+void  taskStatsReset(void);
+
+/*
+ * Copies the statistics of the task at the given priority, including the
+ * run it is in the middle of. Returns 0 when it did not run since the
+ * last reset.
+ */
+int   taskStatsGet(INT8U priority, TaskStatistics* statistics);
+
+/* Time since the last reset */
+alt_u64 taskStatsElapsed(void);
+
+/* Prints CPU share, activations, preemptions and latency of every task that ran */
+void  taskStatsPrint(void);
+
+/*
+ * Starts a task that prints the statistics and resets them every
+ * periodTicks, so each report covers one period.
+ */
+INT8U taskStatsStart(INT8U priority, INT16U periodTicks);
+
+#endif /* TASK_STATISTICS_H */
@@ -0,0 +1,30 @@
+#include "TaskTable.h"
+#include "StackProfile.h"
+
+INT8U taskTableCreate(const TaskTableEntry* table, int count)
+{
+    const TaskTableEntry* entry;
+    INT8U err;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        entry = &table[i];
+        err = OSTaskCreateExt
+            ( entry->task,                                  // Pointer to task code
+              entry->pdata,                                 // Pointer to argument passed to task
+              &entry->stack[entry->stackSize-1],            // Pointer to top of task stack
+              entry->priority,                              // Desired Task priority
+              entry->priority,                              // Task ID
+              &entry->stack[0],                             // Pointer to bottom of task stack
+              entry->stackSize,                             // Stacksize
+              NULL,                                         // Pointer to user supplied memory (not needed)
+              entry->options                                // Stack checking and clearing as listed
+            );
+        if (err != OS_ERR_NONE)
+            return err;
+#ifdef STACK_PROFILE
+        stackProfileAdd(entry->priority, entry->stackSizeMacro);
+#endif
+    }
+    return OS_ERR_NONE;
+}
@@ -0,0 +1,85 @@
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#include "includes.h"
+#include "MemoryPlacement.h"
+
+/*
+ * Static task table.
+ *
+ * A program lists the tasks it starts with once, as a macro that applies
+ * its argument to every task:
+ *
+ *   #define APP_TASKS(TASK) \
+ *       TASK(Task1, task1, NULL, TASK1_PRIORITY, TASK1_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+ *       TASK(Task2, task2, NULL, TASK2_PRIORITY, TASK2_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+ *
+ *   TASK_TABLE(APP_TASKS);
+ *
+ * with name, task code, argument, priority (also the task ID), stack size
+ * and OSTaskCreateExt() options per task. TASK_TABLE() defines the stacks
+ * as the members of one struct, taskTableStacks, so they are contiguous
+ * and sized where the task is listed, and the table taskTable[] of
+ * taskTableSize entries that taskTableCreate() creates the tasks from.
+ *
+ * Priorities are checked when the program is compiled: a priority listed
+ * twice is a duplicate case value in taskTableCheckPriorities(), and one
+ * that is taken by the system tasks makes a negative array size.
+ *
+ * The stack size is given as a macro, as the stack profiler registers the
+ * stack under the macro's name. When the build defines
+ * TASK_TABLE_FAST_PRIORITY (a placement profile does, see
+ * lib/MemoryPlacement.h), the stacks of the tasks of that priority and
+ * above go in a second struct, taskTableFastStacks, that is FAST_DATA.
+ * Each stack is a member of both structs, sized 0 in the one it is not in.
+ */
+
+typedef struct {
+    const char* name;
+    void      (*task)(void* pdata);
+    void*       pdata;
+    OS_STK*     stack;              // bottom of the stack
+    INT32U      stackSize;
+    INT8U       priority;
+    INT16U      options;
+    const char* stackSizeMacro;     // name of the macro that sizes the stack
+} TaskTableEntry;
+
+#ifndef TASK_TABLE_FAST_PRIORITY
+#define TASK_TABLE_FAST_PRIORITY    -1
+#endif
+
+#define TASK_TABLE_FAST(priority)   ((priority) <= TASK_TABLE_FAST_PRIORITY)
+
+#define TASK_TABLE_STACK(name, task, pdata, priority, stackSize, options) \
+    OS_STK name[TASK_TABLE_FAST(priority) ? 0 : (stackSize)];
+
+#define TASK_TABLE_FAST_STACK(name, task, pdata, priority, stackSize, options) \
+    OS_STK name[TASK_TABLE_FAST(priority) ? (stackSize) : 0];
+
+#define TASK_TABLE_RANGE_CHECK(name, task, pdata, priority, stackSize, options) \
+    typedef char taskTablePriorityOf##name[(priority) <= OS_LOWEST_PRIO - OS_N_SYS_TASKS ? 1 : -1];
+
+#define TASK_TABLE_CASE(name, task, pdata, priority, stackSize, options) \
+    case priority:
+
+#define TASK_TABLE_ENTRY(name, task, pdata, priority, stackSize, options) \
+    { #name, task, pdata, TASK_TABLE_FAST(priority) ? taskTableFastStacks.name : taskTableStacks.name, \
+      stackSize, priority, options, #stackSize },
+
+#define TASK_TABLE(TASKS) \
+    struct TaskTableStacks { TASKS(TASK_TABLE_STACK) } taskTableStacks; \
+    struct TaskTableFastStacks { TASKS(TASK_TABLE_FAST_STACK) } taskTableFastStacks FAST_DATA; \
+    TASKS(TASK_TABLE_RANGE_CHECK) \
+    static inline void taskTableCheckPriorities(void) { switch (0) { TASKS(TASK_TABLE_CASE) break; } } \
+    const TaskTableEntry taskTable[] = { TASKS(TASK_TABLE_ENTRY) }; \
+    const int taskTableSize = sizeof(taskTable) / sizeof(taskTable[0])
+
+/*
+ * Creates every task of the table, in the order listed. Stops at the first
+ * task that cannot be created and returns its error, OS_ERR_NONE otherwise.
+ * Builds with -DSTACK_PROFILE also register each stack with the profiler.
+ */
+INT8U taskTableCreate(const TaskTableEntry* table, int count);
+
+#endif /* TASK_TABLE_H */
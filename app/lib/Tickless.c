@@ -0,0 +1,202 @@
+#include "Tickless.h"
+
+static TicklessStatistics ticklessBase;
+
+#ifdef __nios2__
+
+#include "altera_avalon_timer_regs.h"
+
+#define TICKLESS_TICK_CYCLES    (TICKLESS_TIMER_FREQ / OS_TICKS_PER_SEC)
+#define TICKLESS_RUN            (ALTERA_AVALON_TIMER_CONTROL_ITO_MSK | \
+                                 ALTERA_AVALON_TIMER_CONTROL_CONT_MSK | \
+                                 ALTERA_AVALON_TIMER_CONTROL_START_MSK)
+
+static alt_u8 ticklessEnabled;
+static alt_u32 ticklessTimerIrqs;
+static alt_u32 ticklessIdleTimerIrqs;
+
+// ticks the programmed period covers, 1 while the timer ticks as usual
+static alt_u32 ticklessPeriodTicks = 1;
+// the period is not one tick long and must be restored at the next interrupt
+static alt_u8 ticklessPeriodChanged;
+
+/* Writing the period stops the timer, it is started again from the new value */
+static void ticklessSetPeriod(alt_u32 cycles)
+{
+    IOWR_ALTERA_AVALON_TIMER_PERIODL(TICKLESS_TIMER_BASE, (cycles - 1) & 0xffff);
+    IOWR_ALTERA_AVALON_TIMER_PERIODH(TICKLESS_TIMER_BASE, (cycles - 1) >> 16);
+    IOWR_ALTERA_AVALON_TIMER_CONTROL(TICKLESS_TIMER_BASE, TICKLESS_RUN);
+}
+
+static alt_u32 ticklessRemainingCycles(void)
+{
+    IOWR_ALTERA_AVALON_TIMER_SNAPL(TICKLESS_TIMER_BASE, 0);
+    return IORD_ALTERA_AVALON_TIMER_SNAPL(TICKLESS_TIMER_BASE) |
+           (IORD_ALTERA_AVALON_TIMER_SNAPH(TICKLESS_TIMER_BASE) << 16);
+}
+
+/* Shortest delay or timeout of any task, 0 when none is waiting on time */
+static alt_u32 ticklessNextDelay(void)
+{
+    OS_TCB* ptcb;
+    alt_u32 next = 0;
+
+    for (ptcb = OSTCBList; ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO; ptcb = ptcb->OSTCBNext)
+        if (ptcb->OSTCBDly != 0 && (next == 0 || ptcb->OSTCBDly < next))
+            next = ptcb->OSTCBDly;
+    return next;
+}
+
+/*
+ * Accounts for ticks that went by without an interrupt, as OSTimeTick()
+ * would have one at a time. Called with interrupts disabled.
+ */
+static void ticklessAnnounce(alt_u32 ticks)
+{
+    OS_TCB* ptcb;
+
+    if (ticks == 0)
+        return;
+
+    OSTime += ticks;
+    for (ptcb = OSTCBList; ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO; ptcb = ptcb->OSTCBNext) {
+        if (ptcb->OSTCBDly == 0)
+            continue;
+        if (ptcb->OSTCBDly > ticks) {
+            ptcb->OSTCBDly -= ticks;
+            continue;
+        }
+        ptcb->OSTCBDly = 0;
+        if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+            ptcb->OSTCBStat &= ~(INT8U)OS_STAT_PEND_ANY;
+            ptcb->OSTCBStatPend = OS_STAT_PEND_TO;
+        } else {
+            ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+        }
+        if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {
+            OSRdyGrp |= ptcb->OSTCBBitY;
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+        }
+    }
+}
+
+void ticklessIdleHook(void)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u32 ticks;
+
+    if (!ticklessEnabled)
+        return;
+
+    OS_ENTER_CRITICAL();
+    if (ticklessPeriodTicks == 1 && !ticklessPeriodChanged) {
+        ticks = ticklessNextDelay();
+        if (ticks > TICKLESS_MAX_TICKS || ticks == 0)
+            ticks = TICKLESS_MAX_TICKS;
+        if (ticks > 1) {
+            // the current tick runs out as planned, the following ones are skipped
+            ticklessSetPeriod(ticklessRemainingCycles() + (ticks - 1) * TICKLESS_TICK_CYCLES);
+            ticklessPeriodTicks = ticks;
+            ticklessPeriodChanged = 1;
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+ * A task leaves idle before the long period ran out: an early wakeup. The
+ * period ends on a tick, so the ticks still ahead are the whole multiples
+ * of a tick in the remaining count.
+ */
+void ticklessSwitchHook(void)
+{
+    alt_u32 remaining;
+    alt_u32 partial;
+
+    if (ticklessPeriodTicks == 1 || OSTCBCur->OSTCBPrio != OS_TASK_IDLE_PRIO)
+        return;
+
+    remaining = ticklessRemainingCycles();
+    partial = remaining % TICKLESS_TICK_CYCLES;
+    ticklessAnnounce(ticklessPeriodTicks - remaining / TICKLESS_TICK_CYCLES - 1);
+    // finish the tick in progress, the next interrupt restores the period
+    ticklessSetPeriod(partial > 0 ? partial : TICKLESS_TICK_CYCLES);
+    ticklessPeriodTicks = 1;
+}
+
+void ticklessTickHook(void)
+{
+    ticklessTimerIrqs++;
+    if (OSTCBCur->OSTCBPrio == OS_TASK_IDLE_PRIO)
+        ticklessIdleTimerIrqs++;
+
+    if (!ticklessPeriodChanged)
+        return;
+
+    ticklessSetPeriod(TICKLESS_TICK_CYCLES);
+    // OSTimeTick() accounts for the last tick of the period itself
+    ticklessAnnounce(ticklessPeriodTicks - 1);
+    ticklessPeriodTicks = 1;
+    ticklessPeriodChanged = 0;
+}
+
+void ticklessEnable(alt_u8 enable)
+{
+    ticklessEnabled = enable;
+}
+
+static void ticklessCounts(TicklessStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    statistics->ticks = OSTime;
+    statistics->timerInterrupts = ticklessTimerIrqs;
+    statistics->idleTimerInterrupts = ticklessIdleTimerIrqs;
+    OS_EXIT_CRITICAL();
+}
+
+#else
+
+void ticklessIdleHook(void)
+{
+}
+
+void ticklessSwitchHook(void)
+{
+}
+
+void ticklessTickHook(void)
+{
+}
+
+void ticklessEnable(alt_u8 enable)
+{
+    OSHostTicklessSet(enable ? OS_TRUE : OS_FALSE);
+}
+
+static void ticklessCounts(TicklessStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    statistics->ticks = OSTime;
+    statistics->timerInterrupts = OSHostTimerIrqCtr;
+    statistics->idleTimerInterrupts = OSHostIdleTimerIrqCtr;
+    OS_EXIT_CRITICAL();
+}
+
+#endif
+
+void ticklessGetStatistics(TicklessStatistics* statistics)
+{
+    ticklessCounts(statistics);
+    statistics->ticks -= ticklessBase.ticks;
+    statistics->timerInterrupts -= ticklessBase.timerInterrupts;
+    statistics->idleTimerInterrupts -= ticklessBase.idleTimerInterrupts;
+}
+
+void ticklessResetStatistics(void)
+{
+    ticklessCounts(&ticklessBase);
+}
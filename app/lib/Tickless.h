@@ -0,0 +1,51 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Tickless idle: while only the idle task can run, the system timer is
+ * programmed for the tick on which the earliest delay or pend timeout runs
+ * out instead of interrupting on every tick. The skipped ticks are
+ * accounted for at once when the timer fires, so OSTimeGet() and every
+ * delay stay exact; a task readied early by another interrupt finds the
+ * whole ticks gone by accounted for and the tick restarted. While any task
+ * runs the timer ticks as usual.
+ *
+ * On the board the timer is the one in hal.sys_clk_timer (ProjectMakefile),
+ * TICKLESS_TIMER_BASE and TICKLESS_TIMER_FREQ name it. The program calls
+ * ticklessIdleHook(), ticklessSwitchHook() and ticklessTickHook() from its
+ * App_TaskIdleHook(), App_TaskSwHook() and App_TimeTickHook(). The HAL's
+ * own alt_nticks() does not see the skipped ticks, use OSTimeGet(). On the
+ * host the port does the same from its idle task and the hooks do nothing.
+ */
+
+#ifdef __nios2__
+#ifndef TICKLESS_TIMER_BASE
+#define TICKLESS_TIMER_BASE         TIMER_0_BASE
+#define TICKLESS_TIMER_FREQ         TIMER_0_FREQ
+#endif
+#endif
+
+// longest single sleep, keeps the period in the 32 bit timer register
+#define TICKLESS_MAX_TICKS          1000
+
+typedef struct {
+    alt_u32 ticks;                  // OS ticks gone by
+    alt_u32 timerInterrupts;        // system timer interrupts taken
+    alt_u32 idleTimerInterrupts;    // ... of which while the idle task ran
+} TicklessStatistics;
+
+/* Switches tickless idle on or off, takes effect the next time idle runs */
+void ticklessEnable(alt_u8 enable);
+
+/* Counts since the last ticklessResetStatistics() */
+void ticklessGetStatistics(TicklessStatistics* statistics);
+void ticklessResetStatistics(void);
+
+void ticklessIdleHook(void);
+void ticklessSwitchHook(void);
+void ticklessTickHook(void);
+
+#endif /* TICKLESS_H */
@@ -0,0 +1,60 @@
+#include "TimedWait.h"
+#include "Timestamp.h"
+
+#define TIMED_WAIT_TICK_US  (1000000uL / OS_TICKS_PER_SEC)
+
+INT16U timedWaitTicks(alt_u32 timeoutUs)
+{
+    alt_u32 ticks;
+
+    if (timeoutUs == 0)
+        return 0;
+
+    ticks = (timeoutUs + TIMED_WAIT_TICK_US - 1) / TIMED_WAIT_TICK_US;
+    // the first tick can come at any point of the current period
+    ticks++;
+    return ticks > 0xffff ? 0xffff : (INT16U)ticks;
+}
+
+static void timedWaitDone(alt_u64 start, alt_u32* waitedUs)
+{
+    if (waitedUs != NULL)
+        *waitedUs = (alt_u32)((timestampNow() - start) * 1000000 / timestampFrequency());
+}
+
+INT8U timedSemPend(OS_EVENT* semaphore, alt_u32 timeoutUs, alt_u32* waitedUs)
+{
+    alt_u64 start = timestampNow();
+    INT8U err;
+
+    OSSemPend(semaphore, timedWaitTicks(timeoutUs), &err);
+    timedWaitDone(start, waitedUs);
+    return err;
+}
+
+INT8U timedQPend(OS_EVENT* queue, alt_u32 timeoutUs, void** message, alt_u32* waitedUs)
+{
+    alt_u64 start = timestampNow();
+    void* received;
+    INT8U err;
+
+    received = OSQPend(queue, timedWaitTicks(timeoutUs), &err);
+    timedWaitDone(start, waitedUs);
+    if (message != NULL)
+        *message = received;
+    return err;
+}
+
+INT8U timedFlagPend(OS_FLAG_GRP* group, OS_FLAGS flags, INT8U waitType, alt_u32 timeoutUs,
+                    OS_FLAGS* ready, alt_u32* waitedUs)
+{
+    alt_u64 start = timestampNow();
+    OS_FLAGS readyFlags;
+    INT8U err;
+
+    readyFlags = OSFlagPend(group, flags, waitType, timedWaitTicks(timeoutUs), &err);
+    timedWaitDone(start, waitedUs);
+    if (ready != NULL)
+        *ready = readyFlags;
+    return err;
+}
@@ -0,0 +1,32 @@
+#ifndef TIMED_WAIT_H
+#define TIMED_WAIT_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Pends with a bounded timeout in microseconds that report how long the
+ * task actually waited.
+ *
+ * The timeout is rounded up to whole ticks plus one, as the first tick can
+ * come at any point of the current period, so a pend never times out before
+ * timeoutUs has passed; 0 still waits for ever. The wait is
+ * measured with timestampNow() from the call to the return, so it includes
+ * the time the task spent ready but preempted after the event arrived. A
+ * NULL waitedUs is allowed. The return value is the uC/OS-II error code,
+ * OS_ERR_TIMEOUT when the time ran out.
+ */
+
+/* Pend timeout in ticks for the given microseconds; 0 for no timeout */
+INT16U timedWaitTicks(alt_u32 timeoutUs);
+
+INT8U  timedSemPend(OS_EVENT* semaphore, alt_u32 timeoutUs, alt_u32* waitedUs);
+
+/* The message is returned through message, NULL on a timeout */
+INT8U  timedQPend(OS_EVENT* queue, alt_u32 timeoutUs, void** message, alt_u32* waitedUs);
+
+/* The flags that made the task ready are returned through ready */
+INT8U  timedFlagPend(OS_FLAG_GRP* group, OS_FLAGS flags, INT8U waitType, alt_u32 timeoutUs,
+                     OS_FLAGS* ready, alt_u32* waitedUs);
+
+#endif /* TIMED_WAIT_H */
@@ -0,0 +1,273 @@
+#include "TimerWheel.h"
+#include "Timestamp.h"
+
+static TimerWheel serviceWheel;
+static OS_EVENT* serviceWakeSemaphore;
+static volatile alt_u8 serviceIdle;
+static TimerServiceStatistics serviceStatistics;
+static OS_STK timerServiceStack[TIMER_SERVICE_STACKSIZE];
+
+void timerInit(Timer* timer, void (*callback)(Timer* timer, void* arg), void* arg)
+{
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->semaphore = NULL;
+}
+
+void timerInitSemaphore(Timer* timer, OS_EVENT* semaphore)
+{
+    timerInit(timer, NULL, NULL);
+    timer->semaphore = semaphore;
+}
+
+void timerFire(Timer* timer)
+{
+    if (timer->callback != NULL)
+        timer->callback(timer, timer->arg);
+    else if (timer->semaphore != NULL)
+        OSSemPost(timer->semaphore);
+}
+
+static void timerLink(Timer** head, Timer* timer)
+{
+    timer->next = *head;
+    if (*head != NULL)
+        (*head)->pprev = &timer->next;
+    *head = timer;
+    timer->pprev = head;
+}
+
+static void timerUnlink(Timer* timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != NULL)
+        timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/* Files the timer in the slot of the lowest level its time is within range of */
+static void timerWheelFile(TimerWheel* wheel, Timer* timer)
+{
+    alt_u32 delta = timer->expires - wheel->now;
+    int level = 0;
+
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= 1UL << (TIMER_WHEEL_BITS * (level + 1)))
+        level++;
+    timerLink(&wheel->slots[level][(timer->expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK], timer);
+}
+
+void timerWheelInit(TimerWheel* wheel, alt_u32 now)
+{
+    int level;
+    int slot;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+        for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+            wheel->slots[level][slot] = NULL;
+    wheel->expired = NULL;
+    wheel->now = now;
+    wheel->armed = 0;
+}
+
+void timerWheelAdd(TimerWheel* wheel, Timer* timer, alt_u32 delayTicks, alt_u32 periodTicks)
+{
+    if (timer->pprev != NULL)
+        timerUnlink(timer);
+    else
+        wheel->armed++;
+
+    if (delayTicks == 0)
+        delayTicks = 1;
+    if (delayTicks > TIMER_WHEEL_MAX_DELAY)
+        delayTicks = TIMER_WHEEL_MAX_DELAY;
+    if (periodTicks > TIMER_WHEEL_MAX_DELAY)
+        periodTicks = TIMER_WHEEL_MAX_DELAY;
+    timer->expires = wheel->now + delayTicks;
+    timer->period = periodTicks;
+    timerWheelFile(wheel, timer);
+}
+
+void timerWheelRemove(TimerWheel* wheel, Timer* timer)
+{
+    if (timer->pprev == NULL)
+        return;
+    timerUnlink(timer);
+    wheel->armed--;
+}
+
+static void timerWheelCascade(TimerWheel* wheel, int level)
+{
+    Timer** head = &wheel->slots[level][(wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+    Timer* timer;
+
+    while ((timer = *head) != NULL) {
+        timerUnlink(timer);
+        timerWheelFile(wheel, timer);
+    }
+}
+
+void timerWheelAdvance(TimerWheel* wheel)
+{
+    Timer** head;
+    Timer** tail;
+    int level;
+
+    wheel->now++;
+
+    // when a level comes round to slot 0, the next slot of the level above is due
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if (((wheel->now >> (TIMER_WHEEL_BITS * (level - 1))) & TIMER_WHEEL_MASK) != 0)
+            break;
+        timerWheelCascade(wheel, level);
+    }
+
+    head = &wheel->slots[0][wheel->now & TIMER_WHEEL_MASK];
+    if (*head == NULL)
+        return;
+
+    // behind the timers of a tick not taken yet, when the caller is late
+    for (tail = &wheel->expired; *tail != NULL; tail = &(*tail)->next)
+        ;
+    *tail = *head;
+    (*head)->pprev = tail;
+    *head = NULL;
+}
+
+Timer* timerWheelExpire(TimerWheel* wheel)
+{
+    Timer* timer = wheel->expired;
+
+    if (timer == NULL)
+        return NULL;
+    timerUnlink(timer);
+
+    if (timer->period == 0) {
+        wheel->armed--;
+    } else {
+        // one period after the time it was due, or the next tick when that is gone
+        timer->expires += timer->period;
+        if ((alt_32)(timer->expires - wheel->now) <= 0)
+            timer->expires = wheel->now + 1;
+        timerWheelFile(wheel, timer);
+    }
+    return timer;
+}
+
+static void timerServiceTask(void* pdata)
+{
+    OS_CPU_SR cpu_sr = 0;
+    Timer* timer;
+    alt_u64 start;
+    alt_u64 busy;
+    alt_u32 expired;
+    alt_u32 ticks;
+    INT8U err;
+
+    while (1) {
+        OS_ENTER_CRITICAL();
+        if (serviceWheel.armed == 0) {
+            serviceIdle = 1;
+            OS_EXIT_CRITICAL();
+            OSSemPend(serviceWakeSemaphore, 0, &err);
+            continue;
+        }
+        OS_EXIT_CRITICAL();
+
+        OSTimeDly(1);
+        start = timestampNow();
+        ticks = 0;
+        expired = 0;
+
+        // every tick since the last pass, several of them after a tickless sleep
+        OS_ENTER_CRITICAL();
+        while (serviceWheel.now != OSTime) {
+            timerWheelAdvance(&serviceWheel);
+            ticks++;
+            while ((timer = timerWheelExpire(&serviceWheel)) != NULL) {
+                OS_EXIT_CRITICAL();
+                timerFire(timer);
+                expired++;
+                OS_ENTER_CRITICAL();
+            }
+        }
+        OS_EXIT_CRITICAL();
+
+        busy = timestampNow() - start;
+        OS_ENTER_CRITICAL();
+        serviceStatistics.ticks += ticks;
+        serviceStatistics.expired += expired;
+        serviceStatistics.busyTime += busy;
+        if (busy > serviceStatistics.busyMax)
+            serviceStatistics.busyMax = busy;
+        OS_EXIT_CRITICAL();
+    }
+}
+
+INT8U timerServiceStart(INT8U priority)
+{
+    timerWheelInit(&serviceWheel, OSTimeGet());
+    serviceWakeSemaphore = OSSemCreate(0);
+    if (serviceWakeSemaphore == NULL)
+        return OS_ERR_PEVENT_NULL;
+
+    return OSTaskCreateExt
+        ( timerServiceTask,                                 // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &timerServiceStack[TIMER_SERVICE_STACKSIZE-1],    // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &timerServiceStack[0],                            // Pointer to bottom of task stack
+          TIMER_SERVICE_STACKSIZE,                          // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
+
+void timerStart(Timer* timer, alt_u32 delayTicks, alt_u32 periodTicks)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    if (delayTicks == 0)
+        delayTicks = 1;
+
+    OS_ENTER_CRITICAL();
+    // an empty wheel is not advanced, it catches up at once; an armed one
+    // lags OSTime by the ticks the service task has yet to process, and the
+    // delay counts from OSTime, not from the wheel's time
+    if (serviceWheel.armed == 0)
+        serviceWheel.now = OSTime;
+    timerWheelAdd(&serviceWheel, timer, delayTicks + (OSTime - serviceWheel.now), periodTicks);
+    if (serviceIdle) {
+        serviceIdle = 0;
+        OSSemPost(serviceWakeSemaphore);
+    }
+    OS_EXIT_CRITICAL();
+}
+
+void timerStop(Timer* timer)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    timerWheelRemove(&serviceWheel, timer);
+    OS_EXIT_CRITICAL();
+}
+
+int timerArmed(const Timer* timer)
+{
+    return timer->pprev != NULL;
+}
+
+void timerServiceGetStatistics(TimerServiceStatistics* statistics)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    *statistics = serviceStatistics;
+    OS_EXIT_CRITICAL();
+}
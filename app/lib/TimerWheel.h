@@ -0,0 +1,111 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "includes.h"
+#include "alt_types.h"
+
+/*
+ * Hierarchical timing wheel and a timer service built on it.
+ *
+ * The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots. A
+ * timer due within 64 ticks sits in the level 0 slot of its tick, one due
+ * within 64 * 64 ticks in the level 1 slot of its block of 64 ticks, and
+ * so on. Each tick empties one level 0 slot; every 64 ticks the next level
+ * 1 slot is spread over level 0 (cascaded), every 4096 ticks the next
+ * level 2 slot, and so on. Arming and stopping a timer is a list insert or
+ * unlink, and a tick costs the same however many timers are armed, apart
+ * from the timers that expire or cascade in it. Delays are capped at
+ * TIMER_WHEEL_MAX_DELAY ticks.
+ *
+ * An expired timer calls its callback, or posts its semaphore when it was
+ * set up with timerInitSemaphore(). A periodic timer is armed again one
+ * period after its previous expiry, so it does not drift when a tick is
+ * processed late.
+ *
+ * The timerWheel functions work on a wheel of the caller's and do no
+ * locking. The timer service owns one wheel and a task that advances it
+ * with OSTime, and calls the expiries from that task. Its functions can be
+ * called from any task and from the callbacks. The service task waits a
+ * tick at a time while timers are armed and pends on a semaphore while
+ * none are. A timer stopped while its expiry is being delivered may still
+ * fire that once.
+ */
+
+#define TIMER_WHEEL_BITS            6
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK            (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS          4
+#define TIMER_WHEEL_MAX_DELAY       ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+#define TIMER_SERVICE_STACKSIZE     2048
+
+typedef struct Timer {
+    struct Timer* next;
+    struct Timer** pprev;                       // link to this timer, NULL while not armed
+    alt_u32 expires;                            // tick it is due at
+    alt_u32 period;                             // 0 for a one-shot timer
+    void (*callback)(struct Timer* timer, void* arg);
+    void* arg;
+    OS_EVENT* semaphore;                        // posted when there is no callback
+} Timer;
+
+typedef struct {
+    Timer* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    Timer* expired;                             // due in the current tick
+    alt_u32 now;
+    alt_u32 armed;
+} TimerWheel;
+
+typedef struct {
+    alt_u32 ticks;                              // ticks processed
+    alt_u32 expired;                            // expiries delivered
+    alt_u64 busyTime;                           // spent processing ticks, callbacks included
+    alt_u64 busyMax;                            // longest pass of the service task
+} TimerServiceStatistics;
+
+/* Sets up a timer that calls callback(timer, arg) when it expires */
+void  timerInit(Timer* timer, void (*callback)(Timer* timer, void* arg), void* arg);
+
+/* Sets up a timer that posts the semaphore when it expires */
+void  timerInitSemaphore(Timer* timer, OS_EVENT* semaphore);
+
+/* Runs the callback or posts the semaphore */
+void  timerFire(Timer* timer);
+
+/* Empties the wheel and sets its time */
+void  timerWheelInit(TimerWheel* wheel, alt_u32 now);
+
+/*
+ * Arms the timer to expire delayTicks (at least 1) from now and then every
+ * periodTicks, or once when periodTicks is 0. An armed timer is re-armed.
+ */
+void  timerWheelAdd(TimerWheel* wheel, Timer* timer, alt_u32 delayTicks, alt_u32 periodTicks);
+
+/* Disarms the timer, nothing happens when it is not armed */
+void  timerWheelRemove(TimerWheel* wheel, Timer* timer);
+
+/* Moves the wheel on by one tick, its expired timers are taken with timerWheelExpire() */
+void  timerWheelAdvance(TimerWheel* wheel);
+
+/*
+ * Takes the next timer due in the current tick, arming it again when it
+ * is periodic. Returns NULL when there is none; the caller fires it.
+ */
+Timer* timerWheelExpire(TimerWheel* wheel);
+
+/* Creates the service task at the given priority */
+INT8U timerServiceStart(INT8U priority);
+
+/*
+ * timerWheelAdd() and timerWheelRemove() on the wheel of the service; the
+ * delay counts from OSTime
+ */
+void  timerStart(Timer* timer, alt_u32 delayTicks, alt_u32 periodTicks);
+void  timerStop(Timer* timer);
+
+/* Returns 1 while the timer is armed */
+int   timerArmed(const Timer* timer);
+
+void  timerServiceGetStatistics(TimerServiceStatistics* statistics);
+
+#endif /* TIMER_WHEEL_H */
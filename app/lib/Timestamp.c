@@ -0,0 +1,35 @@
+#include "Timestamp.h"
+
+#if defined(TIMESTAMP_RDTSC) && !defined(__nios2__)
+
+#include <time.h>
+
+/* Calibrates the TSC against CLOCK_MONOTONIC_RAW over 20 ms, once */
+alt_u64 timestampFrequency(void)
+{
+    static alt_u64 frequency = 0;
+    struct timespec start, now;
+    alt_u64 startTsc;
+    alt_u64 elapsedNs;
+
+    if (frequency == 0) {
+        clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+        startTsc = timestampNow();
+        do {
+            clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+            elapsedNs = (alt_u64)(now.tv_sec - start.tv_sec) * 1000000000ULL
+                      + (alt_u64)now.tv_nsec - (alt_u64)start.tv_nsec;
+        } while (elapsedNs < 20000000ULL);
+        frequency = (timestampNow() - startTsc) * 1000000000ULL / elapsedNs;
+    }
+    return frequency;
+}
+
+#else
+
+alt_u64 timestampFrequency(void)
+{
+    return (alt_u64)ALT_CPU_FREQ;
+}
+
+#endif
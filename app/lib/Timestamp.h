@@ -0,0 +1,61 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include "alt_types.h"
+#include "system.h"
+
+/*
+ * Free-running cycle timestamps for fine-grained measurements.
+ *
+ * On the board the global counter (section 0) of the performance counter
+ * peripheral is read directly, so it only runs between PERF_START_MEASURING
+ * and PERF_STOP_MEASURING and ticks at ALT_CPU_FREQ. On the host build the
+ * source is CLOCK_MONOTONIC_RAW in nanoseconds, or the TSC when compiled
+ * with -DTIMESTAMP_RDTSC.
+ */
+
+#ifdef __nios2__
+
+#include "io.h"
+
+static inline alt_u64 timestampNow(void)
+{
+    alt_u32 hi;
+    alt_u32 lo;
+
+    // re-read the high word in case the low word wrapped in between
+    do {
+        hi = IORD(PERFORMANCE_COUNTER_0_BASE, 1);
+        lo = IORD(PERFORMANCE_COUNTER_0_BASE, 0);
+    } while (hi != IORD(PERFORMANCE_COUNTER_0_BASE, 1));
+
+    return ((alt_u64)hi << 32) | lo;
+}
+
+#elif defined(TIMESTAMP_RDTSC)
+
+#include <x86intrin.h>
+
+static inline alt_u64 timestampNow(void)
+{
+    return (alt_u64)__rdtsc();
+}
+
+#else
+
+#include <time.h>
+
+static inline alt_u64 timestampNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (alt_u64)ts.tv_sec * 1000000000ULL + (alt_u64)ts.tv_nsec;
+}
+
+#endif
+
+/* Number of timestamp ticks per second */
+alt_u64 timestampFrequency(void);
+
+#endif /* TIMESTAMP_H */
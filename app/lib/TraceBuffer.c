@@ -0,0 +1,49 @@
+#include <stdio.h>
+
+#include "TraceBuffer.h"
+
+void traceBufferInit(TraceBuffer* buffer, TraceRecord* records, alt_u32 size)
+{
+    alt_u32 i;
+
+    // sequence 0 never matches a claimed slot, so every slot starts unpublished
+    for (i = 0; i < size; i++)
+        records[i].sequence = 0;
+
+    buffer->records = records;
+    buffer->mask    = size - 1;
+    buffer->head    = 0;
+    buffer->tail    = 0;
+    buffer->dropped = 0;
+    buffer->origin  = 0;
+}
+
+int traceBufferDrain(TraceBuffer* buffer, const char* const eventNames[], int numEvents)
+{
+    TraceRecord* record;
+    int drained = 0;
+
+    while (buffer->tail != buffer->head) {
+        record = &buffer->records[buffer->tail & buffer->mask];
+        if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != buffer->tail + 1)
+            break;
+
+        if (buffer->tail == 0)
+            buffer->origin = record->timestamp;
+
+        if (record->event < numEvents)
+            printf("%10lu prio %2u: %s", (unsigned long)(record->timestamp - buffer->origin),
+                    record->priority, eventNames[record->event]);
+        else
+            printf("%10lu prio %2u: event %u", (unsigned long)(record->timestamp - buffer->origin),
+                    record->priority, record->event);
+        if (record->argument != 0)
+            printf(" (%u)", record->argument);
+        printf("\n");
+
+        buffer->tail++;
+        drained++;
+    }
+
+    return drained;
+}
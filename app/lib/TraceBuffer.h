@@ -0,0 +1,89 @@
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include "includes.h"
+#include "alt_types.h"
+#include "Timestamp.h"
+
+/*
+ * Deferred trace-event ring buffer.
+ *
+ * Tasks log fixed-size binary records (timestamp, task priority, event id)
+ * in a few cycles with traceBufferWrite() instead of printing, and a low
+ * priority task formats them later with traceBufferDrain(). Writers never
+ * block: a full buffer drops the event and counts it.
+ *
+ * A slot is claimed by advancing the head index (a compare-and-swap on the
+ * host; on Nios II, which has no atomic instructions, interrupts are masked
+ * around just that check and increment) and published by writing its
+ * sequence number last, so the drainer never reads a half-written record.
+ */
+
+typedef struct {
+    alt_u32 timestamp;  // low 32 bits of timestampNow()
+    alt_u32 sequence;   // slot index + 1 once the record is complete
+    alt_u8  priority;   // priority of the task that logged the event
+    alt_u8  event;
+    alt_u16 argument;
+} TraceRecord;
+
+typedef struct {
+    TraceRecord* records;
+    alt_u32 mask;               // size - 1, size is a power of two
+    volatile alt_u32 head;      // next slot to claim
+    volatile alt_u32 tail;      // next slot to drain
+    volatile alt_u32 dropped;
+    alt_u32 origin;             // timestamp of the first record, for printing
+} TraceBuffer;
+
+/* size must be a power of two */
+void traceBufferInit(TraceBuffer* buffer, TraceRecord* records, alt_u32 size);
+
+static inline void traceBufferWrite(TraceBuffer* buffer, alt_u8 event, alt_u16 argument)
+{
+    alt_u32 slot;
+    TraceRecord* record;
+
+#ifdef __nios2__
+    OS_CPU_SR cpu_sr;
+    alt_u8 claimed;
+
+    // the drainer may advance tail once interrupts are back on, so the
+    // claim is decided here and not by checking again afterwards
+    OS_ENTER_CRITICAL();
+    slot = buffer->head;
+    claimed = slot - buffer->tail <= buffer->mask;
+    if (claimed)
+        buffer->head = slot + 1;
+    OS_EXIT_CRITICAL();
+    if (!claimed) {
+        buffer->dropped++;
+        return;
+    }
+#else
+    slot = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    do {
+        if (slot - buffer->tail > buffer->mask) {
+            buffer->dropped++;
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&buffer->head, &slot, slot + 1, 1,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+#endif
+
+    record = &buffer->records[slot & buffer->mask];
+    record->timestamp = (alt_u32)timestampNow();
+    record->priority  = OSPrioCur;
+    record->event     = event;
+    record->argument  = argument;
+    __atomic_store_n(&record->sequence, slot + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Prints every published record as "timestamp-delta prio event-name" and
+ * releases the slots. Stops at the first slot that is claimed but not yet
+ * published. Returns the number of records printed.
+ */
+int traceBufferDrain(TraceBuffer* buffer, const char* const eventNames[], int numEvents);
+
+#endif /* TRACE_BUFFER_H */
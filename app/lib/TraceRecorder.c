@@ -0,0 +1,131 @@
+#include <stdio.h>
+
+#include "TraceRecorder.h"
+
+TraceRecorderRecord traceRecorderRing[TRACE_RECORDER_SIZE];
+volatile alt_u32 traceRecorderHead;
+volatile alt_u8 traceRecorderEnabled;
+
+typedef struct {
+    const char* name;
+    alt_u16 id;             // priority or object id
+    alt_u8 isTask;
+} TraceRecorderName;
+
+static TraceRecorderName traceRecorderNames[TRACE_RECORDER_MAX_NAMES];
+static int traceRecorderNameCount;
+static alt_u64 traceRecorderMeanCost;
+static alt_u64 traceRecorderMaxCost;
+static INT16U traceRecorderDumpTicks;
+static OS_STK traceRecorderStack[TRACE_RECORDER_STACKSIZE];
+
+void traceRecorderInit(void)
+{
+    alt_u64 start;
+    alt_u64 cost;
+    alt_u64 sum = 0;
+    int i;
+
+    // timed one at a time, so the cost includes reading the timestamp once
+    traceRecorderEnabled = 1;
+    traceRecorderMaxCost = 0;
+    for (i = 0; i < TRACE_RECORDER_CALIBRATION; i++) {
+        start = timestampNow();
+        traceRecorderWrite(TRACE_RECORDER_MARK, 0, 0);
+        cost = timestampNow() - start;
+        sum += cost;
+        if (cost > traceRecorderMaxCost)
+            traceRecorderMaxCost = cost;
+    }
+    traceRecorderMeanCost = sum / TRACE_RECORDER_CALIBRATION;
+    traceRecorderHead = 0;
+}
+
+static void traceRecorderName(alt_u16 id, alt_u8 isTask, const char* name)
+{
+    if (traceRecorderNameCount == TRACE_RECORDER_MAX_NAMES)
+        return;
+    traceRecorderNames[traceRecorderNameCount].name = name;
+    traceRecorderNames[traceRecorderNameCount].id = id;
+    traceRecorderNames[traceRecorderNameCount].isTask = isTask;
+    traceRecorderNameCount++;
+}
+
+void traceRecorderNameTask(INT8U priority, const char* name)
+{
+    traceRecorderName(priority, 1, name);
+}
+
+void traceRecorderNameObject(const void* object, const char* name)
+{
+    traceRecorderName(TRACE_RECORDER_OBJECT(object), 0, name);
+}
+
+void traceRecorderSwitchHook(void)
+{
+    traceRecorderWrite(TRACE_RECORDER_SWITCH, OSTCBHighRdy->OSTCBPrio, OSTCBCur->OSTCBPrio);
+}
+
+void traceRecorderTickHook(void)
+{
+    traceRecorderWrite(TRACE_RECORDER_TICK, OSPrioCur, (alt_u16)OSTime);
+}
+
+void traceRecorderDump(void)
+{
+    const TraceRecorderRecord* record;
+    alt_u32 head;
+    alt_u32 first;
+    alt_u32 i;
+    int j;
+
+    traceRecorderEnabled = 0;
+    head = traceRecorderHead;
+    first = head > TRACE_RECORDER_SIZE ? head - TRACE_RECORDER_SIZE : 0;
+
+    printf(TRACE_RECORDER_PREFIX "begin %llu %lu %lu\n", (unsigned long long)timestampFrequency(),
+            (unsigned long)(head - first), (unsigned long)first);
+    printf(TRACE_RECORDER_PREFIX "overhead %llu %llu\n",
+            (unsigned long long)traceRecorderMeanCost, (unsigned long long)traceRecorderMaxCost);
+    printf(TRACE_RECORDER_PREFIX "task %u idle\n", OS_TASK_IDLE_PRIO);
+    for (j = 0; j < traceRecorderNameCount; j++)
+        printf(TRACE_RECORDER_PREFIX "%s %u %s\n", traceRecorderNames[j].isTask ? "task" : "object",
+                traceRecorderNames[j].id, traceRecorderNames[j].name);
+
+    for (i = first; i < head; i += TRACE_RECORDER_PER_LINE) {
+        printf(TRACE_RECORDER_PREFIX);
+        for (j = 0; j < TRACE_RECORDER_PER_LINE && i + j < head; j++) {
+            record = &traceRecorderRing[(i + j) & (TRACE_RECORDER_SIZE - 1)];
+            printf("%08lx%02x%02x%04x ", (unsigned long)record->timestamp,
+                    record->event, record->priority, record->argument);
+        }
+        printf("\n");
+    }
+    printf(TRACE_RECORDER_PREFIX "end\n");
+    fflush(stdout);
+}
+
+static void traceRecorderTask(void* pdata)
+{
+    OSTimeDly(traceRecorderDumpTicks);
+    traceRecorderDump();
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+INT8U traceRecorderStart(INT8U priority, INT16U dumpAfterTicks)
+{
+    traceRecorderDumpTicks = dumpAfterTicks > 0 ? dumpAfterTicks : 1;
+
+    return OSTaskCreateExt
+        ( traceRecorderTask,                                // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &traceRecorderStack[TRACE_RECORDER_STACKSIZE-1],  // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &traceRecorderStack[0],                           // Pointer to bottom of task stack
+          TRACE_RECORDER_STACKSIZE,                         // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
@@ -0,0 +1,110 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "includes.h"
+#include "alt_types.h"
+#include "Timestamp.h"
+
+/*
+ * Scheduler trace recorder.
+ *
+ * Builds with -DTRACE_RECORDER log every context switch and tick, from the
+ * program's App_TaskSwHook() and App_TimeTickHook(), and every post and
+ * pend of the instrumented libraries into a ring of 8 byte records in RAM.
+ * The ring is a flight recorder: once full, the oldest records are
+ * overwritten, so it can be left running and always holds the latest
+ * TRACE_RECORDER_SIZE events. Without TRACE_RECORDER the TRACE_RECORD_*
+ * macros compile to nothing.
+ *
+ * Writing a record is a fixed sequence of stores under a critical section,
+ * with no loops; traceRecorderInit() times it and the dump reports the
+ * mean and the worst cost per event.
+ *
+ * traceRecorderDump() prints the ring as hex lines prefixed with
+ * TRACE_RECORDER_PREFIX, together with the counter frequency and the task
+ * and object names, for host/tools/traceconvert to turn into Chrome trace
+ * (Perfetto) JSON. Objects (semaphores, queues, flag groups) are identified
+ * by bits 2..17 of their address.
+ */
+
+#define TRACE_RECORDER_SIZE             8192    // records, a power of two
+#define TRACE_RECORDER_MAX_NAMES        32
+#define TRACE_RECORDER_STACKSIZE        1024
+#define TRACE_RECORDER_CALIBRATION      256
+#define TRACE_RECORDER_PER_LINE         8
+#define TRACE_RECORDER_PREFIX           "trace: "
+
+enum {
+    TRACE_RECORDER_SWITCH,          // priority: task switched to, argument: task switched from
+    TRACE_RECORDER_TICK,            // argument: low 16 bits of OSTime
+    TRACE_RECORDER_POST,            // argument: object
+    TRACE_RECORDER_PEND,            // the task is about to wait on the object
+    TRACE_RECORDER_PEND_DONE,       // ... and got it
+    TRACE_RECORDER_PEND_TIMEOUT,    // ... and did not, timeout or error
+    TRACE_RECORDER_MARK,            // argument: user value
+    TRACE_RECORDER_EVENT_COUNT
+};
+
+typedef struct {
+    alt_u32 timestamp;      // low 32 bits of timestampNow()
+    alt_u8  event;
+    alt_u8  priority;       // priority of the running task
+    alt_u16 argument;
+} TraceRecorderRecord;
+
+extern TraceRecorderRecord traceRecorderRing[TRACE_RECORDER_SIZE];
+extern volatile alt_u32 traceRecorderHead;     // records written so far
+extern volatile alt_u8 traceRecorderEnabled;
+
+#define TRACE_RECORDER_OBJECT(object)   ((alt_u16)((unsigned long)(object) >> 2))
+
+static inline void traceRecorderWrite(alt_u8 event, alt_u8 priority, alt_u16 argument)
+{
+    OS_CPU_SR cpu_sr = 0;
+    TraceRecorderRecord* record;
+
+    OS_ENTER_CRITICAL();
+    if (traceRecorderEnabled) {
+        record = &traceRecorderRing[traceRecorderHead++ & (TRACE_RECORDER_SIZE - 1)];
+        record->timestamp = (alt_u32)timestampNow();
+        record->event     = event;
+        record->priority  = priority;
+        record->argument  = argument;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+#ifdef TRACE_RECORDER
+#define TRACE_RECORD_POST(object)           traceRecorderWrite(TRACE_RECORDER_POST, OSPrioCur, TRACE_RECORDER_OBJECT(object))
+#define TRACE_RECORD_PEND(object)           traceRecorderWrite(TRACE_RECORDER_PEND, OSPrioCur, TRACE_RECORDER_OBJECT(object))
+#define TRACE_RECORD_PEND_DONE(object, err) traceRecorderWrite((err) == OS_ERR_NONE ? TRACE_RECORDER_PEND_DONE : \
+                                                TRACE_RECORDER_PEND_TIMEOUT, OSPrioCur, TRACE_RECORDER_OBJECT(object))
+#define TRACE_RECORD_MARK(value)            traceRecorderWrite(TRACE_RECORDER_MARK, OSPrioCur, (value))
+#else
+#define TRACE_RECORD_POST(object)
+#define TRACE_RECORD_PEND(object)
+#define TRACE_RECORD_PEND_DONE(object, err)
+#define TRACE_RECORD_MARK(value)
+#endif
+
+/* Measures the cost of a record and starts recording */
+void  traceRecorderInit(void);
+
+/* Names shown for a task priority or an object in the converted trace */
+void  traceRecorderNameTask(INT8U priority, const char* name);
+void  traceRecorderNameObject(const void* object, const char* name);
+
+/* To be called from App_TaskSwHook() and App_TimeTickHook() */
+void  traceRecorderSwitchHook(void);
+void  traceRecorderTickHook(void);
+
+/* Stops recording and prints the ring */
+void  traceRecorderDump(void);
+
+/*
+ * Starts a task that dumps the ring after the given number of ticks, for
+ * programs that never end on their own.
+ */
+INT8U traceRecorderStart(INT8U priority, INT16U dumpAfterTicks);
+
+#endif /* TRACE_RECORDER_H */
@@ -0,0 +1,134 @@
+#include "WorkerScheduler.h"
+#include "Timestamp.h"
+
+static ReadyBitmap workerReady;
+static OS_EVENT* workerReadySemaphore;
+static volatile alt_u8 dispatcherIdle;
+static alt_u64 workerTimeSlice;
+static alt_u32 workerStepCount;
+static OS_STK workerSchedStack[WORKER_SCHED_STACKSIZE];
+
+/* Called with interrupts disabled */
+static void workerReadyLocked(Worker* worker)
+{
+    readyBitmapInsert(&workerReady, &worker->node, worker->node.priority);
+    if (dispatcherIdle) {
+        dispatcherIdle = 0;
+        OSSemPost(workerReadySemaphore);
+    }
+}
+
+static void workerSchedTask(void* pdata)
+{
+    OS_CPU_SR cpu_sr = 0;
+    Worker* current = NULL;
+    Worker* worker;
+    WorkerResult result;
+    alt_u64 sliceStart = 0;
+    INT8U err;
+
+    while (1) {
+        OS_ENTER_CRITICAL();
+        worker = (Worker*)readyBitmapHighest(&workerReady);
+        if (worker == NULL) {
+            dispatcherIdle = 1;
+            OS_EXIT_CRITICAL();
+            OSSemPend(workerReadySemaphore, 0, &err);
+            continue;
+        }
+        OS_EXIT_CRITICAL();
+
+        // a new slice whenever another worker comes up, preempted or not
+        if (worker != current) {
+            current = worker;
+            sliceStart = timestampNow();
+        }
+        result = worker->step(worker);
+        worker->steps++;
+        workerStepCount++;
+
+        OS_ENTER_CRITICAL();
+        if (result == WORKER_WAIT && worker->wakePending) {
+            worker->wakePending = 0;
+            result = WORKER_YIELD;
+        }
+        switch (result) {
+        case WORKER_CONTINUE:
+            if (timestampNow() - sliceStart < workerTimeSlice)
+                break;
+            // the slice is used up, yield
+            /* fall through */
+        case WORKER_YIELD:
+            readyBitmapRotate(&workerReady, worker->node.priority);
+            current = NULL;
+            break;
+        case WORKER_WAIT:
+            readyBitmapRemove(&workerReady, &worker->node);
+            worker->waiting = 1;
+            current = NULL;
+            break;
+        case WORKER_DONE:
+            readyBitmapRemove(&workerReady, &worker->node);
+            current = NULL;
+            break;
+        }
+        OS_EXIT_CRITICAL();
+    }
+}
+
+INT8U workerSchedStart(INT8U priority, alt_u32 timeSliceUs)
+{
+    readyBitmapInit(&workerReady);
+    workerTimeSlice = timeSliceUs * timestampFrequency() / 1000000;
+    workerReadySemaphore = OSSemCreate(0);
+    if (workerReadySemaphore == NULL)
+        return OS_ERR_PEVENT_NULL;
+
+    return OSTaskCreateExt
+        ( workerSchedTask,                                  // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &workerSchedStack[WORKER_SCHED_STACKSIZE-1],      // Pointer to top of task stack
+          priority,                                         // Desired Task priority
+          priority,                                         // Task ID
+          &workerSchedStack[0],                             // Pointer to bottom of task stack
+          WORKER_SCHED_STACKSIZE,                           // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+}
+
+void workerAdd(Worker* worker, WorkerResult (*step)(Worker* worker), void* arg, alt_u16 priority)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    worker->step = step;
+    worker->arg = arg;
+    worker->steps = 0;
+    worker->waiting = 0;
+    worker->wakePending = 0;
+    worker->node.priority = priority;
+
+    OS_ENTER_CRITICAL();
+    workerReadyLocked(worker);
+    OS_EXIT_CRITICAL();
+}
+
+void workerWake(Worker* worker)
+{
+    OS_CPU_SR cpu_sr = 0;
+
+    OS_ENTER_CRITICAL();
+    if (worker->waiting) {
+        worker->waiting = 0;
+        workerReadyLocked(worker);
+    } else {
+        worker->wakePending = 1;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+alt_u32 workerSchedSteps(void)
+{
+    return workerStepCount;
+}
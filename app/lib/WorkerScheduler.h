@@ -0,0 +1,68 @@
+#ifndef WORKER_SCHEDULER_H
+#define WORKER_SCHEDULER_H
+
+#include "includes.h"
+#include "alt_types.h"
+#include "ReadyBitmap.h"
+
+/*
+ * Scheduler for many workers inside one uC/OS-II task.
+ *
+ * uC/OS-II needs a priority of its own for every task, and there are 64.
+ * A worker instead is a step function run by a dispatcher task, and any
+ * number of workers can share one of READY_BITMAP_LEVELS priorities, so
+ * hundreds of them need no hand-assigned priorities. The dispatcher keeps
+ * the ready workers in a lib/ReadyBitmap and runs a step of the highest
+ * priority one at a time. Workers of the same priority take turns: one
+ * keeps running until it has used up the time slice given to
+ * workerSchedStart(), then goes to the back of its priority.
+ *
+ * Steps run to completion, a worker readied at a higher priority runs
+ * from the next step on; keep steps short. What a step returns decides
+ * what happens to the worker:
+ *
+ *   WORKER_CONTINUE    run again, until its time slice is used up
+ *   WORKER_YIELD       go to the back of its priority now
+ *   WORKER_WAIT        leave the ready list until workerWake()
+ *   WORKER_DONE        leave the scheduler
+ *
+ * A wake of a worker that is not waiting is kept, and its next WORKER_WAIT
+ * returns at once. workerAdd() and workerWake() can be called from
+ * tasks, interrupts and steps. With nothing ready the dispatcher pends on
+ * a semaphore, so lower priority tasks run.
+ *
+ * Time slices are measured with timestampNow(); on the board the
+ * performance counter must be running.
+ */
+
+#define WORKER_SCHED_STACKSIZE      2048
+
+typedef enum {
+    WORKER_CONTINUE,
+    WORKER_YIELD,
+    WORKER_WAIT,
+    WORKER_DONE
+} WorkerResult;
+
+typedef struct Worker {
+    ReadyNode node;                             // first, so a ready node is its worker
+    WorkerResult (*step)(struct Worker* worker);
+    void* arg;
+    alt_u32 steps;                              // steps run so far
+    alt_u8 waiting;
+    alt_u8 wakePending;                         // woken while not waiting
+} Worker;
+
+/* Creates the dispatcher task at the given priority */
+INT8U workerSchedStart(INT8U priority, alt_u32 timeSliceUs);
+
+/* Readies a worker at the given priority, below READY_BITMAP_LEVELS */
+void  workerAdd(Worker* worker, WorkerResult (*step)(Worker* worker), void* arg, alt_u16 priority);
+
+/* Readies a worker that returned WORKER_WAIT */
+void  workerWake(Worker* worker);
+
+/* Steps run by the dispatcher */
+alt_u32 workerSchedSteps(void);
+
+#endif /* WORKER_SCHEDULER_H */
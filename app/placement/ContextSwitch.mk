@@ -0,0 +1,19 @@
+# Placement profile of ContextSwitch: what goes in the on-chip memory of the
+# board, next to the small data (see "Memory placement" in ProjectMakefile)
+PLACEMENT_PROFILES += ContextSwitch
+
+# stacks of the task table up to this priority: MeasurementResults, Task0 and
+# Task1. Only with the sizes profiled for the same DEFINES, three 2048-entry
+# stacks do not fit next to the rest; placement-compare builds with
+# -DBENCHMARK, profiled by "make contextswitch stackprofile DEFINES=-DBENCHMARK"
+PLACE_STACKS_PRIORITY_ContextSwitch := 7
+
+# kernel functions of a semaphore hand-over and of the tick and interrupt exit
+PLACE_CODE_ContextSwitch := OSSemPend OSSemPost OS_Sched OS_SchedNew OS_EventTaskRdy \
+	OS_EventTaskWait OS_EventTaskRemove OSIntEnter OSIntExit OSTimeTick OSTaskSwHook
+
+# whole objects: OSCtxSw, OSIntCtxSw and OSStartHighRdy of the port
+PLACE_CODE_FILES_ContextSwitch := os_cpu_a.o
+
+# kernel data: the TCBs, the priority to TCB table and the events
+PLACE_DATA_ContextSwitch := OSTCBTbl OSTCBPrioTbl OSEventTbl
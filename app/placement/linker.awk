@@ -0,0 +1,64 @@
+# Writes the linker script of a build with a placement profile: the
+# linker.x of the BSP with an output section .fast in front of .text, so
+# it is offered every input section first. Run by ProjectMakefile:
+#
+#   awk -v memory=<region> -v code=<functions> -v files=<objects> \
+#       -v data=<variables> -f placement/linker.awk bsp/linker.x
+#
+# .fast goes in the memory region given and takes the small data with
+# _gp, which moves there from .rwdata, the FAST_DATA variables and then
+# what the profile lists. The BSP is compiled with -ffunction-sections
+# -fdata-sections -fno-common, so each kernel function and variable is a
+# section of its own.
+
+function inputs(list, pattern,    names, n, i, line)
+{
+    n = split(list, names, " ")
+    for (i = 1; i <= n; i++) {
+        line = pattern
+        gsub(/@/, names[i], line)
+        print "        " line
+    }
+}
+
+BEGIN {
+    placed = 0
+}
+
+# _gp is defined in .fast
+/^[ \t]*(PROVIDE *\( *)?_?gp *=/ {
+    next
+}
+
+!placed && /^[ \t]*\.text[ \t]*:/ {
+    print "    .fast :"
+    print "    {"
+    print "        PROVIDE (_alt_partition_fast_start = ABSOLUTE(.));"
+    print "        _gp = ABSOLUTE(. + 0x8000);"
+    print "        PROVIDE(gp = _gp);"
+    print "        *(.sdata .sdata.* .gnu.linkonce.s.*)"
+    print "        *(.sdata2 .sdata2.* .gnu.linkonce.s2.*)"
+    print "        *(.sbss .sbss.* .gnu.linkonce.sb.*)"
+    print "        *(.sbss2 .sbss2.* .gnu.linkonce.sb2.*)"
+    print "        *(.scommon)"
+    print "        *(.fast_data .fast_data.*)"
+    inputs(data, "*(.bss.@ .data.@ .rodata.@)")
+    inputs(code, "*(.text.@)")
+    inputs(files, "*@(.text .text.*)")
+    print "        . = ALIGN(4);"
+    print "        PROVIDE (_alt_partition_fast_end = ABSOLUTE(.));"
+    print "    } > " memory
+    print ""
+    placed = 1
+}
+
+{
+    print
+}
+
+END {
+    if (!placed) {
+        print "placement/linker.awk: no .text section in " FILENAME > "/dev/stderr"
+        exit 1
+    }
+}
@@ -2,33 +2,109 @@
 #include <stdio.h>
 #include "includes.h"
 #include <string.h>
-#include "altera_avalon_performance_counter.h"
-
-#define MEASURE_SEMAPHORE_POST_PEND 1
-#define MEASURE_CONTEXT_SWITCH_0_TO_1 2
-#define MEASURE_CONTEXT_SWITCH_1_TO_0 3
-
-// Uncomment to limit the number of iterations
+#include "BenchmarkMetric.h"
+#include "LatencyHistogram.h"
+#include "PerfScope.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "TimedWait.h"
+#include "Timestamp.h"
+#include "TraceBuffer.h"
+
+// Measurement sections, registered in main()
+int measureSemaphorePostPend;
+int measureContextSwitch0To1;
+int measureContextSwitch1To0;
+
+// Uncomment to limit the number of iterations (the host benchmark sets its own)
+#ifndef LIMIT_ITERATIONS
 #define LIMIT_ITERATIONS 10
+#endif
+
+// Number of uncontended post/pend pairs measured for the baseline
+#define BASELINE_ITERATIONS 1000
 
 // Define mutex semaphore
 OS_EVENT *task0StateSemaphore;
 OS_EVENT *task1StateSemaphore;
 OS_EVENT *measurementSemaphore;
 
+// Every switch is recorded, minus the median semaphore post/pend cost
+LatencyHistogram semaphorePostPendHistogram;
+LatencyHistogram contextSwitch0To1Histogram;
+LatencyHistogram contextSwitch1To0Histogram;
+alt_u64 semaphorePostPendBaseline;
+
+// Timestamp taken at the begin of each direction, 0 while no switch is in flight
+alt_u64 contextSwitch0To1Start;
+alt_u64 contextSwitch1To0Start;
+
+// Each switch is timed by one instrument only, the histograms and the
+// PerfScope sections taking turns, so neither times the other's bookkeeping.
+// Flipped by the task that begins the switch, read by the one that ends it
+alt_u8 contextSwitch0To1Scoped;
+alt_u8 contextSwitch1To0Scoped;
+
+// Task state changes are logged to a trace buffer and printed after the run,
+// keeping JTAG UART output off the measured loop. The tasks log four events
+// per iteration and leave the drain task no time before they are done, so a
+// longer run keeps its first 16384 events and counts the rest as dropped
+#define TRACE_BUFFER_SIZE 16384
+TraceRecord traceRecords[TRACE_BUFFER_SIZE];
+TraceBuffer traceBuffer;
+
+enum {
+    TRACE_TASK0_STATE0,
+    TRACE_TASK0_STATE1,
+    TRACE_TASK1_STATE0,
+    TRACE_TASK1_STATE1,
+    TRACE_EVENT_COUNT
+};
+
+const char* const traceEventNames[TRACE_EVENT_COUNT] = {
+    "Task 0 - State 0",
+    "Task 0 - State 1",
+    "Task 1 - State 0",
+    "Task 1 - State 1"
+};
+
+// Posted once the results are printed, the trace drain task then finishes
+OS_EVENT *measurementsDoneSemaphore;
+
+// The trace is drained this often whenever the CPU would otherwise be idle
+#define TRACE_DRAIN_PERIOD_US 100000
+
+/* Records one switch, subtracting the post/pend baseline from this sample */
+void recordContextSwitch(LatencyHistogram* histogram, alt_u64* start)
+{
+    alt_u64 cycles;
+
+    if (*start == 0)
+        return;
+
+    cycles = timestampNow() - *start;
+    *start = 0;
+    latencyHistogramRecord(histogram,
+            cycles > semaphorePostPendBaseline ? cycles - semaphorePostPendBaseline : 0);
+}
+
 /* Definition of Task Stacks */
 /* Stack grows from HIGH to LOW memory */
 #define   TASK_STACKSIZE       2048
-OS_STK    task0_stk[TASK_STACKSIZE];
-OS_STK    task1_stk[TASK_STACKSIZE];
-OS_STK    measurement_results_task_stk[TASK_STACKSIZE];
+#ifndef STACK_SIZES_PROFILED
+#define   TASK0_STACKSIZE      TASK_STACKSIZE
+#define   TASK1_STACKSIZE      TASK_STACKSIZE
+#define   MEASUREMENT_RESULTS_TASK_STACKSIZE TASK_STACKSIZE
+#define   TRACE_DRAIN_TASK_STACKSIZE TASK_STACKSIZE
+#endif
 
 /* Definition of Task Priorities */
 #define MEASUREMENT_RESULTS_TASK_PRIORITY      4
 #define TASK0_PRIORITY      6
 #define TASK1_PRIORITY      7
+#define TRACE_DRAIN_TASK_PRIORITY      10
 
-/* Prints a message and sleeps for given time interval */
+/* Logs its state and hands over to task 1, back-to-back without delays */
 void task0(void* pdata)
 {
 	INT8U err;
@@ -52,18 +128,23 @@ void task0(void* pdata)
 			// OSSemPend will decrease the semaphore to 0 (= "state" 1)
 			OSSemPend(task1StateSemaphore, 0, &err);
 
-            // End performance counter measurement of context switch from 1 to 0
-            PERF_END (PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_1_TO_0);
+            // End measurement of context switch from 1 to 0
+            if (contextSwitch1To0Scoped)
+                perfScopeEnd(measureContextSwitch1To0);
+            else
+                recordContextSwitch(&contextSwitch1To0Histogram, &contextSwitch1To0Start);
 
-			printf("Task 1 - State 1\n");
+            traceBufferWrite(&traceBuffer, TRACE_TASK1_STATE1, 0);
 
 			if (err == OS_ERR_NONE) { // signal that task 0 state is now 0 (meaning that the semaphore is state 1)
-				printf("Task 0 - State 1\n");
-				// start the timer for measuring the switch time
-				OSTimeDlyHMSM(0, 0, 0, 100);
-
-                //  Performance Counter macro to begin timing of the context switch from task 0 to 1.
-                PERF_BEGIN (PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_0_TO_1);
+                traceBufferWrite(&traceBuffer, TRACE_TASK0_STATE1, 0);
+
+                // Begin timing of the context switch from task 0 to 1
+                contextSwitch0To1Scoped = !contextSwitch0To1Scoped;
+                if (contextSwitch0To1Scoped)
+                    perfScopeBegin(measureContextSwitch0To1);
+                else
+                    contextSwitch0To1Start = timestampNow();
 				OSSemPost(task0StateSemaphore);
 			}
 
@@ -89,20 +170,24 @@ void task1(void* pdata)
 			// wait for task 0 state semaphore to become 1 (task 0 state 1)
 			OSSemPend(task0StateSemaphore, 0, &err);
 
-            // End performance counter measurement of context switch from 0 to 1
-            PERF_END (PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_0_TO_1);
+            // End measurement of context switch from 0 to 1
+            if (contextSwitch0To1Scoped)
+                perfScopeEnd(measureContextSwitch0To1);
+            else
+                recordContextSwitch(&contextSwitch0To1Histogram, &contextSwitch0To1Start);
 
-			printf("Task 0 - State 0\n");
+            traceBufferWrite(&traceBuffer, TRACE_TASK0_STATE0, 0);
 
 			if (err == OS_ERR_NONE) {
-				// delay for 10ms
-				OSTimeDlyHMSM(0, 0, 0, 10);
-
 				// signal that task 1 is in state 1
-				printf("Task 1 - State 0\n");
-
-                //  Performance Counter macro to begin timing of the context switch from task 0 to 1.
-                PERF_BEGIN (PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_1_TO_0);
+                traceBufferWrite(&traceBuffer, TRACE_TASK1_STATE0, 0);
+
+                // Begin timing of the context switch from task 1 to 0
+                contextSwitch1To0Scoped = !contextSwitch1To0Scoped;
+                if (contextSwitch1To0Scoped)
+                    perfScopeBegin(measureContextSwitch1To0);
+                else
+                    contextSwitch1To0Start = timestampNow();
 				OSSemPost(task1StateSemaphore);
 			}
 
@@ -122,97 +207,107 @@ void measurementResultsTask(void* pdata) {
     OSSemPend(measurementSemaphore, 0, &err);
     printf("Measurements done, printing results:\n");
 
-    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
-    perf_print_formatted_report( 
-        (void *)PERFORMANCE_COUNTER_0_BASE, // Peripheral's HW base address            
-        ALT_CPU_FREQ,             // defined in "system.h"
-        3,                        // How many sections to print
-        "Sem. Post/Pend",         // Display-names of sections
-        "Task 0 to 1",         // Display-names of sections
-        "Task 1 to 0"         // Display-names of sections
-        );  
-
-    alt_u64 averageSemPostPendCycles = perf_get_section_time((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_SEMAPHORE_POST_PEND) / perf_get_num_starts((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_SEMAPHORE_POST_PEND);
-    alt_u64 averageTask0to1ContextSwitchCycles = perf_get_section_time((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_0_TO_1) / perf_get_num_starts((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_0_TO_1);
-    alt_u64 averageTask1to0ContextSwitchCycles = perf_get_section_time((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_1_TO_0) / perf_get_num_starts((void*)PERFORMANCE_COUNTER_0_BASE, MEASURE_CONTEXT_SWITCH_1_TO_0);
-
-    alt_u64 averageContextSwitchCycles = (averageTask0to1ContextSwitchCycles + averageTask1to0ContextSwitchCycles) / 2;
-    printf("\nContext switch average no. of CPU cycles: %i\n", (int)averageContextSwitchCycles);
-    averageContextSwitchCycles -=  averageSemPostPendCycles;
-    printf("Context switch cpu cycle average minus semaphore post/pending function call cycles: %i\n", (int)averageContextSwitchCycles);
-    float averageContextSwitchTime = (float) averageContextSwitchCycles / (float) alt_get_cpu_freq();
-    printf("Average context switch time: %fs (%fus)\n", averageContextSwitchTime, averageContextSwitchTime * 1000000);
+    perfScopePrint();
+
+    // Distributions instead of averages: the tail is what breaks deadlines
+    alt_u64 frequency = timestampFrequency();
+    printf("\nContext switch latency (semaphore post/pend baseline of %llu cycles subtracted per sample):\n",
+            (unsigned long long)semaphorePostPendBaseline);
+    latencyHistogramPrint(&semaphorePostPendHistogram, "Sem. Post/Pend", frequency);
+    latencyHistogramPrint(&contextSwitch0To1Histogram, "Task 0 to 1", frequency);
+    latencyHistogramPrint(&contextSwitch1To0Histogram, "Task 1 to 0", frequency);
+
+    BENCHMARK_METRIC(latencyHistogramPercentile(&contextSwitch0To1Histogram, LATENCY_P50) * 1e9 / frequency,
+            "ns", BENCHMARK_LOWER_IS_BETTER, "switch 0 to 1 p50");
+    BENCHMARK_METRIC(latencyHistogramPercentile(&contextSwitch1To0Histogram, LATENCY_P50) * 1e9 / frequency,
+            "ns", BENCHMARK_LOWER_IS_BETTER, "switch 1 to 0 p50");
+    BENCHMARK_METRIC(latencyHistogramPercentile(&semaphorePostPendHistogram, LATENCY_P50) * 1e9 / frequency,
+            "ns", BENCHMARK_LOWER_IS_BETTER, "semaphore post-pend p50");
+
+    OSSemPost(measurementsDoneSemaphore);
+}
+
+/*
+ * Prints the logged task states whenever the tasks above leave the CPU idle,
+ * and once more as soon as the results are out. The benchmark tasks hand
+ * over back to back, so that is only once they are done with the loop
+ */
+void traceDrainTask(void* pdata)
+{
+    while (timedSemPend(measurementsDoneSemaphore, TRACE_DRAIN_PERIOD_US, NULL) == OS_ERR_TIMEOUT)
+        traceBufferDrain(&traceBuffer, traceEventNames, TRACE_EVENT_COUNT);
+
+    traceBufferDrain(&traceBuffer, traceEventNames, TRACE_EVENT_COUNT);
+    if (traceBuffer.dropped > 0)
+        printf("Trace buffer full, %lu events dropped\n", (unsigned long)traceBuffer.dropped);
+    BENCHMARK_END();
 }
 
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Task0, task0, NULL, TASK0_PRIORITY, TASK0_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Task1, task1, NULL, TASK1_PRIORITY, TASK1_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(MeasurementResults, measurementResultsTask, NULL, MEASUREMENT_RESULTS_TASK_PRIORITY, \
+            MEASUREMENT_RESULTS_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(TraceDrain, traceDrainTask, NULL, TRACE_DRAIN_TASK_PRIORITY, \
+            TRACE_DRAIN_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
 	printf("Lab 3 - Handshake\n");
 
-    // Reset (initialize to zero) all section counters and the global 
-    // counter of the performance_counter peripheral.
-    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
-    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    // Starts the counter (on the board the performance_counter peripheral,
+    // whose global counter timestampNow() reads too) and names the sections
+    perfScopeInit(NULL);
+    measureSemaphorePostPend = perfScopeSection("Sem. Post/Pend");
+    measureContextSwitch0To1 = perfScopeSection("Task 0 to 1");
+    measureContextSwitch1To0 = perfScopeSection("Task 1 to 0");
 
 	// initialize semaphores
 	task0StateSemaphore = OSSemCreate(0); // Initialize with state = 0
 	task1StateSemaphore = OSSemCreate(1); // Initialize with state = 1
     measurementSemaphore = OSSemCreate(0); // When updated, print the measurement results
+    measurementsDoneSemaphore = OSSemCreate(0);
     
 
 	INT8U err;
 
+    traceBufferInit(&traceBuffer, traceRecords, TRACE_BUFFER_SIZE);
+    latencyHistogramReset(&semaphorePostPendHistogram);
+    latencyHistogramReset(&contextSwitch0To1Histogram);
+    latencyHistogramReset(&contextSwitch1To0Histogram);
+
+    // Odd pairs are timed by the PerfScope section, even ones by the histogram
+    // the baseline is taken from, as the switches below
     int x = 0;
-    for (x = 0; x < 100; x++) {
-        PERF_BEGIN (PERFORMANCE_COUNTER_0_BASE, MEASURE_SEMAPHORE_POST_PEND);
-        OSSemPost(task0StateSemaphore);
-        OSSemPend(task0StateSemaphore, 0, &err);
-        PERF_END (PERFORMANCE_COUNTER_0_BASE, MEASURE_SEMAPHORE_POST_PEND);
+    for (x = 0; x < BASELINE_ITERATIONS; x++) {
+        if (x & 1) {
+            perfScopeBegin(measureSemaphorePostPend);
+            OSSemPost(task0StateSemaphore);
+            OSSemPend(task0StateSemaphore, 0, &err);
+            perfScopeEnd(measureSemaphorePostPend);
+        } else {
+            alt_u64 start = timestampNow();
+            OSSemPost(task0StateSemaphore);
+            OSSemPend(task0StateSemaphore, 0, &err);
+            latencyHistogramRecord(&semaphorePostPendHistogram, timestampNow() - start);
+        }
     }
+    semaphorePostPendBaseline = latencyHistogramPercentile(&semaphorePostPendHistogram, LATENCY_P50);
 
     // measure semaphore function calls
 
-	OSTaskCreateExt
-		( task0,                        // Pointer to task code
-		  NULL,                         // Pointer to argument passed to task
-		  &task0_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-		  TASK0_PRIORITY,               // Desired Task priority
-		  TASK0_PRIORITY,               // Task ID
-		  &task0_stk[0],                // Pointer to bottom of task stack
-		  TASK_STACKSIZE,               // Stacksize
-		  NULL,                         // Pointer to user supplied memory (not needed)
-		  OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-		  OS_TASK_OPT_STK_CLR           // Stack Cleared                                 
-		);
-
-	OSTaskCreateExt
-		( task1,                        // Pointer to task code
-		  NULL,                         // Pointer to argument passed to task
-		  &task1_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-		  TASK1_PRIORITY,               // Desired Task priority
-		  TASK1_PRIORITY,               // Task ID
-		  &task1_stk[0],                // Pointer to bottom of task stack
-		  TASK_STACKSIZE,               // Stacksize
-		  NULL,                         // Pointer to user supplied memory (not needed)
-		  OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-		  OS_TASK_OPT_STK_CLR           // Stack Cleared                       
-		);  
-
-	OSTaskCreateExt
-		( measurementResultsTask,                          // Pointer to task code
-		  NULL,                                            // Pointer to argument passed to task
-		  &measurement_results_task_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-		  MEASUREMENT_RESULTS_TASK_PRIORITY,               // Desired Task priority
-		  MEASUREMENT_RESULTS_TASK_PRIORITY,               // Task ID
-		  &measurement_results_task_stk[0],                // Pointer to bottom of task stack
-		  TASK_STACKSIZE,                                  // Stacksize
-		  NULL,                                            // Pointer to user supplied memory (not needed)
-		  OS_TASK_OPT_STK_CHK |                            // Stack Checking enabled 
-		  OS_TASK_OPT_STK_CLR                              // Stack Cleared                       
-		);  
+    taskTableCreate(taskTable, taskTableSize);
 
     printf("Started...\n");
 
+#ifdef STACK_PROFILE
+    stackProfileStart("ContextSwitch");
+#endif
+
 	OSStart();
 
 	return 0;
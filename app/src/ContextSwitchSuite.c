@@ -0,0 +1,532 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "includes.h"
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "LatencyHistogram.h"
+#include "StackProfile.h"
+#include "Timestamp.h"
+
+/*
+ * Context switch benchmark suite.
+ *
+ * N worker tasks pass a token around a ring, each waking the next through
+ * one IPC primitive, for every combination of ring size, primitive and
+ * priority layout that is selected. Every hop (post in one task until the
+ * next task returns from its pend) is recorded in a latency histogram, and
+ * one CSV or JSON result line is printed per scenario.
+ *
+ * Primitives:
+ *   sem    one counting semaphore per worker
+ *   mutex  semaphore ring, but the receiver must also take a mutex that the
+ *          sender still holds while posting; with the inverted layout every
+ *          hop is a contended handoff through priority inheritance
+ *   mbox   one mailbox per worker
+ *   q      one message queue per worker
+ *   flag   one event flag bit per worker, 32 workers per group
+ *
+ * Layouts:
+ *   adjacent  consecutive priorities, the token moves to a lower priority
+ *             so the switch happens when the sender pends
+ *   sparse    the same order, priorities spread over the whole range
+ *   inverted  consecutive priorities, the token moves to a higher priority
+ *             so every post preempts the sender; the hop that closes the
+ *             ring only completes once every preempted sender has reached
+ *             its pend again, so the tail grows with N
+ *
+ * The defaults below can be changed with -D at compile time, and on the host
+ * build from the command line:
+ *   ContextSwitchSuite --tasks 2,8,max --primitives sem,q --layouts inverted
+ *                      --hops 10000 --format json
+ * A ring size of "max" takes every priority between the controller and the
+ * system tasks (MAX_WORKERS).
+ */
+
+#ifndef SUITE_TASKS
+#define SUITE_TASKS         "2,4,8,16,32,max"
+#endif
+#ifndef SUITE_PRIMITIVES
+#define SUITE_PRIMITIVES    "sem,mutex,mbox,q,flag"
+#endif
+#ifndef SUITE_LAYOUTS
+#define SUITE_LAYOUTS       "adjacent,sparse,inverted"
+#endif
+#ifndef SUITE_HOPS
+#define SUITE_HOPS          5000
+#endif
+#ifndef SUITE_FORMAT
+#define SUITE_FORMAT        "csv"
+#endif
+
+enum {
+    PRIMITIVE_SEM,
+    PRIMITIVE_MUTEX,
+    PRIMITIVE_MBOX,
+    PRIMITIVE_Q,
+    PRIMITIVE_FLAG,
+    PRIMITIVE_COUNT
+};
+
+const char* const primitiveNames[PRIMITIVE_COUNT] = { "sem", "mutex", "mbox", "q", "flag" };
+
+enum {
+    LAYOUT_ADJACENT,
+    LAYOUT_SPARSE,
+    LAYOUT_INVERTED,
+    LAYOUT_COUNT
+};
+
+const char* const layoutNames[LAYOUT_COUNT] = { "adjacent", "sparse", "inverted" };
+
+/* Definition of Task Priorities */
+/* The controller sits above the ring, the mutex PIP above every worker */
+/* uC/OS-II reserves priorities 0 to 3, the labs start at 4 */
+#define CONTROLLER_TASK_PRIORITY    4
+#define TOKEN_MUTEX_PIP             5
+#define FIRST_WORKER_PRIORITY       6
+#ifdef STACK_PROFILE
+#define LAST_WORKER_PRIORITY        (STACK_PROFILE_PRIORITY - 1)
+#else
+#define LAST_WORKER_PRIORITY        (OS_LOWEST_PRIO - OS_N_SYS_TASKS)
+#endif
+#define MAX_WORKERS                 ((int)LAST_WORKER_PRIORITY - FIRST_WORKER_PRIORITY + 1)
+
+#define MAX_TASK_COUNTS             16
+#define QUEUE_SIZE                  4
+#define FLAGS_PER_GROUP             32
+#define FLAG_GROUPS                 ((MAX_WORKERS + FLAGS_PER_GROUP - 1) / FLAGS_PER_GROUP)
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#ifndef STACK_SIZES_PROFILED
+#define   CONTROLLER_STACKSIZE  4096
+#define   WORKER_STACKSIZE      1024
+#endif
+OS_STK    controller_task_stk[CONTROLLER_STACKSIZE];
+OS_STK    worker_task_stk[MAX_WORKERS][WORKER_STACKSIZE];
+
+// Selected configuration
+int taskCounts[MAX_TASK_COUNTS];
+int taskCountsLength;
+int primitiveSelected[PRIMITIVE_COUNT];
+int layoutSelected[LAYOUT_COUNT];
+alt_u32 hopsPerScenario = SUITE_HOPS;
+int jsonOutput;
+
+// State of the scenario being run
+int scenarioPrimitive;
+int scenarioWorkers;
+alt_u32 hopsDone;
+alt_u64 hopStart;                     // 0 while no hop is being timed
+LatencyHistogram hopHistogram;
+
+OS_EVENT*    workerEvents[MAX_WORKERS];
+OS_FLAG_GRP* workerFlagGroups[FLAG_GROUPS];
+void*        workerQueueStorage[MAX_WORKERS][QUEUE_SIZE];
+OS_EVENT*    tokenMutex;
+OS_EVENT*    scenarioDoneSemaphore;
+int          workerIndexes[MAX_WORKERS];
+int          token;                   // message for mbox and q, which must not be NULL
+
+/* Wakes the given worker through the scenario's primitive */
+void passToken(int worker)
+{
+    INT8U err;
+
+    switch (scenarioPrimitive) {
+        case PRIMITIVE_MBOX:
+            OSMboxPost(workerEvents[worker], &token);
+            break;
+        case PRIMITIVE_Q:
+            OSQPost(workerEvents[worker], &token);
+            break;
+        case PRIMITIVE_FLAG:
+            OSFlagPost(workerFlagGroups[worker / FLAGS_PER_GROUP],
+                    (OS_FLAGS)1 << (worker % FLAGS_PER_GROUP), OS_FLAG_SET, &err);
+            break;
+        default:
+            OSSemPost(workerEvents[worker]);
+            break;
+    }
+}
+
+void waitToken(int worker)
+{
+    INT8U err;
+
+    switch (scenarioPrimitive) {
+        case PRIMITIVE_MBOX:
+            OSMboxPend(workerEvents[worker], 0, &err);
+            break;
+        case PRIMITIVE_Q:
+            OSQPend(workerEvents[worker], 0, &err);
+            break;
+        case PRIMITIVE_FLAG:
+            OSFlagPend(workerFlagGroups[worker / FLAGS_PER_GROUP],
+                    (OS_FLAGS)1 << (worker % FLAGS_PER_GROUP),
+                    OS_FLAG_WAIT_SET_ANY + OS_FLAG_CONSUME, 0, &err);
+            break;
+        default:
+            OSSemPend(workerEvents[worker], 0, &err);
+            break;
+    }
+}
+
+/* Receives the token, records the hop and passes it on */
+void workerTask(void* pdata)
+{
+    int worker = *(int*)pdata;
+    INT8U err;
+
+    while (1) {
+        waitToken(worker);
+        if (scenarioPrimitive == PRIMITIVE_MUTEX)
+            OSMutexPend(tokenMutex, 0, &err);
+
+        if (hopStart != 0)
+            latencyHistogramRecord(&hopHistogram, timestampNow() - hopStart);
+
+        if (++hopsDone >= hopsPerScenario) {
+            if (scenarioPrimitive == PRIMITIVE_MUTEX)
+                OSMutexPost(tokenMutex);
+            OSSemPost(scenarioDoneSemaphore);   // the controller deletes the ring
+            continue;
+        }
+
+        hopStart = timestampNow();
+        passToken((worker + 1) % scenarioWorkers);
+        if (scenarioPrimitive == PRIMITIVE_MUTEX)
+            OSMutexPost(tokenMutex);
+    }
+}
+
+INT8U workerPriority(int layout, int worker, int workers)
+{
+    switch (layout) {
+        case LAYOUT_SPARSE:
+            if (workers < 2)
+                return FIRST_WORKER_PRIORITY;
+            return FIRST_WORKER_PRIORITY + worker * ((MAX_WORKERS - 1) / (workers - 1));
+        case LAYOUT_INVERTED:
+            return FIRST_WORKER_PRIORITY + workers - 1 - worker;
+        default:
+            return FIRST_WORKER_PRIORITY + worker;
+    }
+}
+
+/* Creates the per-worker objects, returns 0 when the OS ran out of them */
+int createScenarioObjects(int primitive, int workers)
+{
+    INT8U err;
+    int i;
+
+    tokenMutex = NULL;
+    if (primitive == PRIMITIVE_MUTEX) {
+        tokenMutex = OSMutexCreate(TOKEN_MUTEX_PIP, &err);
+        if (tokenMutex == NULL)
+            return 0;
+    }
+    for (i = 0; i < FLAG_GROUPS; i++)
+        workerFlagGroups[i] = NULL;
+
+    for (i = 0; i < workers; i++) {
+        switch (primitive) {
+            case PRIMITIVE_MBOX:
+                workerEvents[i] = OSMboxCreate(NULL);
+                break;
+            case PRIMITIVE_Q:
+                workerEvents[i] = OSQCreate(workerQueueStorage[i], QUEUE_SIZE);
+                break;
+            case PRIMITIVE_FLAG:
+                workerEvents[i] = NULL;
+                if (i % FLAGS_PER_GROUP == 0) {
+                    workerFlagGroups[i / FLAGS_PER_GROUP] = OSFlagCreate(0, &err);
+                    if (workerFlagGroups[i / FLAGS_PER_GROUP] == NULL)
+                        return 0;
+                }
+                continue;
+            default:
+                workerEvents[i] = OSSemCreate(0);
+                break;
+        }
+        if (workerEvents[i] == NULL)
+            return 0;
+    }
+    return 1;
+}
+
+void deleteScenarioObjects(int primitive, int workers)
+{
+    INT8U err;
+    int i;
+
+    for (i = 0; i < workers; i++) {
+        if (workerEvents[i] == NULL)
+            continue;
+        switch (primitive) {
+            case PRIMITIVE_MBOX:
+                OSMboxDel(workerEvents[i], OS_DEL_ALWAYS, &err);
+                break;
+            case PRIMITIVE_Q:
+                OSQDel(workerEvents[i], OS_DEL_ALWAYS, &err);
+                break;
+            default:
+                OSSemDel(workerEvents[i], OS_DEL_ALWAYS, &err);
+                break;
+        }
+        workerEvents[i] = NULL;
+    }
+    for (i = 0; i < FLAG_GROUPS; i++) {
+        if (workerFlagGroups[i] != NULL)
+            OSFlagDel(workerFlagGroups[i], OS_DEL_ALWAYS, &err);
+        workerFlagGroups[i] = NULL;
+    }
+    if (tokenMutex != NULL)
+        OSMutexDel(tokenMutex, OS_DEL_ALWAYS, &err);
+    tokenMutex = NULL;
+}
+
+alt_u64 cyclesToNs(alt_u64 cycles)
+{
+    return cycles * 1000000000ULL / timestampFrequency();
+}
+
+void printResult(int primitive, int layout, int workers, alt_u32 contextSwitches, alt_u64 elapsed, int first)
+{
+    double switchesPerHop = (double)contextSwitches / hopsDone;
+    double hopsPerSecond = elapsed > 0 ? (double)hopsDone * timestampFrequency() / elapsed : 0.0;
+
+    if (jsonOutput) {
+        printf("%s  {\"primitive\": \"%s\", \"layout\": \"%s\", \"tasks\": %d, \"hops\": %lu, "
+                "\"switches_per_hop\": %.2f, \"hops_per_sec\": %.0f, "
+                "\"min_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, "
+                "\"max_ns\": %llu, \"mean_ns\": %llu}",
+                first ? "" : ",\n",
+                primitiveNames[primitive], layoutNames[layout], workers, (unsigned long)hopsDone,
+                switchesPerHop, hopsPerSecond,
+                (unsigned long long)cyclesToNs(hopHistogram.min),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P50)),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P99)),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P999)),
+                (unsigned long long)cyclesToNs(hopHistogram.max),
+                (unsigned long long)cyclesToNs(latencyHistogramMean(&hopHistogram)));
+    } else {
+        printf("%s,%s,%d,%lu,%.2f,%.0f,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                primitiveNames[primitive], layoutNames[layout], workers, (unsigned long)hopsDone,
+                switchesPerHop, hopsPerSecond,
+                (unsigned long long)cyclesToNs(hopHistogram.min),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P50)),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P99)),
+                (unsigned long long)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P999)),
+                (unsigned long long)cyclesToNs(hopHistogram.max),
+                (unsigned long long)cyclesToNs(latencyHistogramMean(&hopHistogram)));
+    }
+    BENCHMARK_METRIC((double)cyclesToNs(latencyHistogramPercentile(&hopHistogram, LATENCY_P50)), "ns",
+            BENCHMARK_LOWER_IS_BETTER, "%s %s %d p50", primitiveNames[primitive], layoutNames[layout], workers);
+}
+
+/* Runs one ring to completion and tears it down again, returns 0 on failure */
+int runScenario(int primitive, int layout, int workers, int first)
+{
+    INT8U err;
+    alt_u32 contextSwitches;
+    alt_u64 elapsed;
+    int i;
+
+    scenarioPrimitive = primitive;
+    scenarioWorkers = workers;
+    hopsDone = 0;
+    hopStart = 0;
+    latencyHistogramReset(&hopHistogram);
+
+    if (!createScenarioObjects(primitive, workers)) {
+        fprintf(stderr, "%s: out of kernel objects for %d tasks\n", primitiveNames[primitive], workers);
+        deleteScenarioObjects(primitive, workers);
+        return 0;
+    }
+
+    // The workers are below the controller and only start once it pends
+    for (i = 0; i < workers; i++) {
+        workerIndexes[i] = i;
+        OSTaskCreateExt
+            ( workerTask,                                  // Pointer to task code
+              &workerIndexes[i],                           // Pointer to argument passed to task
+              &worker_task_stk[i][WORKER_STACKSIZE-1],     // Pointer to top of task stack
+              workerPriority(layout, i, workers),          // Desired Task priority
+              workerPriority(layout, i, workers),          // Task ID
+              &worker_task_stk[i][0],                      // Pointer to bottom of task stack
+              WORKER_STACKSIZE,                            // Stacksize
+              NULL,                                        // Pointer to user supplied memory (not needed)
+              OS_TASK_OPT_STK_CHK |                        // Stack Checking enabled
+              OS_TASK_OPT_STK_CLR                          // Stack Cleared
+            );
+#ifdef STACK_PROFILE
+        stackProfileAdd(workerPriority(layout, i, workers), "WORKER_STACKSIZE");
+#endif
+    }
+
+    contextSwitches = OSCtxSwCtr;
+    elapsed = timestampNow();
+    passToken(0);
+    OSSemPend(scenarioDoneSemaphore, 0, &err);
+    elapsed = timestampNow() - elapsed;
+    contextSwitches = OSCtxSwCtr - contextSwitches;
+
+    for (i = 0; i < workers; i++)
+        OSTaskDel(workerPriority(layout, i, workers));
+    deleteScenarioObjects(primitive, workers);
+
+    printResult(primitive, layout, workers, contextSwitches, elapsed, first);
+    return 1;
+}
+
+void controllerTask(void* pdata)
+{
+    int first = 1;
+    int t, p, l;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    if (jsonOutput)
+        printf("[\n");
+    else
+        printf("primitive,layout,tasks,hops,switches_per_hop,hops_per_sec,"
+                "min_ns,p50_ns,p99_ns,p999_ns,max_ns,mean_ns\n");
+
+    for (t = 0; t < taskCountsLength; t++)
+        for (p = 0; p < PRIMITIVE_COUNT; p++)
+            for (l = 0; l < LAYOUT_COUNT; l++)
+                if (primitiveSelected[p] && layoutSelected[l]
+                        && runScenario(p, l, taskCounts[t], first))
+                    first = 0;
+
+    if (jsonOutput)
+        printf("\n]\n");
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* Marks the names in a comma separated list, returns 0 on an unknown name */
+int parseNames(const char* list, const char* const names[], int count, int selected[])
+{
+    const char* end;
+    size_t length;
+    int i;
+
+    for (i = 0; i < count; i++)
+        selected[i] = 0;
+
+    while (*list) {
+        end = strchr(list, ',');
+        length = end ? (size_t)(end - list) : strlen(list);
+        for (i = 0; i < count; i++)
+            if (strlen(names[i]) == length && strncmp(list, names[i], length) == 0)
+                break;
+        if (i == count) {
+            fprintf(stderr, "unknown name '%.*s'\n", (int)length, list);
+            return 0;
+        }
+        selected[i] = 1;
+        list += length + (end ? 1 : 0);
+    }
+    return 1;
+}
+
+/* Parses the ring sizes, clamping them to the priorities left for workers */
+int parseTaskCounts(const char* list)
+{
+    char* end;
+    long tasks;
+
+    taskCountsLength = 0;
+    while (*list && taskCountsLength < MAX_TASK_COUNTS) {
+        if (strncmp(list, "max", 3) == 0) {
+            tasks = MAX_WORKERS;
+            end = (char*)list + 3;
+        } else {
+            tasks = strtol(list, &end, 10);
+        }
+        if (end == list || (*end != ',' && *end != '\0') || tasks < 2) {
+            fprintf(stderr, "invalid task count '%s', expected 2..%d or max\n", list, MAX_WORKERS);
+            return 0;
+        }
+        if (tasks > MAX_WORKERS) {
+            fprintf(stderr, "%ld tasks do not fit between the controller and the idle task, using %d\n",
+                    tasks, MAX_WORKERS);
+            tasks = MAX_WORKERS;
+        }
+        taskCounts[taskCountsLength++] = (int)tasks;
+        list = *end == ',' ? end + 1 : end;
+    }
+    return 1;
+}
+
+int parseArguments(int argc, char* argv[])
+{
+    const char* tasks = SUITE_TASKS;
+    const char* primitives = SUITE_PRIMITIVES;
+    const char* layouts = SUITE_LAYOUTS;
+    const char* format = SUITE_FORMAT;
+    int i;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--tasks") == 0)
+            tasks = argv[i + 1];
+        else if (strcmp(argv[i], "--primitives") == 0)
+            primitives = argv[i + 1];
+        else if (strcmp(argv[i], "--layouts") == 0)
+            layouts = argv[i + 1];
+        else if (strcmp(argv[i], "--hops") == 0)
+            hopsPerScenario = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--format") == 0)
+            format = argv[i + 1];
+        else
+            return 0;
+    }
+    if (argc > 0 && i != argc)
+        return 0;
+
+    jsonOutput = strcmp(format, "json") == 0;
+    return hopsPerScenario >= 2
+            && parseTaskCounts(tasks)
+            && parseNames(primitives, primitiveNames, PRIMITIVE_COUNT, primitiveSelected)
+            && parseNames(layouts, layoutNames, LAYOUT_COUNT, layoutSelected);
+}
+
+/* The main function creates the controller task and starts multi-tasking */
+int main(int argc, char* argv[])
+{
+    if (!parseArguments(argc, argv)) {
+        fprintf(stderr, "usage: ContextSwitchSuite [--tasks 2,8,max] [--primitives %s]\n"
+                "                          [--layouts %s] [--hops N] [--format csv|json]\n",
+                SUITE_PRIMITIVES, SUITE_LAYOUTS);
+        return 1;
+    }
+
+    scenarioDoneSemaphore = OSSemCreate(0);
+
+    OSTaskCreateExt
+        ( controllerTask,                               // Pointer to task code
+          NULL,                                         // Pointer to argument passed to task
+          &controller_task_stk[CONTROLLER_STACKSIZE-1], // Pointer to top of task stack
+          CONTROLLER_TASK_PRIORITY,                     // Desired Task priority
+          CONTROLLER_TASK_PRIORITY,                     // Task ID
+          &controller_task_stk[0],                      // Pointer to bottom of task stack
+          CONTROLLER_STACKSIZE,                         // Stacksize
+          NULL,                                         // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                         // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                           // Stack Cleared
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(CONTROLLER_TASK_PRIORITY, "CONTROLLER_STACKSIZE");
+    stackProfileStart("ContextSwitchSuite");
+#endif
+
+    OSStart();
+
+    return 0;
+}
@@ -1,124 +1,124 @@
 #include <stdio.h>
 #include "includes.h"
 #include <string.h>
+#include "HandshakeEngine.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "TraceRecorder.h"
 
 
-// Uncomment to limit the number of iterations
+// Uncomment to limit the number of iterations (the host benchmark sets its own)
+#ifndef LIMIT_ITERATIONS
 #define LIMIT_ITERATIONS 10
+#endif
 
-// Define mutex semaphore
-OS_EVENT *task0StateSemaphore;
-OS_EVENT *task1StateSemaphore;
+/*
+ * Each task moves between state 0 and 1 in lockstep with the other one:
+ *
+ *    Task    waits for             then
+ *    0       task 1 in state 0     enters state 1
+ *    1       task 0 in state 1     enters state 1
+ *    0       task 1 in state 1     enters state 0
+ *    1       task 0 in state 0     enters state 0
+ *
+ * Every state is announced with a flag, which the peer consumes.
+ */
+#define TASK0_IN_STATE_0    0x01
+#define TASK0_IN_STATE_1    0x02
+#define TASK1_IN_STATE_0    0x04
+#define TASK1_IN_STATE_1    0x08
+
+const HandshakeTransition handshakeTable[] = {
+    //  task  from  to  wait               consume            clear  set
+    {   0,    0,    1,  TASK1_IN_STATE_0,  TASK1_IN_STATE_0,  0,     TASK0_IN_STATE_1 },
+    {   1,    0,    1,  TASK0_IN_STATE_1,  TASK0_IN_STATE_1,  0,     TASK1_IN_STATE_1 },
+    {   0,    1,    0,  TASK1_IN_STATE_1,  TASK1_IN_STATE_1,  0,     TASK0_IN_STATE_0 },
+    {   1,    1,    0,  TASK0_IN_STATE_0,  TASK0_IN_STATE_0,  0,     TASK1_IN_STATE_0 },
+};
+
+HandshakeEngine handshake;
 
 /* Definition of Task Stacks */
 /* Stack grows from HIGH to LOW memory */
 #define   TASK_STACKSIZE       2048
-OS_STK    task0_stk[TASK_STACKSIZE];
-OS_STK    task1_stk[TASK_STACKSIZE];
+#ifndef STACK_SIZES_PROFILED
+#define   TASK0_STACKSIZE      TASK_STACKSIZE
+#define   TASK1_STACKSIZE      TASK_STACKSIZE
+#endif
 
 /* Definition of Task Priorities */
 #define TASK0_PRIORITY      6  // highest priority
 #define TASK1_PRIORITY      7
 
-/* Prints a message and sleeps for given time interval */
-void task0(void* pdata)
-{
-    INT8U err;
-    /*
-       Task		SemaphoreValue	State
-       0		0				0	
-       0		1				1
-       1		0				1
-       1		1				0
-       */
+#ifdef TRACE_RECORDER
+// Builds with -DTRACE_RECORDER dump the scheduler trace once the tasks are done
+#define TRACE_RECORDER_PRIORITY 20
+#define TRACE_DUMP_TICKS 10
 
-#ifdef LIMIT_ITERATIONS
-    int iterations = 0;
-    while (iterations < LIMIT_ITERATIONS)
-#else
-        while (1)
-#endif 
-        { 
-            // wait for task 1 state semaphore to become 1
-            // which means that task 1 is in state 0
-            // OSSemPend will decrease the semaphore to 0 (= "state" 1)
-            OSSemPend(task1StateSemaphore, 0, &err);
-            printf("Task 1 - State 1\n");
-
-            if (err == OS_ERR_NONE) {
-                // signal that task 0 state is now 0 (meaning that the semaphore is state 1)
-                printf("Task 0 - State 1\n");
-                OSSemPost(task0StateSemaphore);
-            }
+void App_TaskSwHook(void)
+{
+    traceRecorderSwitchHook();
+}
 
-#ifdef LIMIT_ITERATIONS
-            iterations++;
+void App_TimeTickHook(void)
+{
+    traceRecorderTickHook();
+}
 #endif
-        }
+
+void printState(HandshakeEngine* engine, INT8U participant, const HandshakeTransition* transition)
+{
+    printf("Task %d - State %d\n", participant, transition->to);
 }
 
-void task1(void* pdata)
+/* Runs one side of the handshake, two transitions per iteration */
+void handshakeTask(void* pdata)
 {
-    INT8U err;
+    INT8U participant = *(INT8U*)pdata;
 
 #ifdef LIMIT_ITERATIONS
-    int iterations = 0;
-    while (iterations < LIMIT_ITERATIONS)
+    handshakeEngineRun(&handshake, participant, 2 * LIMIT_ITERATIONS);
 #else
-        while (1)
-#endif 
-        { 
-            // wait for task 0 state semaphore to become 1 (task 0 state 1)
-            OSSemPend(task0StateSemaphore, 0, &err);
-            printf("Task 0 - State 0\n");
+    handshakeEngineRun(&handshake, participant, 0);
+#endif
+    OSTaskDel(OS_PRIO_SELF);
+}
 
-            if (err == OS_ERR_NONE) {
+INT8U participants[2] = { 0, 1 };
 
-                // signal that task 1 is in state 1
-                printf("Task 1 - State 0\n");
-                OSSemPost(task1StateSemaphore);
-            }
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Task0, handshakeTask, &participants[0], TASK0_PRIORITY, TASK0_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Task1, handshakeTask, &participants[1], TASK1_PRIORITY, TASK1_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
 
-#ifdef LIMIT_ITERATIONS
-            iterations++;
-#endif
-        }
-}
+TASK_TABLE(APP_TASKS);
 
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
     printf("Lab 3 - Handshake\n");
 
-    // initialize semaphores
-    task0StateSemaphore = OSSemCreate(0); // Initialize with state = 0
-    task1StateSemaphore = OSSemCreate(1); // Initialize with state = 0
-
-    OSTaskCreateExt
-        ( task0,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task0_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK0_PRIORITY,               // Desired Task priority
-          TASK0_PRIORITY,               // Task ID
-          &task0_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                                 
-        );
-
-    OSTaskCreateExt
-        ( task1,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task1_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK1_PRIORITY,               // Desired Task priority
-          TASK1_PRIORITY,               // Task ID
-          &task1_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                       
-        );  
+    // both tasks start in state 0 and task 0 moves first
+    if (!handshakeEngineInit(&handshake, handshakeTable, sizeof(handshakeTable) / sizeof(handshakeTable[0]),
+                2, TASK1_IN_STATE_0, printState)) {
+        printf("Invalid handshake table\n");
+        return 1;
+    }
+
+    taskTableCreate(taskTable, taskTableSize);
+
+#ifdef TRACE_RECORDER
+    traceRecorderInit();
+    traceRecorderNameTask(TASK0_PRIORITY, "Task0");
+    traceRecorderNameTask(TASK1_PRIORITY, "Task1");
+    traceRecorderNameTask(TRACE_RECORDER_PRIORITY, "TraceRecorder");
+    traceRecorderNameObject(handshake.flags, "handshake flags");
+    traceRecorderStart(TRACE_RECORDER_PRIORITY, TRACE_DUMP_TICKS);
+#endif
+
+#ifdef STACK_PROFILE
+    stackProfileStart("Handshake");
+#endif
 
     OSStart();
     return 0;
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "HandshakeEngine.h"
+#include "StackProfile.h"
+#include "Timestamp.h"
+
+/*
+ * Transition rate of the event flag handshake engine against the two
+ * semaphore handshake of the original Handshake.c, at 2, 4 and 8 tasks.
+ *
+ * The protocol is a fork/join round: the coordinator releases every worker,
+ * each worker answers once, and the coordinator waits for all the answers
+ * before the next round, N + 1 transitions in all. With semaphores each
+ * worker has a "go" semaphore and all of them post one "done" semaphore,
+ * which the coordinator has to pend once per worker, being readied for
+ * every answer. The engine releases all workers with one post and readies
+ * the coordinator once, when the last answer arrives. With 2 tasks both
+ * are the ping-pong of Handshake.c.
+ */
+
+#define ROUNDS_PER_RUN      10000
+#define MAX_PARTICIPANTS    8
+
+const int participantCounts[] = { 2, 4, 8 };
+
+// Worker i (1..N-1) is released with flag bit i-1 and answers with bit i+7
+#define GO_FLAG(worker)     ((OS_FLAGS)1 << ((worker) - 1))
+#define DONE_FLAG(worker)   ((OS_FLAGS)1 << ((worker) + 7))
+
+HandshakeTransition forkJoinTable[MAX_PARTICIPANTS + 1];
+HandshakeEngine engine;
+
+OS_EVENT *goSemaphores[MAX_PARTICIPANTS];
+OS_EVENT *doneSemaphore;
+
+OS_EVENT *runDoneSemaphore;
+int participants;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   COORDINATOR_TASK_STACKSIZE TASK_STACKSIZE
+#define   WORKER_TASK_STACKSIZE TASK_STACKSIZE
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+OS_STK    coordinator_task_stk[COORDINATOR_TASK_STACKSIZE];
+OS_STK    worker_task_stk[MAX_PARTICIPANTS][WORKER_TASK_STACKSIZE];
+OS_STK    benchmark_task_stk[BENCHMARK_TASK_STACKSIZE];
+
+/* Definition of Task Priorities */
+#define COORDINATOR_TASK_PRIORITY   6
+#define FIRST_WORKER_PRIORITY       7   // worker i runs at FIRST_WORKER_PRIORITY + i - 1
+#define BENCHMARK_TASK_PRIORITY     20  // only runs once a run is done
+
+INT8U workerIndexes[MAX_PARTICIPANTS];
+
+/* The coordinator is participant 0: state 0 releases, state 1 collects */
+int buildForkJoinTable(int count)
+{
+    OS_FLAGS go = 0;
+    OS_FLAGS done = 0;
+    HandshakeTransition* transition = forkJoinTable;
+    int i;
+
+    for (i = 1; i < count; i++) {
+        go |= GO_FLAG(i);
+        done |= DONE_FLAG(i);
+    }
+
+    transition->participant = 0;
+    transition->from = 0;
+    transition->to = 1;
+    transition->wait = 0;
+    transition->consume = 0;
+    transition->clear = 0;
+    transition->set = go;
+    transition++;
+
+    transition->participant = 0;
+    transition->from = 1;
+    transition->to = 0;
+    transition->wait = done;
+    transition->consume = done;
+    transition->clear = 0;
+    transition->set = 0;
+    transition++;
+
+    for (i = 1; i < count; i++) {
+        transition->participant = i;
+        transition->from = 0;
+        transition->to = 0;
+        transition->wait = GO_FLAG(i);
+        transition->consume = GO_FLAG(i);
+        transition->clear = 0;
+        transition->set = DONE_FLAG(i);
+        transition++;
+    }
+    return transition - forkJoinTable;
+}
+
+void engineCoordinatorTask(void* pdata)
+{
+    handshakeEngineRun(&engine, 0, 2 * ROUNDS_PER_RUN);
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void engineWorkerTask(void* pdata)
+{
+    handshakeEngineRun(&engine, *(INT8U*)pdata, ROUNDS_PER_RUN);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void semaphoreCoordinatorTask(void* pdata)
+{
+    INT8U err;
+    int round;
+    int i;
+
+    for (round = 0; round < ROUNDS_PER_RUN; round++) {
+        for (i = 1; i < participants; i++)
+            OSSemPost(goSemaphores[i]);
+        for (i = 1; i < participants; i++)
+            OSSemPend(doneSemaphore, 0, &err);
+    }
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void semaphoreWorkerTask(void* pdata)
+{
+    INT8U worker = *(INT8U*)pdata;
+    INT8U err;
+    int round;
+
+    for (round = 0; round < ROUNDS_PER_RUN; round++) {
+        OSSemPend(goSemaphores[worker], 0, &err);
+        OSSemPost(doneSemaphore);
+    }
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void createTask(void (*task)(void*), void* pdata, OS_STK* stack, INT32U stackSize, INT8U priority)
+{
+    OSTaskCreateExt
+        ( task,                         // Pointer to task code
+          pdata,                        // Pointer to argument passed to task
+          &stack[stackSize-1],          // Pointer to top of task stack
+          priority,                     // Desired Task priority
+          priority,                     // Task ID
+          &stack[0],                    // Pointer to bottom of task stack
+          stackSize,                    // Stacksize
+          NULL,                         // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK           // Stack Checking enabled
+        );
+}
+
+/* Runs ROUNDS_PER_RUN rounds with the given tasks and prints the rates */
+void runBenchmark(const char* name, void (*coordinator)(void*), void (*worker)(void*))
+{
+    INT8U err;
+    alt_u32 contextSwitches;
+    alt_u64 elapsed;
+    double seconds;
+    int i;
+
+    contextSwitches = OSCtxSwCtr;
+    elapsed = timestampNow();
+
+    // the workers block on their first wait until the coordinator starts
+#ifdef STACK_PROFILE
+    OSSchedLock();
+#endif
+    for (i = 1; i < participants; i++) {
+        workerIndexes[i] = i;
+        createTask(worker, &workerIndexes[i], worker_task_stk[i], WORKER_TASK_STACKSIZE, FIRST_WORKER_PRIORITY + i - 1);
+    }
+    createTask(coordinator, NULL, coordinator_task_stk, COORDINATOR_TASK_STACKSIZE, COORDINATOR_TASK_PRIORITY);
+#ifdef STACK_PROFILE
+    for (i = 1; i < participants; i++)
+        stackProfileAdd(FIRST_WORKER_PRIORITY + i - 1, "WORKER_TASK_STACKSIZE");
+    stackProfileAdd(COORDINATOR_TASK_PRIORITY, "COORDINATOR_TASK_STACKSIZE");
+    OSSchedUnlock();
+#endif
+
+    OSSemPend(runDoneSemaphore, 0, &err);
+    elapsed = timestampNow() - elapsed;
+    contextSwitches = OSCtxSwCtr - contextSwitches;
+
+    seconds = (double)elapsed / timestampFrequency();
+    printf("%5d  %-9s  %10.0f  %15.0f  %14.2f\n",
+            participants, name,
+            ROUNDS_PER_RUN / seconds,
+            ROUNDS_PER_RUN * (double)(participants + 1) / seconds,
+            (double)contextSwitches / ROUNDS_PER_RUN);
+    // a run is a handful of milliseconds of host scheduling, too noisy to gate on
+    BENCHMARK_METRIC(ROUNDS_PER_RUN * (double)(participants + 1) / seconds, "transitions/s",
+            BENCHMARK_HIGHER_IS_BETTER | BENCHMARK_INFORMATIONAL, "%s %d", name, participants);
+}
+
+void benchmarkTask(void* pdata)
+{
+    INT8U err;
+    unsigned int run;
+    int i;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d fork/join rounds per run, N + 1 transitions per round\n", ROUNDS_PER_RUN);
+    printf("tasks  mechanism  rounds/sec  transitions/sec  switches/round\n");
+
+    for (run = 0; run < sizeof(participantCounts) / sizeof(participantCounts[0]); run++) {
+        participants = participantCounts[run];
+
+        doneSemaphore = OSSemCreate(0);
+        for (i = 1; i < participants; i++)
+            goSemaphores[i] = OSSemCreate(0);
+        runBenchmark("semaphore", semaphoreCoordinatorTask, semaphoreWorkerTask);
+        OSSemDel(doneSemaphore, OS_DEL_ALWAYS, &err);
+        for (i = 1; i < participants; i++)
+            OSSemDel(goSemaphores[i], OS_DEL_ALWAYS, &err);
+
+        if (!handshakeEngineInit(&engine, forkJoinTable, buildForkJoinTable(participants), participants, 0, NULL)) {
+            printf("Invalid fork/join table for %d tasks\n", participants);
+            break;
+        }
+        runBenchmark("flags", engineCoordinatorTask, engineWorkerTask);
+        handshakeEngineDelete(&engine);
+    }
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The main function creates the benchmark task and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Handshake engine\n");
+
+    runDoneSemaphore = OSSemCreate(0);
+
+    OSTaskCreateExt
+        ( benchmarkTask,                                    // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &benchmark_task_stk[BENCHMARK_TASK_STACKSIZE-1],  // Pointer to top of task stack
+          BENCHMARK_TASK_PRIORITY,                          // Desired Task priority
+          BENCHMARK_TASK_PRIORITY,                          // Task ID
+          &benchmark_task_stk[0],                           // Pointer to bottom of task stack
+          BENCHMARK_TASK_STACKSIZE,                         // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(BENCHMARK_TASK_PRIORITY, "BENCHMARK_TASK_STACKSIZE");
+    stackProfileStart("HandshakeBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
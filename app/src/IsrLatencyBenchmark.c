@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "IrqTimer.h"
+#include "LatencyHistogram.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "Timestamp.h"
+
+/*
+ * Interrupt-to-task latency: the periodic interrupt of lib/IrqTimer posts
+ * a semaphore from its ISR and the handler task, above all others, pends
+ * on it.
+ *
+ * The ISR takes a timestamp as it starts and the handler task another as
+ * it wakes up. Per interrupt this gives the ISR entry latency, from the
+ * interrupt being raised to its ISR running, and the ISR-to-task latency,
+ * from the ISR to the handler task running once OSIntExit() switched to
+ * it. Both go in histograms, first with the CPU otherwise idle and then
+ * while two load tasks shaped like task1 and task2 of TwoTasks.c keep it
+ * busy: each works for a while and then sleeps for the delay of its
+ * TwoTasks counterpart. An interrupt whose semaphore post had not been
+ * taken yet when the next one came is counted as overrun, not measured.
+ */
+
+#define INTERRUPT_PERIOD_US     500
+#define INTERRUPTS_PER_RUN      1000
+
+#define LOAD1_WORK_US           40000
+#define LOAD1_DELAY_MS          111
+#define LOAD2_WORK_US           2000
+#define LOAD2_DELAY_MS          4
+
+OS_EVENT* interruptSemaphore;
+OS_EVENT* runDoneSemaphore;
+
+// Written by the ISR, read by the handler task with interrupts disabled
+alt_u64 isrRaised;
+alt_u64 isrEntered;
+alt_u32 isrCount;
+
+LatencyHistogram isrEntryHistogram;
+LatencyHistogram isrToTaskHistogram;
+alt_u32 samples;
+alt_u32 overruns;
+
+volatile alt_u8 loading;
+volatile alt_u8 finished;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   HANDLER_TASK_STACKSIZE TASK_STACKSIZE
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#define   LOAD1_TASK_STACKSIZE TASK_STACKSIZE
+#define   LOAD2_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+
+/* Definition of Task Priorities */
+#define HANDLER_TASK_PRIORITY       4
+#define BENCHMARK_TASK_PRIORITY     5
+#define LOAD1_TASK_PRIORITY         6
+#define LOAD2_TASK_PRIORITY         7
+
+void timerIsr(alt_u64 raised, void* context)
+{
+    alt_u64 entered = timestampNow();
+
+    isrRaised = raised;
+    isrEntered = entered;
+    isrCount++;
+    OSSemPost(interruptSemaphore);
+}
+
+void handlerTask(void* pdata)
+{
+    OS_CPU_SR cpu_sr = 0;
+    alt_u64 woken;
+    alt_u64 raised;
+    alt_u64 entered;
+    alt_u32 count;
+    alt_u32 handled = 0;
+    INT8U err;
+
+    while (1) {
+        OSSemPend(interruptSemaphore, 0, &err);
+        woken = timestampNow();
+
+        OS_ENTER_CRITICAL();
+        raised = isrRaised;
+        entered = isrEntered;
+        count = isrCount;
+        OS_EXIT_CRITICAL();
+
+        // a post of an interrupt that was counted as overrun
+        if (count == handled)
+            continue;
+        // the ISR ran again before this task did: its times are those of a later interrupt
+        if (count != handled + 1) {
+            overruns += count - handled - 1;
+            handled = count;
+            continue;
+        }
+        handled = count;
+
+        if (samples == INTERRUPTS_PER_RUN)
+            continue;
+        latencyHistogramRecord(&isrEntryHistogram, entered - raised);
+        latencyHistogramRecord(&isrToTaskHistogram, woken - entered);
+        if (++samples == INTERRUPTS_PER_RUN)
+            OSSemPost(runDoneSemaphore);
+    }
+}
+
+/*
+ * Keeps the CPU busy for the given time. The kernel call in the loop is
+ * where the host takes an interrupt; on the board it may come anywhere.
+ */
+void busyFor(alt_u32 us)
+{
+    alt_u64 end = timestampNow() + (alt_u64)us * timestampFrequency() / 1000000;
+
+    while (timestampNow() < end)
+        OSTimeGet();
+}
+
+void load1Task(void* pdata)
+{
+    while (!finished) {
+        if (loading)
+            busyFor(LOAD1_WORK_US);
+        OSTimeDlyHMSM(0, 0, 0, LOAD1_DELAY_MS);
+    }
+}
+
+void load2Task(void* pdata)
+{
+    while (!finished) {
+        if (loading)
+            busyFor(LOAD2_WORK_US);
+        OSTimeDlyHMSM(0, 0, 0, LOAD2_DELAY_MS);
+    }
+}
+
+double nsOf(alt_u64 cycles)
+{
+    return (double)cycles * 1e9 / timestampFrequency();
+}
+
+/* Measures INTERRUPTS_PER_RUN interrupts; returns 0 when there is no timer for them */
+int run(const char* name, alt_u8 load)
+{
+    INT8U err;
+
+    latencyHistogramReset(&isrEntryHistogram);
+    latencyHistogramReset(&isrToTaskHistogram);
+    samples = 0;
+    overruns = 0;
+    loading = load;
+
+    if (!irqTimerStart(INTERRUPT_PERIOD_US, timerIsr, NULL))
+        return 0;
+    OSSemPend(runDoneSemaphore, 0, &err);
+    irqTimerStop();
+    loading = 0;
+
+    printf("\n%s, %lu interrupts, %lu overrun:\n", name, (unsigned long)samples, (unsigned long)overruns);
+    latencyHistogramPrint(&isrEntryHistogram, "ISR entry", timestampFrequency());
+    latencyHistogramPrint(&isrToTaskHistogram, "ISR to task", timestampFrequency());
+
+    BENCHMARK_METRIC(nsOf(latencyHistogramPercentile(&isrEntryHistogram, LATENCY_P50)), "ns",
+            BENCHMARK_LOWER_IS_BETTER, "isr entry p50 %s", name);
+    BENCHMARK_METRIC(nsOf(latencyHistogramPercentile(&isrEntryHistogram, LATENCY_P99)), "ns",
+            BENCHMARK_LOWER_IS_BETTER, "isr entry p99 %s", name);
+    BENCHMARK_METRIC(nsOf(latencyHistogramPercentile(&isrToTaskHistogram, LATENCY_P50)), "ns",
+            BENCHMARK_LOWER_IS_BETTER, "isr to task p50 %s", name);
+    BENCHMARK_METRIC(nsOf(latencyHistogramPercentile(&isrToTaskHistogram, LATENCY_P99)), "ns",
+            BENCHMARK_LOWER_IS_BETTER, "isr to task p99 %s", name);
+    return 1;
+}
+
+void benchmarkTask(void* pdata)
+{
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("Interrupt every %d us, load tasks working %d us then sleeping %d ms and %d us then %d ms\n",
+            INTERRUPT_PERIOD_US, LOAD1_WORK_US, LOAD1_DELAY_MS, LOAD2_WORK_US, LOAD2_DELAY_MS);
+    if (run("idle", 0))
+        run("loaded", 1);
+    else
+        printf("No interrupt timer on this board (see lib/IrqTimer.h)\n");
+
+    finished = 1;
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Handler, handlerTask, NULL, HANDLER_TASK_PRIORITY, HANDLER_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Benchmark, benchmarkTask, NULL, BENCHMARK_TASK_PRIORITY, BENCHMARK_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Load1, load1Task, NULL, LOAD1_TASK_PRIORITY, LOAD1_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Load2, load2Task, NULL, LOAD2_TASK_PRIORITY, LOAD2_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
+/* The main function creates the handler, benchmark and load tasks and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Interrupt to task latency\n");
+
+    interruptSemaphore = OSSemCreate(0);
+    runDoneSemaphore = OSSemCreate(0);
+    taskTableCreate(taskTable, taskTableSize);
+
+#ifdef STACK_PROFILE
+    stackProfileStart("IsrLatencyBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "MessageRing.h"
+#include "StackProfile.h"
+#include "Timestamp.h"
+
+/*
+ * Throughput of the zero-copy message ring against the semaphore handshake
+ * of the original SharedMemory.c, for payloads from 2 B to 4 KB.
+ *
+ * In both cases the producer writes the whole payload in place and the
+ * consumer reads all of it. The handshake shares a single buffer and needs
+ * a post/pend pair in each direction per message; the ring lets the
+ * producer run up to RING_SLOTS messages ahead. The 10 ms sleeps of the
+ * original handshake are left out, with them it is capped at 50 messages
+ * per second whatever the payload.
+ */
+
+#define MESSAGES_PER_RUN    20000
+#define MIN_PAYLOAD         2
+#define MAX_PAYLOAD         4096
+#define RING_SLOTS          16
+
+alt_u32 ringPool[MESSAGE_RING_POOL_WORDS(MAX_PAYLOAD, RING_SLOTS)];
+MessageRing ring;
+
+// Handshake: one shared buffer, "full" posted by the producer and "empty" by the consumer
+alt_u32 handshakeBuffer[MAX_PAYLOAD / 4];
+OS_EVENT *bufferFullSemaphore;
+OS_EVENT *bufferEmptySemaphore;
+
+OS_EVENT *runDoneSemaphore;
+alt_u32 payloadSize;
+volatile alt_u32 checksum;   // keeps the consumer's reads from being optimised away
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   PRODUCER_TASK_STACKSIZE TASK_STACKSIZE
+#define   CONSUMER_TASK_STACKSIZE TASK_STACKSIZE
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+OS_STK    producer_task_stk[PRODUCER_TASK_STACKSIZE];
+OS_STK    consumer_task_stk[CONSUMER_TASK_STACKSIZE];
+OS_STK    benchmark_task_stk[BENCHMARK_TASK_STACKSIZE];
+
+/* Definition of Task Priorities */
+#define PRODUCER_TASK_PRIORITY      6
+#define CONSUMER_TASK_PRIORITY      7
+#define BENCHMARK_TASK_PRIORITY     8   // only runs once both sides are done
+
+alt_u32 readPayload(const alt_u8* payload, alt_u32 length)
+{
+    alt_u32 sum = 0;
+    alt_u32 i;
+
+    for (i = 0; i < length; i++)
+        sum += payload[i];
+    return sum;
+}
+
+void ringProducerTask(void* pdata)
+{
+    alt_u32 i;
+
+    for (i = 0; i < MESSAGES_PER_RUN; i++) {
+        memset(messageRingClaim(&ring), (int)i, payloadSize);
+        messageRingPublish(&ring, payloadSize);
+    }
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void ringConsumerTask(void* pdata)
+{
+    alt_u32 sum = 0;
+    alt_u32 length;
+    alt_u32 i;
+
+    for (i = 0; i < MESSAGES_PER_RUN; i++) {
+        sum += readPayload(messageRingReceive(&ring, &length), length);
+        messageRingRelease(&ring);
+    }
+    checksum = sum;
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void handshakeProducerTask(void* pdata)
+{
+    INT8U err;
+    alt_u32 i;
+
+    for (i = 0; i < MESSAGES_PER_RUN; i++) {
+        OSSemPend(bufferEmptySemaphore, 0, &err);
+        memset(handshakeBuffer, (int)i, payloadSize);
+        OSSemPost(bufferFullSemaphore);
+    }
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void handshakeConsumerTask(void* pdata)
+{
+    INT8U err;
+    alt_u32 sum = 0;
+    alt_u32 i;
+
+    for (i = 0; i < MESSAGES_PER_RUN; i++) {
+        OSSemPend(bufferFullSemaphore, 0, &err);
+        sum += readPayload((const alt_u8*)handshakeBuffer, payloadSize);
+        OSSemPost(bufferEmptySemaphore);
+    }
+    checksum = sum;
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* Runs one producer/consumer pair to completion and prints its throughput */
+void runBenchmark(const char* name, void (*producer)(void*), void (*consumer)(void*))
+{
+    INT8U err;
+    alt_u32 contextSwitches;
+    alt_u64 elapsed;
+    double seconds;
+
+    contextSwitches = OSCtxSwCtr;
+    elapsed = timestampNow();
+
+#ifdef STACK_PROFILE
+    // register both sides before the producer gets to run and finish
+    OSSchedLock();
+#endif
+    OSTaskCreateExt
+        ( producer,                                      // Pointer to task code
+          NULL,                                          // Pointer to argument passed to task
+          &producer_task_stk[PRODUCER_TASK_STACKSIZE-1], // Pointer to top of task stack
+          PRODUCER_TASK_PRIORITY,                        // Desired Task priority
+          PRODUCER_TASK_PRIORITY,                        // Task ID
+          &producer_task_stk[0],                         // Pointer to bottom of task stack
+          PRODUCER_TASK_STACKSIZE,                       // Stacksize
+          NULL,                                          // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK                            // Stack Checking enabled
+        );
+
+    OSTaskCreateExt
+        ( consumer,                                      // Pointer to task code
+          NULL,                                          // Pointer to argument passed to task
+          &consumer_task_stk[CONSUMER_TASK_STACKSIZE-1], // Pointer to top of task stack
+          CONSUMER_TASK_PRIORITY,                        // Desired Task priority
+          CONSUMER_TASK_PRIORITY,                        // Task ID
+          &consumer_task_stk[0],                         // Pointer to bottom of task stack
+          CONSUMER_TASK_STACKSIZE,                       // Stacksize
+          NULL,                                          // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK                            // Stack Checking enabled
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(PRODUCER_TASK_PRIORITY, "PRODUCER_TASK_STACKSIZE");
+    stackProfileAdd(CONSUMER_TASK_PRIORITY, "CONSUMER_TASK_STACKSIZE");
+    OSSchedUnlock();
+#endif
+
+    OSSemPend(runDoneSemaphore, 0, &err);
+    elapsed = timestampNow() - elapsed;
+    contextSwitches = OSCtxSwCtr - contextSwitches;
+
+    seconds = (double)elapsed / timestampFrequency();
+    printf("%7lu  %-9s  %12.0f  %10.2f  %8.2f\n",
+            (unsigned long)payloadSize, name,
+            MESSAGES_PER_RUN / seconds,
+            MESSAGES_PER_RUN * (double)payloadSize / seconds / 1e6,
+            (double)contextSwitches / MESSAGES_PER_RUN);
+    // a run is a handful of milliseconds of host scheduling, too noisy to gate on
+    BENCHMARK_METRIC(MESSAGES_PER_RUN / seconds, "msg/s", BENCHMARK_HIGHER_IS_BETTER | BENCHMARK_INFORMATIONAL,
+            "%s %lu", name, (unsigned long)payloadSize);
+}
+
+void benchmarkTask(void* pdata)
+{
+    INT8U err;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d messages per run, %d ring slots\n", MESSAGES_PER_RUN, RING_SLOTS);
+    printf("payload  mechanism  messages/sec    MB/sec  switches/msg\n");
+
+    for (payloadSize = MIN_PAYLOAD; payloadSize <= MAX_PAYLOAD; payloadSize *= 2) {
+        messageRingInit(&ring, ringPool, payloadSize, RING_SLOTS);
+        runBenchmark("ring", ringProducerTask, ringConsumerTask);
+        messageRingDelete(&ring);
+
+        bufferFullSemaphore = OSSemCreate(0);
+        bufferEmptySemaphore = OSSemCreate(1);
+        runBenchmark("handshake", handshakeProducerTask, handshakeConsumerTask);
+        OSSemDel(bufferFullSemaphore, OS_DEL_ALWAYS, &err);
+        OSSemDel(bufferEmptySemaphore, OS_DEL_ALWAYS, &err);
+    }
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The main function creates the benchmark task and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Message ring throughput\n");
+
+    runDoneSemaphore = OSSemCreate(0);
+
+    OSTaskCreateExt
+        ( benchmarkTask,                                   // Pointer to task code
+          NULL,                                            // Pointer to argument passed to task
+          &benchmark_task_stk[BENCHMARK_TASK_STACKSIZE-1], // Pointer to top of task stack
+          BENCHMARK_TASK_PRIORITY,                         // Desired Task priority
+          BENCHMARK_TASK_PRIORITY,                         // Task ID
+          &benchmark_task_stk[0],                          // Pointer to bottom of task stack
+          BENCHMARK_TASK_STACKSIZE,                        // Stacksize
+          NULL,                                            // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                            // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                              // Stack Cleared
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(BENCHMARK_TASK_PRIORITY, "BENCHMARK_TASK_STACKSIZE");
+    stackProfileStart("MessageRingBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
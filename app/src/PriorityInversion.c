@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "LatencyHistogram.h"
+#include "ResourceGuard.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "Timestamp.h"
+
+/*
+ * Three-task priority inversion benchmark.
+ *
+ * The low priority task takes the guard and, while still holding it,
+ * releases the high and the medium priority task at once with a single
+ * event flag post (as an interrupt would). The high task immediately asks
+ * for the guard and blocks. With a semaphore the medium task now runs its
+ * whole workload before the low task can finish its critical section;
+ * with the mutex the low task runs at the ceiling and the medium task has
+ * to wait. The time from the high task's lock request until it holds the
+ * guard is recorded for every iteration, in both modes.
+ */
+
+#define ITERATIONS          1000
+#define LOW_HOLD_US         50      // critical section left after the release
+#define MEDIUM_WORK_US      500     // CPU-bound work of the medium task
+
+#define RELEASE_HIGH        0x01
+#define RELEASE_MEDIUM      0x02
+
+ResourceGuard sharedGuard;
+OS_FLAG_GRP *releaseFlags;
+OS_EVENT *runStartSemaphore;
+OS_EVENT *runDoneSemaphore;
+
+LatencyHistogram blockingHistogram;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   CONTROLLER_TASK_STACKSIZE TASK_STACKSIZE
+#define   HIGH_TASK_STACKSIZE  TASK_STACKSIZE
+#define   MEDIUM_TASK_STACKSIZE TASK_STACKSIZE
+#define   LOW_TASK_STACKSIZE   TASK_STACKSIZE
+#endif
+
+/* Definition of Task Priorities */
+#define CONTROLLER_TASK_PRIORITY    4
+#define GUARD_CEILING_PRIORITY      5
+#define HIGH_TASK_PRIORITY          6
+#define MEDIUM_TASK_PRIORITY        7
+#define LOW_TASK_PRIORITY           8
+
+/* Burns CPU time without giving up the processor */
+void spinFor(alt_u32 microseconds)
+{
+    alt_u64 start = timestampNow();
+    alt_u64 cycles = timestampFrequency() * microseconds / 1000000;
+
+    while (timestampNow() - start < cycles)
+        ;
+}
+
+void highTask(void* pdata)
+{
+    INT8U err;
+    alt_u64 start;
+
+    while (1) {
+        OSFlagPend(releaseFlags, RELEASE_HIGH, OS_FLAG_WAIT_SET_ALL + OS_FLAG_CONSUME, 0, &err);
+
+        start = timestampNow();
+        if (resourceGuardLock(&sharedGuard) == OS_ERR_NONE) {
+            latencyHistogramRecord(&blockingHistogram, timestampNow() - start);
+            resourceGuardUnlock(&sharedGuard);
+        }
+    }
+}
+
+void mediumTask(void* pdata)
+{
+    INT8U err;
+
+    while (1) {
+        OSFlagPend(releaseFlags, RELEASE_MEDIUM, OS_FLAG_WAIT_SET_ALL + OS_FLAG_CONSUME, 0, &err);
+        spinFor(MEDIUM_WORK_US);
+    }
+}
+
+void lowTask(void* pdata)
+{
+    INT8U err;
+    int i;
+
+    while (1) {
+        OSSemPend(runStartSemaphore, 0, &err);
+
+        for (i = 0; i < ITERATIONS; i++) {
+            resourceGuardLock(&sharedGuard);
+            OSFlagPost(releaseFlags, RELEASE_HIGH | RELEASE_MEDIUM, OS_FLAG_SET, &err);
+            spinFor(LOW_HOLD_US);
+            resourceGuardUnlock(&sharedGuard);
+
+            // let the other two finish before the next round
+            OSTimeDly(1);
+        }
+
+        OSSemPost(runDoneSemaphore);
+    }
+}
+
+void runMode(ResourceGuardMode mode)
+{
+    INT8U err;
+    alt_u64 frequency = timestampFrequency();
+
+    latencyHistogramReset(&blockingHistogram);
+    resourceGuardCreate(&sharedGuard, mode, GUARD_CEILING_PRIORITY);
+
+    OSSemPost(runStartSemaphore);
+    OSSemPend(runDoneSemaphore, 0, &err);
+
+    resourceGuardDelete(&sharedGuard);
+
+    printf("%-9s  worst %8llu ns  p99 %8llu ns  mean %8llu ns  (%lu samples)\n",
+            resourceGuardModeName(mode),
+            (unsigned long long)(blockingHistogram.max * 1000000000ULL / frequency),
+            (unsigned long long)(latencyHistogramPercentile(&blockingHistogram, LATENCY_P99) * 1000000000ULL / frequency),
+            (unsigned long long)(latencyHistogramMean(&blockingHistogram) * 1000000000ULL / frequency),
+            (unsigned long)blockingHistogram.count);
+    BENCHMARK_METRIC(latencyHistogramMean(&blockingHistogram) * 1e9 / frequency, "ns",
+            BENCHMARK_LOWER_IS_BETTER, "%s blocking mean", resourceGuardModeName(mode));
+}
+
+void controllerTask(void* pdata)
+{
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("Blocking of the high priority task: %d us left in the critical section, "
+            "%d us of medium priority work\n", LOW_HOLD_US, MEDIUM_WORK_US);
+    runMode(RESOURCE_GUARD_SEMAPHORE);
+    runMode(RESOURCE_GUARD_MUTEX);
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    OSTaskDel(HIGH_TASK_PRIORITY);
+    OSTaskDel(MEDIUM_TASK_PRIORITY);
+    OSTaskDel(LOW_TASK_PRIORITY);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Controller, controllerTask, NULL, CONTROLLER_TASK_PRIORITY, CONTROLLER_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(High, highTask, NULL, HIGH_TASK_PRIORITY, HIGH_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Medium, mediumTask, NULL, MEDIUM_TASK_PRIORITY, MEDIUM_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Low, lowTask, NULL, LOW_TASK_PRIORITY, LOW_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
+/* The main function creates the four tasks and starts multi-tasking */
+int main(void)
+{
+    INT8U err;
+
+    printf("Lab 3 - Priority inversion\n");
+
+    releaseFlags = OSFlagCreate(0, &err);
+    runStartSemaphore = OSSemCreate(0);
+    runDoneSemaphore = OSSemCreate(0);
+
+    taskTableCreate(taskTable, taskTableSize);
+
+#ifdef STACK_PROFILE
+    stackProfileStart("PriorityInversion");
+#endif
+
+    OSStart();
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "ReadyBitmap.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "Timestamp.h"
+#include "WorkerScheduler.h"
+
+/*
+ * Cost of a scheduling decision against the number of tasks, for the
+ * ready list of lib/ReadyBitmap and the OSUnMapTbl ready list of the
+ * kernel, and the cost per step of lib/WorkerScheduler running that many
+ * workers.
+ *
+ * A decision cycle is what the ready list goes through when the running
+ * task blocks and is readied again: the highest is looked up and taken
+ * out, the next one is looked up and the first is put back. The tasks
+ * are either spread over the priorities, one per priority as far as they
+ * go, or all share one priority. The kernel's list has 64 priorities and
+ * one task in each, so it only has the spread rows up to 64 tasks.
+ *
+ * The worker rows run STEPS_PER_RUN steps split over the workers, which
+ * either yield after every step (round-robin) or keep running until their
+ * time slice is used up.
+ */
+
+#define DECISIONS_PER_RUN   100000
+#define STEPS_PER_RUN       100000
+#define MAX_TASKS           1024
+#define TIME_SLICE_US       100
+
+const int taskCounts[] = { 1, 8, 64, 256, 1024 };
+
+typedef enum {
+    LAYOUT_SPREAD,
+    LAYOUT_SHARED
+} Layout;
+
+const char* const layoutNames[] = { "spread", "shared" };
+
+ReadyBitmap bitmap;
+ReadyNode nodes[MAX_TASKS];
+Worker workers[MAX_TASKS];
+volatile int decisionSink;          // keeps the lookups the results are not used of
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+
+/* Definition of Task Priorities */
+#define WORKER_SCHED_PRIORITY       10
+#define BENCHMARK_TASK_PRIORITY     20  // only runs once the workers are done
+
+/* Priority of task i of count */
+alt_u16 taskPriority(Layout layout, int i, int count, int levels)
+{
+    if (layout == LAYOUT_SHARED)
+        return levels / 2;
+    return count <= levels ? i * (levels / count) : i % levels;
+}
+
+double nsPer(alt_u64 elapsed, alt_u32 count)
+{
+    return (double)elapsed * 1e9 / timestampFrequency() / count;
+}
+
+double bitmapDecisionCost(Layout layout, int count)
+{
+    ReadyNode* node;
+    alt_u64 elapsed;
+    int i;
+
+    readyBitmapInit(&bitmap);
+    for (i = 0; i < count; i++)
+        readyBitmapInsert(&bitmap, &nodes[i], taskPriority(layout, i, count, READY_BITMAP_LEVELS));
+
+    elapsed = timestampNow();
+    for (i = 0; i < DECISIONS_PER_RUN; i++) {
+        node = readyBitmapHighest(&bitmap);
+        readyBitmapRemove(&bitmap, node);
+        decisionSink = readyBitmapHighest(&bitmap) != NULL;
+        readyBitmapInsert(&bitmap, node, node->priority);
+    }
+    elapsed = timestampNow() - elapsed;
+
+    return nsPer(elapsed, DECISIONS_PER_RUN);
+}
+
+/* The ready list of the kernel: OSRdyGrp, OSRdyTbl and OSUnMapTbl */
+INT8U unmapGroup;
+INT8U unmapTable[8];
+
+static inline INT8U unmapHighest(void)
+{
+    INT8U y = OSUnMapTbl[unmapGroup];
+
+    return (INT8U)((y << 3) + OSUnMapTbl[unmapTable[y]]);
+}
+
+static inline void unmapRemove(INT8U priority)
+{
+    INT8U y = priority >> 3;
+
+    unmapTable[y] &= ~(1 << (priority & 7));
+    if (unmapTable[y] == 0)
+        unmapGroup &= ~(1 << y);
+}
+
+static inline void unmapInsert(INT8U priority)
+{
+    unmapGroup |= 1 << (priority >> 3);
+    unmapTable[priority >> 3] |= 1 << (priority & 7);
+}
+
+double unmapDecisionCost(int count)
+{
+    alt_u64 elapsed;
+    INT8U priority;
+    int i;
+
+    unmapGroup = 0;
+    memset(unmapTable, 0, sizeof(unmapTable));
+    for (i = 0; i < count; i++)
+        unmapInsert(taskPriority(LAYOUT_SPREAD, i, count, 64));
+
+    elapsed = timestampNow();
+    for (i = 0; i < DECISIONS_PER_RUN; i++) {
+        priority = unmapHighest();
+        unmapRemove(priority);
+        decisionSink = unmapHighest();
+        unmapInsert(priority);
+    }
+    elapsed = timestampNow() - elapsed;
+
+    return nsPer(elapsed, DECISIONS_PER_RUN);
+}
+
+alt_u32 stepsPerWorker;
+WorkerResult stepResult;
+Worker* lastWorker;
+alt_u32 workerSwitches;
+
+WorkerResult countingStep(Worker* worker)
+{
+    if (worker != lastWorker) {
+        workerSwitches++;
+        lastWorker = worker;
+    }
+    return worker->steps + 1 >= stepsPerWorker ? WORKER_DONE : stepResult;
+}
+
+/* Runs STEPS_PER_RUN worker steps and prints a row */
+void runWorkers(Layout layout, int count, WorkerResult result, const char* mode)
+{
+    alt_u32 steps;
+    alt_u64 elapsed;
+    int i;
+
+    stepsPerWorker = STEPS_PER_RUN / count;
+    stepResult = result;
+    lastWorker = NULL;
+    workerSwitches = 0;
+    steps = workerSchedSteps();
+
+    // the dispatcher is above this task, it takes over once the lock goes
+    OSSchedLock();
+    for (i = 0; i < count; i++)
+        workerAdd(&workers[i], countingStep, NULL, taskPriority(layout, i, count, READY_BITMAP_LEVELS));
+    elapsed = timestampNow();
+    OSSchedUnlock();
+    elapsed = timestampNow() - elapsed;
+    steps = workerSchedSteps() - steps;
+
+    printf("%5d  %-6s  %-8s %10.1f %10lu\n", count, layoutNames[layout], mode,
+            nsPer(elapsed, steps), (unsigned long)workerSwitches);
+    BENCHMARK_METRIC(nsPer(elapsed, steps), "ns", BENCHMARK_LOWER_IS_BETTER,
+            "worker step %d %s %s", count, layoutNames[layout], mode);
+}
+
+void benchmarkTask(void* pdata)
+{
+    double cost;
+    Layout layout;
+    unsigned int k;
+    int count;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d decision cycles per run, %d priority levels\n", DECISIONS_PER_RUN, READY_BITMAP_LEVELS);
+    printf("tasks  layout  bitmap ns/cycle  OSUnMapTbl ns/cycle\n");
+    for (layout = LAYOUT_SPREAD; layout <= LAYOUT_SHARED; layout++) {
+        for (k = 0; k < sizeof(taskCounts) / sizeof(taskCounts[0]); k++) {
+            count = taskCounts[k];
+            cost = bitmapDecisionCost(layout, count);
+            printf("%5d  %-6s  %15.1f", count, layoutNames[layout], cost);
+            BENCHMARK_METRIC(cost, "ns", BENCHMARK_LOWER_IS_BETTER, "bitmap decision %d %s",
+                    count, layoutNames[layout]);
+            if (layout == LAYOUT_SPREAD && count <= 64) {
+                cost = unmapDecisionCost(count);
+                printf("  %19.1f\n", cost);
+                BENCHMARK_METRIC(cost, "ns", BENCHMARK_LOWER_IS_BETTER, "OSUnMapTbl decision %d", count);
+            } else {
+                printf("  %19s\n", "-");
+            }
+        }
+    }
+
+    printf("\n%d worker steps per run, %d us time slice\n", STEPS_PER_RUN, TIME_SLICE_US);
+    printf("tasks  layout  mode        ns/step   switches\n");
+    for (k = 0; k < sizeof(taskCounts) / sizeof(taskCounts[0]); k++)
+        runWorkers(LAYOUT_SPREAD, taskCounts[k], WORKER_YIELD, "yield");
+    for (k = 0; k < sizeof(taskCounts) / sizeof(taskCounts[0]); k++)
+        runWorkers(LAYOUT_SHARED, taskCounts[k], WORKER_YIELD, "yield");
+    for (k = 0; k < sizeof(taskCounts) / sizeof(taskCounts[0]); k++)
+        runWorkers(LAYOUT_SHARED, taskCounts[k], WORKER_CONTINUE, "slice");
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Benchmark, benchmarkTask, NULL, BENCHMARK_TASK_PRIORITY, BENCHMARK_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
+/* The main function creates the benchmark task and the dispatcher and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Scheduler decisions\n");
+
+    taskTableCreate(taskTable, taskTableSize);
+    workerSchedStart(WORKER_SCHED_PRIORITY, TIME_SLICE_US);
+
+#ifdef STACK_PROFILE
+    stackProfileStart("SchedulerBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "FastSemaphore.h"
+#include "StackProfile.h"
+#include "Timestamp.h"
+
+/*
+ * Cost of a post/pend pair of the uC/OS-II semaphore against the fast path
+ * semaphore of lib/FastSemaphore, in three cases:
+ *
+ *   uncontended     one task posts and then pends, the token is always there
+ *                   (the case ContextSwitch.c subtracts as its baseline)
+ *   contended       two tasks hand over back and forth with two semaphores,
+ *                   every pend blocks and every post wakes the other task
+ *   cross-priority  a low priority task posts to a high priority task that
+ *                   is always blocked, so every post switches to the waiter
+ *
+ * Both kinds are called through the same function pointers, so the figures
+ * include one indirect call per operation either way.
+ */
+
+#define PAIRS_PER_RUN       100000
+
+OS_EVENT *osSemaphores[2];
+FastSemaphore fastSemaphores[2];
+
+typedef struct {
+    const char* name;
+    void (*post)(int which);
+    void (*pend)(int which);
+} SemaphoreKind;
+
+void osPost(int which)
+{
+    OSSemPost(osSemaphores[which]);
+}
+
+void osPend(int which)
+{
+    INT8U err;
+
+    OSSemPend(osSemaphores[which], 0, &err);
+}
+
+void fastPost(int which)
+{
+    fastSemPost(&fastSemaphores[which]);
+}
+
+void fastPend(int which)
+{
+    fastSemPend(&fastSemaphores[which]);
+}
+
+const SemaphoreKind kinds[] = {
+    { "OSSem", osPost, osPend },
+    { "fast", fastPost, fastPend }
+};
+
+const SemaphoreKind* kind;
+OS_EVENT *runDoneSemaphore;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   HIGH_TASK_STACKSIZE  TASK_STACKSIZE
+#define   LOW_TASK_STACKSIZE   TASK_STACKSIZE
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+OS_STK    high_task_stk[HIGH_TASK_STACKSIZE];
+OS_STK    low_task_stk[LOW_TASK_STACKSIZE];
+OS_STK    benchmark_task_stk[BENCHMARK_TASK_STACKSIZE];
+
+/* Definition of Task Priorities */
+#define HIGH_TASK_PRIORITY          6
+#define LOW_TASK_PRIORITY           7
+#define BENCHMARK_TASK_PRIORITY     20  // only runs once a run is done
+
+void uncontendedTask(void* pdata)
+{
+    int i;
+
+    for (i = 0; i < PAIRS_PER_RUN; i++) {
+        kind->post(0);
+        kind->pend(0);
+    }
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* Pends on semaphore 0 and answers on semaphore 1 */
+void contendedHighTask(void* pdata)
+{
+    int i;
+
+    for (i = 0; i < PAIRS_PER_RUN / 2; i++) {
+        kind->pend(0);
+        kind->post(1);
+    }
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void contendedLowTask(void* pdata)
+{
+    int i;
+
+    for (i = 0; i < PAIRS_PER_RUN / 2; i++) {
+        kind->post(0);
+        kind->pend(1);
+    }
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void crossPriorityHighTask(void* pdata)
+{
+    int i;
+
+    for (i = 0; i < PAIRS_PER_RUN; i++)
+        kind->pend(0);
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void crossPriorityLowTask(void* pdata)
+{
+    int i;
+
+    for (i = 0; i < PAIRS_PER_RUN; i++)
+        kind->post(0);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void createTask(void (*task)(void*), OS_STK* stack, INT32U stackSize, INT8U priority)
+{
+    OSTaskCreateExt
+        ( task,                         // Pointer to task code
+          NULL,                         // Pointer to argument passed to task
+          &stack[stackSize-1],          // Pointer to top of task stack
+          priority,                     // Desired Task priority
+          priority,                     // Task ID
+          &stack[0],                    // Pointer to bottom of task stack
+          stackSize,                    // Stacksize
+          NULL,                         // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK           // Stack Checking enabled
+        );
+}
+
+/* Runs PAIRS_PER_RUN post/pend pairs with the given tasks and prints a row */
+void runBenchmark(const char* name, void (*high)(void*), void (*low)(void*))
+{
+    alt_u32 contextSwitches;
+    alt_u64 elapsed;
+    INT8U err;
+
+    osSemaphores[0] = OSSemCreate(0);
+    osSemaphores[1] = OSSemCreate(0);
+    fastSemInit(&fastSemaphores[0], 0);
+    fastSemInit(&fastSemaphores[1], 0);
+
+    contextSwitches = OSCtxSwCtr;
+    elapsed = timestampNow();
+
+#ifdef STACK_PROFILE
+    OSSchedLock();
+#endif
+    if (high != NULL)
+        createTask(high, high_task_stk, HIGH_TASK_STACKSIZE, HIGH_TASK_PRIORITY);
+    if (low != NULL)
+        createTask(low, low_task_stk, LOW_TASK_STACKSIZE, LOW_TASK_PRIORITY);
+#ifdef STACK_PROFILE
+    if (high != NULL)
+        stackProfileAdd(HIGH_TASK_PRIORITY, "HIGH_TASK_STACKSIZE");
+    if (low != NULL)
+        stackProfileAdd(LOW_TASK_PRIORITY, "LOW_TASK_STACKSIZE");
+    OSSchedUnlock();
+#endif
+
+    OSSemPend(runDoneSemaphore, 0, &err);
+    elapsed = timestampNow() - elapsed;
+    contextSwitches = OSCtxSwCtr - contextSwitches;
+
+    printf("%-15s %-6s %10.1f %14.2f\n", name, kind->name,
+            (double)elapsed * 1e9 / timestampFrequency() / PAIRS_PER_RUN,
+            (double)contextSwitches / PAIRS_PER_RUN);
+    BENCHMARK_METRIC((double)elapsed * 1e9 / timestampFrequency() / PAIRS_PER_RUN, "ns",
+            BENCHMARK_LOWER_IS_BETTER, "%s %s", name, kind->name);
+
+    OSSemDel(osSemaphores[0], OS_DEL_ALWAYS, &err);
+    OSSemDel(osSemaphores[1], OS_DEL_ALWAYS, &err);
+    fastSemDelete(&fastSemaphores[0]);
+    fastSemDelete(&fastSemaphores[1]);
+}
+
+void benchmarkTask(void* pdata)
+{
+    unsigned int k;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d post/pend pairs per run\n", PAIRS_PER_RUN);
+    printf("case            kind      ns/pair  switches/pair\n");
+
+    for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        kind = &kinds[k];
+        runBenchmark("uncontended", uncontendedTask, NULL);
+    }
+    for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        kind = &kinds[k];
+        runBenchmark("contended", contendedHighTask, contendedLowTask);
+    }
+    for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        kind = &kinds[k];
+        runBenchmark("cross-priority", crossPriorityHighTask, crossPriorityLowTask);
+    }
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The main function creates the benchmark task and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Semaphore fast path\n");
+
+    runDoneSemaphore = OSSemCreate(0);
+
+    OSTaskCreateExt
+        ( benchmarkTask,                                    // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &benchmark_task_stk[BENCHMARK_TASK_STACKSIZE-1],  // Pointer to top of task stack
+          BENCHMARK_TASK_PRIORITY,                          // Desired Task priority
+          BENCHMARK_TASK_PRIORITY,                          // Task ID
+          &benchmark_task_stk[0],                           // Pointer to bottom of task stack
+          BENCHMARK_TASK_STACKSIZE,                         // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(BENCHMARK_TASK_PRIORITY, "BENCHMARK_TASK_STACKSIZE");
+    stackProfileStart("SemaphoreBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
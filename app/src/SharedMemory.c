@@ -1,31 +1,163 @@
 #include <stdio.h>
+#include <stdint.h>
 #include "includes.h"
 #include <string.h>
-
-// Uncomment to limit the number of iterations
+#include "BlockPool.h"
+#include "MessageRing.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "Timestamp.h"
+
+// Uncomment to limit the number of iterations (the host benchmark sets its own)
+#ifndef LIMIT_ITERATIONS
 #define LIMIT_ITERATIONS 10
+#endif
 
-// Define mutex semaphore
-OS_EVENT *task0StateSemaphore;
-OS_EVENT *task1StateSemaphore;
+// Uncomment to stream values from task 1 to task 0 through an OSQ pipeline
+// in batches instead of the request/reply rings, and report items/sec and
+// context switches per item
+//#define PIPELINE_MODE
+
+#ifdef PIPELINE_MODE
+// Items sent per run; every batch size is run in turn unless one is given
+// with -DPIPELINE_BATCH_SIZE=n. Batches larger than the queue are sent a
+// queue full at a time.
+#define PIPELINE_ITEMS 100000
+#ifndef PIPELINE_QUEUE_DEPTH
+#define PIPELINE_QUEUE_DEPTH 32
+#endif
+#ifdef PIPELINE_BATCH_SIZE
+const int pipelineBatchSizes[] = { PIPELINE_BATCH_SIZE };
+#else
+const int pipelineBatchSizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+#endif
 
-INT16S* sharedAddress;
+void* pipelineQueueStorage[PIPELINE_QUEUE_DEPTH];
+OS_EVENT* pipelineQueue;
+
+// Kept by the consumer, read by the producer between runs
+alt_u32 pipelineReceived;
+alt_u32 pipelineWakeups;
+alt_u32 pipelineOutOfOrder;
+INT16S pipelineExpected;
+#else
+// Values travel through two zero-copy rings: task 0 to task 1 and back.
+// Their slots are allocated from the block pool.
+#define RING_SLOTS 8
+#define RING_POOL_WORDS MESSAGE_RING_POOL_WORDS(sizeof(INT16S), RING_SLOTS)
+alt_u32* requestPool;
+alt_u32* replyPool;
+MessageRing requestRing;
+MessageRing replyRing;
+#endif
 
 /* Definition of Task Stacks */
 /* Stack grows from HIGH to LOW memory */
 #define   TASK_STACKSIZE       2048
-OS_STK    task0_stk[TASK_STACKSIZE];
-OS_STK    task1_stk[TASK_STACKSIZE];
+#ifndef STACK_SIZES_PROFILED
+#define   TASK0_STACKSIZE      TASK_STACKSIZE
+#define   TASK1_STACKSIZE      TASK_STACKSIZE
+#endif
 
 /* Definition of Task Priorities */
 #define TASK0_PRIORITY      6  // highest priority
 #define TASK1_PRIORITY      7
 
-/* Prints a message and sleeps for given time interval */
+#ifdef PIPELINE_MODE
+
+/*
+ * Consumer, at the higher priority: each wakeup drains everything in the
+ * queue, checking that the values arrive in order
+ */
 void task0(void* pdata)
 {
+    INT16S value;
     INT8U err;
 
+    while (1) {
+        value = (INT16S)(intptr_t)OSQPend(pipelineQueue, 0, &err);
+        pipelineWakeups++;
+        while (err == OS_ERR_NONE) {
+            if (value != pipelineExpected)
+                pipelineOutOfOrder++;
+            pipelineExpected = value + 1;
+            pipelineReceived++;
+            value = (INT16S)(intptr_t)OSQAccept(pipelineQueue, &err);
+        }
+    }
+}
+
+/*
+ * Producer: enqueues a batch with the scheduler locked, so the consumer is
+ * readied by the first value and runs once the whole batch is in
+ */
+void pipelineSend(INT16S* value, int batch)
+{
+    int i;
+
+    OSSchedLock();
+    for (i = 0; i < batch; i++) {
+        if (OSQPost(pipelineQueue, (void*)(intptr_t)*value) == OS_ERR_Q_FULL) {
+            // let the consumer empty the queue, then go on with the batch
+            OSSchedUnlock();
+            OSSchedLock();
+            i--;
+            continue;
+        }
+        *value = *value + 1;
+    }
+    OSSchedUnlock();
+}
+
+/* Sends PIPELINE_ITEMS values for every batch size and prints the rates */
+void task1(void* pdata)
+{
+    INT16S value = 1;
+    alt_u32 contextSwitches;
+    alt_u64 elapsed;
+    double seconds;
+    unsigned int run;
+    int batch;
+    int sent;
+
+    printf("%d items per run, queue of %d\n", PIPELINE_ITEMS, PIPELINE_QUEUE_DEPTH);
+    printf("batch   items/sec  switches/item  wakeups/item\n");
+
+    for (run = 0; run < sizeof(pipelineBatchSizes) / sizeof(pipelineBatchSizes[0]); run++) {
+        batch = pipelineBatchSizes[run];
+        pipelineReceived = 0;
+        pipelineWakeups = 0;
+        pipelineExpected = value;
+        contextSwitches = OSCtxSwCtr;
+        elapsed = timestampNow();
+
+        for (sent = 0; sent < PIPELINE_ITEMS; sent += batch)
+            pipelineSend(&value, sent + batch <= PIPELINE_ITEMS ? batch : PIPELINE_ITEMS - sent);
+
+        // the consumer has drained the last batch by the time we get here
+        elapsed = timestampNow() - elapsed;
+        contextSwitches = OSCtxSwCtr - contextSwitches;
+        seconds = (double)elapsed / timestampFrequency();
+        printf("%5d  %10.0f  %13.3f  %12.3f\n", batch,
+                pipelineReceived / seconds,
+                (double)contextSwitches / pipelineReceived,
+                (double)pipelineWakeups / pipelineReceived);
+    }
+
+    if (pipelineOutOfOrder > 0)
+        printf("%lu values arrived out of order\n", (unsigned long)pipelineOutOfOrder);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+#else
+
+/* Sends an increasing value to task 1 and prints the negated value it returns */
+void task0(void* pdata)
+{
+    INT16S value = 0;
+    INT16S* slot;
+    alt_u32 length;
+
 #ifdef LIMIT_ITERATIONS
     int iterations = 0;
     while (iterations < LIMIT_ITERATIONS)
@@ -33,38 +165,34 @@ void task0(void* pdata)
         while (1)
 #endif 
         { 
-            // wait for task 1 state semaphore to become 1
-            // which means that task 1 is in state 0
-            // OSSemPend will decrease the semaphore to 0 (= "state" 1)
-            OSSemPend(task1StateSemaphore, 0, &err);
-
-            if (err == OS_ERR_NONE) {
-
-                // inside Task 0 
-                if (*sharedAddress < 0) {
-                    printf("Received %i\n", *sharedAddress);
-                    *sharedAddress = *sharedAddress * -1;
-                }
+            value = value + 1;
+            printf("Sending %i\n", value);
 
-                *sharedAddress = *sharedAddress  + 1;
-                printf("Sending %i\n", *sharedAddress);
+            // fill the next request slot in place and hand it to task 1
+            slot = messageRingClaim(&requestRing);
+            *slot = value;
+            messageRingPublish(&requestRing, sizeof(INT16S));
 
-                // delay for 10 ms
-                OSTimeDlyHMSM(0, 0, 0, 10); 
-
-                // signal that task 0 state is now 0 (meaning that the semaphore is state 1)
-                OSSemPost(task0StateSemaphore);
-            }
+            // blocks until task 1 has published its reply
+            slot = messageRingReceive(&replyRing, &length);
+            printf("Received %i\n", *slot);
+            value = *slot * -1;
+            messageRingRelease(&replyRing);
 
 #ifdef LIMIT_ITERATIONS
             iterations++;
 #endif
         }
+
+    blockPoolPrintStatistics();
 }
 
+/* Negates every value from task 0 and sends it back */
 void task1(void* pdata)
 {
-    INT8U err;
+    INT16S* request;
+    INT16S* reply;
+    alt_u32 length;
 
 #ifdef LIMIT_ITERATIONS
     int iterations = 0;
@@ -73,21 +201,11 @@ void task1(void* pdata)
         while (1)
 #endif 
         { 
-            // wait for task 0 state semaphore to become 1 (task 0 state 1)
-            OSSemPend(task0StateSemaphore, 0, &err);
-
-            if (err == OS_ERR_NONE) {
-                if (*sharedAddress > 0) {
-                    *sharedAddress = *sharedAddress * -1;
-                    // printf("Task 1: Sending %i\n", *sharedAddress);
-                }
-
-                // delay for 10ms
-                OSTimeDlyHMSM(0, 0, 0, 10);
-
-                // signal that task 1 is in state 1
-                OSSemPost(task1StateSemaphore);
-            }
+            request = messageRingReceive(&requestRing, &length);
+            reply = messageRingClaim(&replyRing);
+            *reply = *request * -1;
+            messageRingRelease(&requestRing);
+            messageRingPublish(&replyRing, sizeof(INT16S));
 
 #ifdef LIMIT_ITERATIONS
             iterations++;
@@ -95,47 +213,42 @@ void task1(void* pdata)
         }
 }
 
+#endif
+
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Task0, task0, NULL, TASK0_PRIORITY, TASK0_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Task1, task1, NULL, TASK1_PRIORITY, TASK1_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
     printf("Lab 3 - Shared Memory Communication\n");
 
-    // allocate 2 bytes for sharedAddress on the heap
-    INT8U err;
-    OSMemCreate(sharedAddress, 1, 2, &err);
-
-    // assign initial value of 0
-    *sharedAddress = (INT16S) 0;
-
-    // initialize semaphores
-    task0StateSemaphore = OSSemCreate(0); // Initialize with state = 0
-    task1StateSemaphore = OSSemCreate(1); // Initialize with state = 0
-
-    OSTaskCreateExt
-        ( task0,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task0_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK0_PRIORITY,               // Desired Task priority
-          TASK0_PRIORITY,               // Task ID
-          &task0_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                                 
-        );
-
-    OSTaskCreateExt
-        ( task1,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task1_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK1_PRIORITY,               // Desired Task priority
-          TASK1_PRIORITY,               // Task ID
-          &task1_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                       
-        );  
+#ifdef PIPELINE_MODE
+    pipelineQueue = OSQCreate(pipelineQueueStorage, PIPELINE_QUEUE_DEPTH);
+#else
+    if (!blockPoolInit())
+        return 1;
+    requestPool = blockPoolNewArray(alt_u32, RING_POOL_WORDS);
+    replyPool = blockPoolNewArray(alt_u32, RING_POOL_WORDS);
+    if (requestPool == NULL || replyPool == NULL) {
+        printf("Out of blocks for the message rings\n");
+        return 1;
+    }
+
+    // initialize the rings, each with its own pair of semaphores
+    messageRingInit(&requestRing, requestPool, sizeof(INT16S), RING_SLOTS);
+    messageRingInit(&replyRing, replyPool, sizeof(INT16S), RING_SLOTS);
+#endif
+
+    taskTableCreate(taskTable, taskTableSize);
+
+#ifdef STACK_PROFILE
+    stackProfileStart("SharedMemory");
+#endif
 
     OSStart();
     return 0;
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "LatencyHistogram.h"
+#include "StackProfile.h"
+#include "Tickless.h"
+#include "TimedWait.h"
+#include "Timestamp.h"
+
+/*
+ * Wakeup jitter and timer interrupt rate of the usual tick-driven timing
+ * (hal.sys_clk_timer interrupting every tick) against tickless idle, in one
+ * run that switches between the two.
+ *
+ * Periodic tasks with mixed periods record how far each wakeup is from one
+ * period after the previous one, and a timeout task records how much longer
+ * than asked its timedSemPend() waited. The system is idle in between, so
+ * in tickless mode nearly all idle timer interrupts should go away while
+ * the jitter stays the same. On the host the idle task waits in real time
+ * (UCOS_HOST_REALTIME) so the numbers mean the same as on the board.
+ */
+
+#define RUN_TICKS           (2 * OS_TICKS_PER_SEC)
+#define PERIODIC_TASKS      3
+#define WAIT_TIMEOUT_US     2500
+
+const INT16U periods[PERIODIC_TASKS] = { 7, 20, 50 };     // in ticks
+
+const char* const modeNames[] = { "periodic", "tickless" };
+
+LatencyHistogram periodJitterHistogram;
+LatencyHistogram timeoutOvershootHistogram;
+
+OS_EVENT *neverPostedSemaphore;
+OS_EVENT *runDoneSemaphore;
+volatile int running;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   PERIODIC_TASK_STACKSIZE TASK_STACKSIZE
+#define   TIMEOUT_TASK_STACKSIZE TASK_STACKSIZE
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+OS_STK    periodic_task_stk[PERIODIC_TASKS][PERIODIC_TASK_STACKSIZE];
+OS_STK    timeout_task_stk[TIMEOUT_TASK_STACKSIZE];
+OS_STK    benchmark_task_stk[BENCHMARK_TASK_STACKSIZE];
+
+/* Definition of Task Priorities */
+#define TIMEOUT_TASK_PRIORITY       5
+#define FIRST_PERIODIC_PRIORITY     6   // task i runs at FIRST_PERIODIC_PRIORITY + i
+#define BENCHMARK_TASK_PRIORITY     20  // below the tasks, so they are gone once they posted
+
+INT8U periodicIndexes[PERIODIC_TASKS];
+
+/* The HAL tick is reprogrammed from the OS hooks, a no-op on the host */
+void App_TaskIdleHook(void)
+{
+    ticklessIdleHook();
+}
+
+void App_TaskSwHook(void)
+{
+    ticklessSwitchHook();
+}
+
+void App_TimeTickHook(void)
+{
+    ticklessTickHook();
+}
+
+void periodicTask(void* pdata)
+{
+    INT16U period = periods[*(INT8U*)pdata];
+    alt_u64 expected = timestampFrequency() * period / OS_TICKS_PER_SEC;
+    alt_u64 last;
+    alt_u64 now;
+
+    // start on a tick so the first interval is a whole period
+    OSTimeDly(1);
+    last = timestampNow();
+    while (running) {
+        OSTimeDly(period);
+        now = timestampNow();
+        latencyHistogramRecord(&periodJitterHistogram,
+                now - last > expected ? now - last - expected : expected - (now - last));
+        last = now;
+    }
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void timeoutTask(void* pdata)
+{
+    alt_u32 waitedUs;
+
+    while (running) {
+        if (timedSemPend(neverPostedSemaphore, WAIT_TIMEOUT_US, &waitedUs) == OS_ERR_TIMEOUT)
+            latencyHistogramRecord(&timeoutOvershootHistogram,
+                    waitedUs > WAIT_TIMEOUT_US ? waitedUs - WAIT_TIMEOUT_US : 0);
+    }
+    OSSemPost(runDoneSemaphore);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+void createTask(void (*task)(void*), void* pdata, OS_STK* stack, INT32U stackSize, INT8U priority)
+{
+    OSTaskCreateExt
+        ( task,                         // Pointer to task code
+          pdata,                        // Pointer to argument passed to task
+          &stack[stackSize-1],          // Pointer to top of task stack
+          priority,                     // Desired Task priority
+          priority,                     // Task ID
+          &stack[0],                    // Pointer to bottom of task stack
+          stackSize,                    // Stacksize
+          NULL,                         // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK           // Stack Checking enabled
+        );
+}
+
+/* Runs the tasks for RUN_TICKS in the given mode and prints one row */
+void runBenchmark(int tickless)
+{
+    TicklessStatistics statistics;
+    alt_u64 frequency = timestampFrequency();
+    double seconds;
+    INT8U err;
+    int i;
+
+    latencyHistogramReset(&periodJitterHistogram);
+    latencyHistogramReset(&timeoutOvershootHistogram);
+    ticklessEnable(tickless);
+    ticklessResetStatistics();
+    running = 1;
+
+#ifdef STACK_PROFILE
+    OSSchedLock();
+#endif
+    for (i = 0; i < PERIODIC_TASKS; i++) {
+        periodicIndexes[i] = i;
+        createTask(periodicTask, &periodicIndexes[i], periodic_task_stk[i], PERIODIC_TASK_STACKSIZE, FIRST_PERIODIC_PRIORITY + i);
+    }
+    createTask(timeoutTask, NULL, timeout_task_stk, TIMEOUT_TASK_STACKSIZE, TIMEOUT_TASK_PRIORITY);
+#ifdef STACK_PROFILE
+    for (i = 0; i < PERIODIC_TASKS; i++)
+        stackProfileAdd(FIRST_PERIODIC_PRIORITY + i, "PERIODIC_TASK_STACKSIZE");
+    stackProfileAdd(TIMEOUT_TASK_PRIORITY, "TIMEOUT_TASK_STACKSIZE");
+    OSSchedUnlock();
+#endif
+
+    OSTimeDly(RUN_TICKS);
+    running = 0;
+    for (i = 0; i < PERIODIC_TASKS + 1; i++)
+        OSSemPend(runDoneSemaphore, 0, &err);
+
+    ticklessGetStatistics(&statistics);
+    seconds = (double)statistics.ticks / OS_TICKS_PER_SEC;
+    printf("%-8s  %9.0f  %10.0f  %8.1f %8.1f %8.1f  %8.1f %8.1f %8.1f\n",
+            modeNames[tickless],
+            statistics.timerInterrupts / seconds,
+            statistics.idleTimerInterrupts / seconds,
+            latencyHistogramMean(&periodJitterHistogram) * 1e6 / frequency,
+            latencyHistogramPercentile(&periodJitterHistogram, LATENCY_P99) * 1e6 / frequency,
+            periodJitterHistogram.max * 1e6 / frequency,
+            (double)latencyHistogramMean(&timeoutOvershootHistogram),
+            (double)latencyHistogramPercentile(&timeoutOvershootHistogram, LATENCY_P99),
+            (double)timeoutOvershootHistogram.max);
+}
+
+void benchmarkTask(void* pdata)
+{
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d ticks per run, periods of %d, %d and %d ticks, %d us timeouts\n",
+            RUN_TICKS, periods[0], periods[1], periods[2], WAIT_TIMEOUT_US);
+    printf("          timer irq/s           period jitter (us)       timeout overshoot (us)\n");
+    printf("mode          total        idle      mean      p99      max      mean      p99      max\n");
+
+    runBenchmark(0);
+    runBenchmark(1);
+    ticklessEnable(0);
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The main function creates the benchmark task and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Tickless idle\n");
+
+#ifndef __nios2__
+    OSHostRealtimeSet(OS_TRUE);
+#endif
+
+    neverPostedSemaphore = OSSemCreate(0);
+    runDoneSemaphore = OSSemCreate(0);
+
+    OSTaskCreateExt
+        ( benchmarkTask,                                    // Pointer to task code
+          NULL,                                             // Pointer to argument passed to task
+          &benchmark_task_stk[BENCHMARK_TASK_STACKSIZE-1],  // Pointer to top of task stack
+          BENCHMARK_TASK_PRIORITY,                          // Desired Task priority
+          BENCHMARK_TASK_PRIORITY,                          // Task ID
+          &benchmark_task_stk[0],                           // Pointer to bottom of task stack
+          BENCHMARK_TASK_STACKSIZE,                         // Stacksize
+          NULL,                                             // Pointer to user supplied memory (not needed)
+          OS_TASK_OPT_STK_CHK |                             // Stack Checking enabled
+          OS_TASK_OPT_STK_CLR                               // Stack Cleared
+        );
+
+#ifdef STACK_PROFILE
+    stackProfileAdd(BENCHMARK_TASK_PRIORITY, "BENCHMARK_TASK_STACKSIZE");
+    stackProfileStart("TicklessBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include "includes.h"
+#include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "BenchmarkMetric.h"
+#include "LatencyHistogram.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "TimerWheel.h"
+#include "Timestamp.h"
+
+/*
+ * Per-tick cost and expiry jitter of the timing wheel of lib/TimerWheel
+ * at 10, 1,000 and 10,000 active periodic timers.
+ *
+ * The first table advances a wheel by hand, without the kernel, next to
+ * a countdown list that is walked every tick the way a plain timer list
+ * is, and times arming and stopping one more timer while the others are
+ * armed. The second runs the timers on the timer service for RUN_TICKS
+ * real ticks and reports the time its task spends per tick, how long
+ * after the tick interrupt the callbacks run and how many ticks late any
+ * of them was. A callback that runs before its deadline tick is an error
+ * and is counted as early.
+ */
+
+#define TICKS_PER_RUN       2000
+#define ADD_STOP_PAIRS      100000
+#define MAX_PERIOD          1000        // ticks, the hand-driven runs
+#define SERVICE_MAX_PERIOD  100         // ticks, the service runs
+#define RUN_TICKS           500
+#define MAX_TIMERS          10000
+
+const int timerCounts[] = { 10, 1000, 10000 };
+
+Timer timers[MAX_TIMERS];
+TimerWheel wheel;
+
+// The countdown list: every timer is counted down on every tick
+typedef struct {
+    alt_u32 remaining;
+    alt_u32 period;
+} CountdownTimer;
+
+CountdownTimer countdowns[MAX_TIMERS];
+volatile alt_u32 expirySink;
+
+// Deadlines kept by the service callbacks
+alt_u32 deadlines[MAX_TIMERS];
+alt_u32 periods[MAX_TIMERS];
+volatile alt_u64 tickStamp;
+alt_u32 maxTicksLate;
+alt_u32 earlyExpiries;
+LatencyHistogram expiryLatencyHistogram;
+
+/* Definition of Task Stacks */
+/* Stack grows from HIGH to LOW memory */
+#define   TASK_STACKSIZE       2048
+#ifndef STACK_SIZES_PROFILED
+#define   BENCHMARK_TASK_STACKSIZE TASK_STACKSIZE
+#endif
+
+/* Definition of Task Priorities */
+#define TIMER_SERVICE_PRIORITY      5
+#define BENCHMARK_TASK_PRIORITY     20
+
+/* The time of the tick the service callbacks are measured from */
+void App_TimeTickHook(void)
+{
+    tickStamp = timestampNow();
+}
+
+alt_u32 randomState = 1;
+
+/* Pseudo-random number in 1..range, the same sequence on every run */
+alt_u32 randomIn(alt_u32 range)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return (randomState >> 8) % range + 1;
+}
+
+double nsPer(alt_u64 elapsed, alt_u32 count)
+{
+    return (double)elapsed * 1e9 / timestampFrequency() / count;
+}
+
+void runByHand(int count)
+{
+    alt_u64 wheelTime;
+    alt_u64 listTime;
+    alt_u64 addStopTime;
+    alt_u32 expired = 0;
+    Timer extra;
+    Timer* timer;
+    int tick;
+    int i;
+
+    randomState = 1;
+    timerWheelInit(&wheel, 0);
+    for (i = 0; i < count; i++) {
+        alt_u32 period = randomIn(MAX_PERIOD);
+        alt_u32 delay = randomIn(period);
+
+        timerInit(&timers[i], NULL, NULL);
+        timerWheelAdd(&wheel, &timers[i], delay, period);
+        countdowns[i].remaining = delay;
+        countdowns[i].period = period;
+    }
+
+    wheelTime = timestampNow();
+    for (tick = 0; tick < TICKS_PER_RUN; tick++) {
+        timerWheelAdvance(&wheel);
+        while ((timer = timerWheelExpire(&wheel)) != NULL)
+            expired++;
+    }
+    wheelTime = timestampNow() - wheelTime;
+    expirySink = expired;
+
+    listTime = timestampNow();
+    for (tick = 0; tick < TICKS_PER_RUN; tick++) {
+        for (i = 0; i < count; i++) {
+            if (--countdowns[i].remaining == 0) {
+                countdowns[i].remaining = countdowns[i].period;
+                expirySink = i;
+            }
+        }
+    }
+    listTime = timestampNow() - listTime;
+
+    timerInit(&extra, NULL, NULL);
+    addStopTime = timestampNow();
+    for (i = 0; i < ADD_STOP_PAIRS; i++) {
+        timerWheelAdd(&wheel, &extra, randomIn(MAX_PERIOD), 0);
+        timerWheelRemove(&wheel, &extra);
+    }
+    addStopTime = timestampNow() - addStopTime;
+
+    printf("%6d  %13.1f  %12.1f  %14.1f  %9.1f\n", count, nsPer(wheelTime, TICKS_PER_RUN),
+            nsPer(listTime, TICKS_PER_RUN), nsPer(addStopTime, ADD_STOP_PAIRS),
+            (double)expired / TICKS_PER_RUN);
+    // a tight loop over a few cache lines, which the host's caches swing by a quarter between runs
+    BENCHMARK_METRIC(nsPer(wheelTime, TICKS_PER_RUN), "ns", BENCHMARK_LOWER_IS_BETTER | BENCHMARK_INFORMATIONAL,
+            "wheel tick %d", count);
+    BENCHMARK_METRIC(nsPer(listTime, TICKS_PER_RUN), "ns", BENCHMARK_LOWER_IS_BETTER | BENCHMARK_INFORMATIONAL,
+            "list tick %d", count);
+    BENCHMARK_METRIC(nsPer(addStopTime, ADD_STOP_PAIRS), "ns", BENCHMARK_LOWER_IS_BETTER | BENCHMARK_INFORMATIONAL,
+            "add stop %d", count);
+}
+
+/* Runs in the service task */
+void expiryCallback(Timer* timer, void* arg)
+{
+    int i = (int)(long)arg;
+    INT32S late = (INT32S)(OSTimeGet() - deadlines[i]);
+
+    latencyHistogramRecord(&expiryLatencyHistogram, timestampNow() - tickStamp);
+    if (late < 0)
+        earlyExpiries++;
+    else if ((alt_u32)late > maxTicksLate)
+        maxTicksLate = late;
+    deadlines[i] += periods[i];
+}
+
+void runOnService(int count)
+{
+    TimerServiceStatistics before;
+    TimerServiceStatistics after;
+    double usPerTick = 1e6 / timestampFrequency();
+    alt_u32 ticks;
+    alt_u64 busy;
+    int i;
+
+    randomState = 1;
+    latencyHistogramReset(&expiryLatencyHistogram);
+    maxTicksLate = 0;
+    earlyExpiries = 0;
+    timerServiceGetStatistics(&before);
+
+    // armed in one go, so they all count from the same tick
+    OSSchedLock();
+    for (i = 0; i < count; i++) {
+        alt_u32 delay;
+
+        periods[i] = randomIn(SERVICE_MAX_PERIOD);
+        delay = randomIn(periods[i]);
+        deadlines[i] = OSTimeGet() + delay;
+        timerInit(&timers[i], expiryCallback, (void*)(long)i);
+        timerStart(&timers[i], delay, periods[i]);
+    }
+    OSSchedUnlock();
+
+    OSTimeDly(RUN_TICKS);
+    for (i = 0; i < count; i++)
+        timerStop(&timers[i]);
+    timerServiceGetStatistics(&after);
+
+    ticks = after.ticks - before.ticks;
+    busy = after.busyTime - before.busyTime;
+    printf("%6d  %13.2f  %9.2f  %9.2f  %9.2f  %10lu  %6lu\n", count,
+            ticks > 0 ? busy * usPerTick / ticks : 0.0,
+            latencyHistogramPercentile(&expiryLatencyHistogram, LATENCY_P50) * usPerTick,
+            latencyHistogramPercentile(&expiryLatencyHistogram, LATENCY_P99) * usPerTick,
+            expiryLatencyHistogram.max * usPerTick, (unsigned long)maxTicksLate,
+            (unsigned long)earlyExpiries);
+    if (earlyExpiries > 0)
+        printf("Error: %lu expiries came before their deadline tick\n", (unsigned long)earlyExpiries);
+    BENCHMARK_METRIC(ticks > 0 ? busy * usPerTick / ticks : 0.0, "us", BENCHMARK_LOWER_IS_BETTER,
+            "service tick %d", count);
+    BENCHMARK_METRIC(latencyHistogramPercentile(&expiryLatencyHistogram, LATENCY_P99) * usPerTick, "us",
+            BENCHMARK_LOWER_IS_BETTER, "expiry p99 %d", count);
+}
+
+void benchmarkTask(void* pdata)
+{
+    unsigned int k;
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+
+    printf("%d ticks per run, periods up to %d ticks\n", TICKS_PER_RUN, MAX_PERIOD);
+    printf("timers  wheel ns/tick  list ns/tick  add+stop ns/op  exp./tick\n");
+    for (k = 0; k < sizeof(timerCounts) / sizeof(timerCounts[0]); k++)
+        runByHand(timerCounts[k]);
+
+    printf("\nTimer service, %d ticks per run, periods up to %d ticks\n", RUN_TICKS, SERVICE_MAX_PERIOD);
+    printf("timers  task us/tick  p50 (us)  p99 (us)  max (us)  ticks late   early\n");
+    for (k = 0; k < sizeof(timerCounts) / sizeof(timerCounts[0]); k++)
+        runOnService(timerCounts[k]);
+
+    PERF_STOP_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Benchmark, benchmarkTask, NULL, BENCHMARK_TASK_PRIORITY, BENCHMARK_TASK_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
+
+/* The main function creates the benchmark task and the timer service and starts multi-tasking */
+int main(void)
+{
+    printf("Lab 3 - Timing wheel\n");
+
+    taskTableCreate(taskTable, taskTableSize);
+    timerServiceStart(TIMER_SERVICE_PRIORITY);
+
+#ifdef STACK_PROFILE
+    stackProfileStart("TimerBenchmark");
+#endif
+
+    OSStart();
+    return 0;
+}
@@ -1,138 +1,171 @@
 #include <stdio.h>
 #include "includes.h"
 #include <string.h>
+#include "OutputServer.h"
+#include "PeriodicTask.h"
+#include "StackMonitor.h"
+#include "StackProfile.h"
+#include "TaskStatistics.h"
+#include "TraceRecorder.h"
 
 #define DEBUG 1
 
-// Uncomment to test removal of OSTimeDlyHMSM() statements
-//#define REMOVE_OSTIMEDLY_HMSM
+// Uncomment to print character by character from the tasks instead of
+// handing the text to the output server
+//#define UNBUFFERED_OUTPUT
 
 /* Definition of Task Stacks */
 /* Stack grows from HIGH to LOW memory */
 #define   TASK_STACKSIZE       2048
-OS_STK    task1_stk[TASK_STACKSIZE];
-OS_STK    task2_stk[TASK_STACKSIZE];
-OS_STK    stat_stk[TASK_STACKSIZE];
+#ifndef STACK_SIZES_PROFILED
+#define   TASK1_STACKSIZE      TASK_STACKSIZE
+#define   TASK2_STACKSIZE      TASK_STACKSIZE
+#endif
+
+/* Definition of Task Periods, Deadlines and Budgets */
+// Note: The period has been increased from the original 11 to 111 in order
+// to make program show display preemptive behaviour (on the DE0-Nano hardware
+// task 2 never got a chance to run otherwise).
+#define TASK1_PERIOD_TICKS  (111 * OS_TICKS_PER_SEC / 1000)
+#define TASK2_PERIOD_TICKS  (4 * OS_TICKS_PER_SEC / 1000)
+#define TASK1_DEADLINE_TICKS 0  // the period
+#define TASK2_DEADLINE_TICKS 0
+#define TASK1_BUDGET_US     1000  // worst case the admission test assumes per print
+#define TASK2_BUDGET_US     1000
 
 /* Definition of Task Priorities */
-#define TASK1_PRIORITY      6  // highest priority
-#define TASK2_PRIORITY      7
-#define TASK_STAT_PRIORITY 12  // lowest priority 
+#define PERIODIC_TASKS_PRIORITY 6  // highest priority, rate monotonic: Task2 gets 6, Task1 7
+#define OUTPUT_SERVER_PRIORITY 10  // below the printing tasks, so it can batch their output
+#define PERIODIC_REPORT_PRIORITY 11
+#define STACK_MONITOR_PRIORITY 12  // lowest priority 
 
-void printStackSize(char* name, INT8U prio) 
-{
-    INT8U err;
-    OS_STK_DATA stk_data;
+// Stacks are sampled every 100 ms; usage above the threshold raises an alert
+#define STACK_MONITOR_PERIOD_TICKS (OS_TICKS_PER_SEC / 10)
+#define STACK_ALERT_PERCENT 75
 
-    err = OSTaskStkChk(prio, &stk_data);
-    if (err == OS_NO_ERR) {
-        if (DEBUG == 1)
-            printf("%s (priority %d) - Used: %d; Free: %d\n", 
-                    name, prio, stk_data.OSUsed, stk_data.OSFree);
-    }
-    else
-    {
-        if (DEBUG == 1)
-            printf("Stack Check Error!\n");    
-    }
+// Execution and response times of the periodic tasks are printed every second
+#define PERIODIC_REPORT_TICKS OS_TICKS_PER_SEC
+
+// Builds with -DTRACE_RECORDER dump the scheduler trace after a second
+#define TRACE_RECORDER_PRIORITY 13
+#define TRACE_DUMP_TICKS OS_TICKS_PER_SEC
+
+// Builds with -DTASK_STATISTICS report CPU share and wakeup latency per task every second
+#define TASK_STATS_PRIORITY 14
+#define TASK_STATS_PERIOD_TICKS OS_TICKS_PER_SEC
+
+void App_TaskSwHook(void)
+{
+    periodicTaskSwitchHook();
+#ifdef TRACE_RECORDER
+    traceRecorderSwitchHook();
+#endif
+#ifdef TASK_STATISTICS
+    taskStatsSwitchHook();
+#endif
 }
 
-/* Prints a message and sleeps for given time interval */
-void task1(void* pdata)
+void App_TimeTickHook(void)
 {
-    while (1)
-    { 
-        char text1[] = "Hello from Task1\n";
-        int i;
-
-        for (i = 0; i < strlen(text1); i++)
-            putchar(text1[i]);
-
-#ifndef REMOVE_OSTIMEDLY_HMSM
-		// Note: The delay has been increased from the original 11 to 111 in order
-		// to make program show display preemptive behaviour (on the DE0-Nano hardware
-		// task 2 never got a chance to run otherwise).
-        OSTimeDlyHMSM(0, 0, 0, 111); /* Context Switch to next task
-                                     * Task will go to the ready state
-                                     * after the specified delay
-                                     */
+    periodicTaskTickHook();
+#ifdef TRACE_RECORDER
+    traceRecorderTickHook();
+#endif
+#ifdef TASK_STATISTICS
+    taskStatsTickHook();
 #endif
-    }
 }
 
-/* Prints a message and sleeps for given time interval */
-void task2(void* pdata)
+/* Prints text from the calling task, or queues it for the output server */
+void printText(const char* text)
 {
-    while (1)
-    { 
-        char text2[] = "Hello from Task2\n";
-        int i;
-
-        for (i = 0; i < strlen(text2); i++)
-            putchar(text2[i]);
-#ifndef REMOVE_OSTIMEDLY_HMSM
-        OSTimeDlyHMSM(0, 0, 0, 4);
+#ifdef UNBUFFERED_OUTPUT
+    int i;
+
+    for (i = 0; text[i] != '\0'; i++)
+        putchar(text[i]);
+#else
+    outputServerPost(text);
 #endif
-    }
 }
 
-/* Printing Statistics */
-void statisticTask(void* pdata)
+/* Prints a message, once every TASK1_PERIOD_TICKS */
+void task1(void* pdata)
 {
-    while(1)
-    {
-        printStackSize("Task1", TASK1_PRIORITY);
-        printStackSize("Task2", TASK2_PRIORITY);
-        printStackSize("StatisticTask", TASK_STAT_PRIORITY);
-    }
+    static const char text1[] = "Hello from Task1\n";
+
+    printText(text1);
+}
+
+/* Prints a message, once every TASK2_PERIOD_TICKS */
+void task2(void* pdata)
+{
+    static const char text2[] = "Hello from Task2\n";
+
+    printText(text2);
 }
 
+/* The periodic tasks main() starts: name, job, argument, period, deadline, budget, stack size */
+#define APP_PERIODIC_TASKS(TASK) \
+    TASK(Task1, task1, NULL, TASK1_PERIOD_TICKS, TASK1_DEADLINE_TICKS, TASK1_BUDGET_US, TASK1_STACKSIZE) \
+    TASK(Task2, task2, NULL, TASK2_PERIOD_TICKS, TASK2_DEADLINE_TICKS, TASK2_BUDGET_US, TASK2_STACKSIZE)
+
+PERIODIC_TASK_TABLE(APP_PERIODIC_TASKS);
+
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
+    INT8U err;
+    int i;
+
     printf("Lab 3 - Two Tasks\n");
 
-    OSTaskCreateExt
-        ( task1,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task1_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK1_PRIORITY,               // Desired Task priority
-          TASK1_PRIORITY,               // Task ID
-          &task1_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                                 
-        );
-
-    OSTaskCreateExt
-        ( task2,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task2_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK2_PRIORITY,               // Desired Task priority
-          TASK2_PRIORITY,               // Task ID
-          &task2_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                       
-        );  
-
-    if (DEBUG == 1)
-    {
-        OSTaskCreateExt
-            ( statisticTask,                // Pointer to task code
-              NULL,                         // Pointer to argument passed to task
-              &stat_stk[TASK_STACKSIZE-1],  // Pointer to top of task stack
-              TASK_STAT_PRIORITY,           // Desired Task priority
-              TASK_STAT_PRIORITY,           // Task ID
-              &stat_stk[0],                 // Pointer to bottom of task stack
-              TASK_STACKSIZE,               // Stacksize
-              NULL,                         // Pointer to user supplied memory (not needed)
-              OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-              OS_TASK_OPT_STK_CLR           // Stack Cleared                              
-            );
-    }  
+    err = periodicTasksStart(periodicTaskTable, periodicTaskTableSize, PERIODIC_TASKS_PRIORITY);
+    if (err != OS_ERR_NONE) {
+        printf("The periodic tasks were not started (error %d)\n", err);
+        periodicTaskPrint();
+        return 1;
+    }
+    periodicTaskReportStart(PERIODIC_REPORT_PRIORITY, PERIODIC_REPORT_TICKS);
+
+#ifndef UNBUFFERED_OUTPUT
+    outputServerStart(OUTPUT_SERVER_PRIORITY);
+#endif
+
+    // with DEBUG the usage of every stack is printed once a second
+    stackMonitorStart(STACK_MONITOR_PRIORITY, STACK_MONITOR_PERIOD_TICKS, DEBUG == 1 ? 10 : 0);
+    for (i = 0; i < periodicTaskTableSize; i++)
+        stackMonitorAdd(periodicTaskTable[i].priority, periodicTaskTable[i].name, STACK_ALERT_PERCENT);
+#ifndef UNBUFFERED_OUTPUT
+    stackMonitorAdd(OUTPUT_SERVER_PRIORITY, "OutputServer", STACK_ALERT_PERCENT);
+#endif
+    stackMonitorAdd(PERIODIC_REPORT_PRIORITY, "PeriodicReport", STACK_ALERT_PERCENT);
+
+#ifdef TRACE_RECORDER
+    traceRecorderInit();
+    for (i = 0; i < periodicTaskTableSize; i++)
+        traceRecorderNameTask(periodicTaskTable[i].priority, periodicTaskTable[i].name);
+    traceRecorderNameTask(PERIODIC_REPORT_PRIORITY, "PeriodicReport");
+    traceRecorderNameTask(OUTPUT_SERVER_PRIORITY, "OutputServer");
+    traceRecorderNameTask(STACK_MONITOR_PRIORITY, "StackMonitor");
+    traceRecorderNameTask(TRACE_RECORDER_PRIORITY, "TraceRecorder");
+    traceRecorderStart(TRACE_RECORDER_PRIORITY, TRACE_DUMP_TICKS);
+#endif
+
+#ifdef TASK_STATISTICS
+    taskStatsInit();
+    for (i = 0; i < periodicTaskTableSize; i++)
+        taskStatsName(periodicTaskTable[i].priority, periodicTaskTable[i].name);
+    taskStatsName(PERIODIC_REPORT_PRIORITY, "PeriodicReport");
+    taskStatsName(OUTPUT_SERVER_PRIORITY, "OutputServer");
+    taskStatsName(STACK_MONITOR_PRIORITY, "StackMonitor");
+    taskStatsName(TASK_STATS_PRIORITY, "TaskStatistics");
+    taskStatsStart(TASK_STATS_PRIORITY, TASK_STATS_PERIOD_TICKS);
+#endif
+
+#ifdef STACK_PROFILE
+    stackProfileStart("TwoTasks");
+#endif
 
     OSStart();
     return 0;
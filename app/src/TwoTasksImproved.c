@@ -1,42 +1,85 @@
 #include <stdio.h>
 #include "includes.h"
 #include <string.h>
+#include "altera_avalon_performance_counter.h"
+#include "LatencyHistogram.h"
+#include "OutputServer.h"
+#include "ResourceGuard.h"
+#include "StackMonitor.h"
+#include "StackProfile.h"
+#include "TaskTable.h"
+#include "Timestamp.h"
 
 #define DEBUG 0
 
 // Uncomment to test removal of OSTimeDlyHMSM() statements
 //#define REMOVE_OSTIMEDLY_HMSM
 
-// Define semaphore
-OS_EVENT *criticalSemaphore;
+// Uncomment to print character by character from the tasks instead of
+// handing the text to the output server
+//#define UNBUFFERED_OUTPUT
+
+// Guards the output; build with -DRESOURCE_GUARD_USE_MUTEX for the priority-ceiling mutex
+ResourceGuard criticalGuard;
+
+// How long task 1 holds the guard per print, reported every HOLD_TIME_REPORT_INTERVAL prints
+#define HOLD_TIME_REPORT_INTERVAL 50
+LatencyHistogram task1HoldTimeHistogram;
 
 /* Definition of Task Stacks */
 /* Stack grows from HIGH to LOW memory */
 #define   TASK_STACKSIZE       2048
-OS_STK    task1_stk[TASK_STACKSIZE];
-OS_STK    task2_stk[TASK_STACKSIZE];
-OS_STK    stat_stk[TASK_STACKSIZE];
+#ifndef STACK_SIZES_PROFILED
+#define   TASK1_STACKSIZE      TASK_STACKSIZE
+#define   TASK2_STACKSIZE      TASK_STACKSIZE
+#endif
 
 /* Definition of Task Priorities */
 #define TASK1_PRIORITY      6  // highest priority
 #define TASK2_PRIORITY      7
-#define TASK_STAT_PRIORITY 12  // lowest priority 
+#define OUTPUT_SERVER_PRIORITY 10  // below the printing tasks, so it can batch their output
+#define STACK_MONITOR_PRIORITY 12  // lowest priority 
+#define CRITICAL_CEILING_PRIORITY 5  // mutex mode: above every task printing
+
+// Stacks are sampled every 100 ms; usage above the threshold raises an alert
+#define STACK_MONITOR_PERIOD_TICKS (OS_TICKS_PER_SEC / 10)
+#define STACK_ALERT_PERCENT 75
 
-void printStackSize(char* name, INT8U prio) 
+/* Prints text from the calling task, or queues it for the output server */
+void printText(const char* text)
 {
-    INT8U err;
-    OS_STK_DATA stk_data;
+#ifdef UNBUFFERED_OUTPUT
+    int i;
 
-    err = OSTaskStkChk(prio, &stk_data);
-    if (err == OS_NO_ERR) {
-        if (DEBUG == 1)
-            printf("%s (priority %d) - Used: %d; Free: %d\n", 
-                    name, prio, stk_data.OSUsed, stk_data.OSFree);
-    }
-    else
-    {
-        if (DEBUG == 1)
-            printf("Stack Check Error!\n");    
+    for (i = 0; text[i] != '\0'; i++)
+        putchar(text[i]);
+#else
+    outputServerPost(text);
+#endif
+}
+
+/* Prints the lock hold time of task 1 through the same output path, then starts over */
+void reportHoldTime(void)
+{
+    static char report[160];
+    alt_u64 frequency = timestampFrequency();
+
+    snprintf(report, sizeof(report),
+            "Task1 held the lock for mean %llu ns, max %llu ns over %lu prints (%s output)\n",
+            (unsigned long long)(latencyHistogramMean(&task1HoldTimeHistogram) * 1000000000ULL / frequency),
+            (unsigned long long)(task1HoldTimeHistogram.max * 1000000000ULL / frequency),
+            (unsigned long)task1HoldTimeHistogram.count,
+#ifdef UNBUFFERED_OUTPUT
+            "unbuffered"
+#else
+            "buffered"
+#endif
+            );
+    latencyHistogramReset(&task1HoldTimeHistogram);
+
+    if (resourceGuardLock(&criticalGuard) == OS_ERR_NONE) {
+        printText(report);
+        resourceGuardUnlock(&criticalGuard);
     }
 }
 
@@ -44,21 +87,25 @@ void printStackSize(char* name, INT8U prio)
 void task1(void* pdata)
 {
     INT8U err;
+    alt_u64 holdStart;
 
     while (1)
     { 
-        char text1[] = "Hello from improved Task1\n";
-        int i;
+        static const char text1[] = "Hello from improved Task1\n";
 
-        OSSemPend(criticalSemaphore, 0, &err);
+        err = resourceGuardLock(&criticalGuard);
         if (err == OS_ERR_NONE) {
+            holdStart = timestampNow();
 
-            for (i = 0; i < strlen(text1); i++)
-                putchar(text1[i]);
+            printText(text1);
 
-            OSSemPost(criticalSemaphore);
+            resourceGuardUnlock(&criticalGuard);
+            latencyHistogramRecord(&task1HoldTimeHistogram, timestampNow() - holdStart);
         }
 
+        if (task1HoldTimeHistogram.count == HOLD_TIME_REPORT_INTERVAL)
+            reportHoldTime();
+
 #ifndef REMOVE_OSTIMEDLY_HMSM
 		// Note: The delay has been increased from the original 11 to 111 in order
 		// to make program show display preemptive behaviour (on the DE0-Nano hardware
@@ -77,15 +124,13 @@ void task2(void* pdata)
     INT8U err;
     while (1)
     { 
-        char text2[] = "Hello from improved Task2\n";
-        int i;
+        static const char text2[] = "Hello from improved Task2\n";
 
-        OSSemPend(criticalSemaphore, 0, &err);
+        err = resourceGuardLock(&criticalGuard);
         if (err == OS_ERR_NONE) {
-            for (i = 0; i < strlen(text2); i++)
-                putchar(text2[i]);
+            printText(text2);
 
-            OSSemPost(criticalSemaphore);
+            resourceGuardUnlock(&criticalGuard);
         }
 
 #ifndef REMOVE_OSTIMEDLY_HMSM
@@ -94,66 +139,50 @@ void task2(void* pdata)
     }
 }
 
-/* Printing Statistics */
-void statisticTask(void* pdata)
-{
-    while(1)
-    {
-        printStackSize("Task1", TASK1_PRIORITY);
-        printStackSize("Task2", TASK2_PRIORITY);
-        printStackSize("StatisticTask", TASK_STAT_PRIORITY);
-    }
-}
+/* The tasks main() starts: name, code, argument, priority, stack size, options */
+#define APP_TASKS(TASK) \
+    TASK(Task1, task1, NULL, TASK1_PRIORITY, TASK1_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR) \
+    TASK(Task2, task2, NULL, TASK2_PRIORITY, TASK2_STACKSIZE, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR)
+
+TASK_TABLE(APP_TASKS);
 
 /* The main function creates two task and starts multi-tasking */
 int main(void)
 {
+    int i;
+
     printf("Lab 3 - Two Tasks Improved\n");
 
-    // initialize semaphore
-    criticalSemaphore = OSSemCreate(1); // Initialize with state = 1 (= available)
-
-    OSTaskCreateExt
-        ( task1,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task1_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK1_PRIORITY,               // Desired Task priority
-          TASK1_PRIORITY,               // Task ID
-          &task1_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                                 
-        );
-
-    OSTaskCreateExt
-        ( task2,                        // Pointer to task code
-          NULL,                         // Pointer to argument passed to task
-          &task2_stk[TASK_STACKSIZE-1], // Pointer to top of task stack
-          TASK2_PRIORITY,               // Desired Task priority
-          TASK2_PRIORITY,               // Task ID
-          &task2_stk[0],                // Pointer to bottom of task stack
-          TASK_STACKSIZE,               // Stacksize
-          NULL,                         // Pointer to user supplied memory (not needed)
-          OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-          OS_TASK_OPT_STK_CLR           // Stack Cleared                       
-        );  
-
-    if (DEBUG == 1)
-    {
-        OSTaskCreateExt
-            ( statisticTask,                // Pointer to task code
-              NULL,                         // Pointer to argument passed to task
-              &stat_stk[TASK_STACKSIZE-1],  // Pointer to top of task stack
-              TASK_STAT_PRIORITY,           // Desired Task priority
-              TASK_STAT_PRIORITY,           // Task ID
-              &stat_stk[0],                 // Pointer to bottom of task stack
-              TASK_STACKSIZE,               // Stacksize
-              NULL,                         // Pointer to user supplied memory (not needed)
-              OS_TASK_OPT_STK_CHK |         // Stack Checking enabled 
-              OS_TASK_OPT_STK_CLR           // Stack Cleared                              
-            );
-    }  
+#ifndef __nios2__
+    // every putchar reaches the device on the board, so the host should not hide that in stdio
+    setvbuf(stdout, NULL, _IONBF, 0);
+#endif
+
+    PERF_RESET (PERFORMANCE_COUNTER_0_BASE);
+    PERF_START_MEASURING (PERFORMANCE_COUNTER_0_BASE);
+    latencyHistogramReset(&task1HoldTimeHistogram);
+
+    // initialize the output guard
+    resourceGuardCreate(&criticalGuard, RESOURCE_GUARD_DEFAULT_MODE, CRITICAL_CEILING_PRIORITY);
+    printf("Output guarded by a %s\n", resourceGuardModeName(RESOURCE_GUARD_DEFAULT_MODE));
+
+    taskTableCreate(taskTable, taskTableSize);
+
+#ifndef UNBUFFERED_OUTPUT
+    outputServerStart(OUTPUT_SERVER_PRIORITY);
+#endif
+
+    // with DEBUG the usage of every stack is printed once a second
+    stackMonitorStart(STACK_MONITOR_PRIORITY, STACK_MONITOR_PERIOD_TICKS, DEBUG == 1 ? 10 : 0);
+    for (i = 0; i < taskTableSize; i++)
+        stackMonitorAdd(taskTable[i].priority, taskTable[i].name, STACK_ALERT_PERCENT);
+#ifndef UNBUFFERED_OUTPUT
+    stackMonitorAdd(OUTPUT_SERVER_PRIORITY, "OutputServer", STACK_ALERT_PERCENT);
+#endif
+
+#ifdef STACK_PROFILE
+    stackProfileStart("TwoTasksImproved");
+#endif
 
     OSStart();
     return 0;